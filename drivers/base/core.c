@@ -383,6 +383,36 @@ void device_pm_move_to_tail(struct device *dev)
 	device_links_read_unlock(idx);
 }
 
+/**
+ * device_for_each_supplier - Iterate over the suppliers of a device
+ * @dev: Consumer device.
+ * @data: Data passed to @fn.
+ * @fn: Function called for each supplier that is not in the dormant state.
+ *
+ * Stops and returns the first non-zero value returned by @fn.
+ */
+int device_for_each_supplier(struct device *dev, void *data,
+			     int (*fn)(struct device *supplier, void *data))
+{
+	struct device_link *link;
+	int idx, ret = 0;
+
+	idx = device_links_read_lock();
+
+	list_for_each_entry_rcu(link, &dev->links.suppliers, c_node,
+				device_links_read_lock_held()) {
+		if (READ_ONCE(link->status) == DL_STATE_DORMANT)
+			continue;
+
+		ret = fn(link->supplier, data);
+		if (ret)
+			break;
+	}
+
+	device_links_read_unlock(idx);
+	return ret;
+}
+
 #define to_devlink(dev)	container_of((dev), struct device_link, link_dev)
 
 static ssize_t status_show(struct device *dev,
@@ -21,7 +21,9 @@
 #include <linux/io.h>
 #include <linux/mm.h>
 #include <linux/module.h>
+#include <linux/padata.h>
 #include <linux/scatterlist.h>
+#include <linux/sizes.h>
 #include <linux/slab.h>
 #include <linux/vmalloc.h>
 #include <uapi/linux/rk-dma-heap.h>
@@ -33,6 +35,10 @@ struct rk_cma_heap {
 	struct cma *cma;
 };
 
+/* Buffers from this size on are cleared by several threads */
+#define RK_CMA_HEAP_MT_CLEAR_SIZE	SZ_8M
+#define RK_CMA_HEAP_MT_CLEAR_CHUNK	SZ_1M
+
 struct rk_cma_heap_buffer {
 	struct rk_cma_heap *heap;
 	struct list_head attachments;
@@ -431,6 +437,32 @@ static const struct dma_buf_ops rk_cma_heap_buf_ops = {
 	.release = rk_cma_heap_dma_buf_release,
 };
 
+static void rk_cma_heap_clear_chunk(unsigned long start, unsigned long end,
+				    void *arg)
+{
+	memset(arg + start, 0, end - start);
+}
+
+static void rk_cma_heap_clear(void *vaddr, size_t size)
+{
+	struct padata_mt_job job = {
+		.thread_fn	= rk_cma_heap_clear_chunk,
+		.fn_arg		= vaddr,
+		.start		= 0,
+		.size		= size,
+		.align		= PAGE_SIZE,
+		.min_chunk	= RK_CMA_HEAP_MT_CLEAR_CHUNK,
+		.max_threads	= num_online_cpus(),
+	};
+
+	if (!IS_ENABLED(CONFIG_PADATA) || size < RK_CMA_HEAP_MT_CLEAR_SIZE) {
+		memset(vaddr, 0, size);
+		return;
+	}
+
+	padata_do_multithreaded(&job);
+}
+
 static struct dma_buf *rk_cma_heap_allocate(struct rk_dma_heap *heap,
 					    unsigned long len,
 					    unsigned long fd_flags,
@@ -483,7 +515,7 @@ static struct dma_buf *rk_cma_heap_allocate(struct rk_dma_heap *heap,
 			nr_clear_pages--;
 		}
 	} else {
-		memset(page_address(cma_pages), 0, size);
+		rk_cma_heap_clear(page_address(cma_pages), size);
 	}
 
 	buffer->pages = kmalloc_array(pagecount, sizeof(*buffer->pages),
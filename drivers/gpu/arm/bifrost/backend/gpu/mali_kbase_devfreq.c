@@ -669,6 +669,7 @@ int kbase_devfreq_init(struct kbase_device *kbdev)
 	struct device_node *np = kbdev->dev->of_node;
 	struct device_node *model_node;
 	struct devfreq_dev_profile *dp;
+	const char *governor = "simple_ondemand";
 	int err;
 	struct dev_pm_opp *opp;
 	unsigned int i;
@@ -718,15 +719,25 @@ int kbase_devfreq_init(struct kbase_device *kbdev)
 		return err;
 	}
 
+	err = kbase_devfreq_frame_init(kbdev);
+	if (err) {
+		kbase_devfreq_term_core_mask_table(kbdev);
+		kbase_devfreq_term_freq_table(kbdev);
+		return err;
+	}
+
 	of_property_read_u32(np, "upthreshold",
 			     &ondemand_data.upthreshold);
 	of_property_read_u32(np, "downdifferential",
 			     &ondemand_data.downdifferential);
+	/* The governor can still be switched at runtime through sysfs */
+	of_property_read_string(np, "devfreq-governor", &governor);
 	kbdev->devfreq = devfreq_add_device(kbdev->dev, dp,
-				"simple_ondemand", &ondemand_data);
+				governor, &ondemand_data);
 	if (IS_ERR(kbdev->devfreq)) {
 		err = PTR_ERR(kbdev->devfreq);
 		kbdev->devfreq = NULL;
+		kbase_devfreq_frame_term(kbdev);
 		kbase_devfreq_term_core_mask_table(kbdev);
 		kbase_devfreq_term_freq_table(kbdev);
 		dev_err(kbdev->dev, "Fail to add devfreq device(%d)\n", err);
@@ -739,6 +750,7 @@ int kbase_devfreq_init(struct kbase_device *kbdev)
 		if (devfreq_remove_device(kbdev->devfreq))
 			dev_err(kbdev->dev, "Fail to rm devfreq\n");
 		kbdev->devfreq = NULL;
+		kbase_devfreq_frame_term(kbdev);
 		kbase_devfreq_term_core_mask_table(kbdev);
 		dev_err(kbdev->dev, "Fail to init devfreq workqueue\n");
 		return err;
@@ -841,6 +853,7 @@ int kbase_devfreq_init(struct kbase_device *kbdev)
 
 	kbdev->devfreq = NULL;
 
+	kbase_devfreq_frame_term(kbdev);
 	kbase_devfreq_term_core_mask_table(kbdev);
 
 	return err;
@@ -865,6 +878,8 @@ void kbase_devfreq_term(struct kbase_device *kbdev)
 
 	kbase_devfreq_work_term(kbdev);
 
+	kbase_devfreq_frame_term(kbdev);
+
 	err = devfreq_remove_device(kbdev->devfreq);
 	if (err)
 		dev_err(kbdev->dev, "Failed to terminate devfreq (%d)\n", err);
@@ -61,4 +61,42 @@ void kbase_devfreq_enqueue_work(struct kbase_device *kbdev,
  */
 void kbase_devfreq_opp_translate(struct kbase_device *kbdev, unsigned long freq,
 	u64 *core_mask, unsigned long *freqs, unsigned long *volts);
+
+/* Name of the frame-aware devfreq governor */
+#define KBASE_DEVFREQ_FRAME_GOVERNOR "mali_frame"
+
+/**
+ * kbase_devfreq_frame_init - Register the frame-aware devfreq governor.
+ * @kbdev: Device pointer
+ *
+ * The governor is shared by all the kbase devices and registered with
+ * devfreq by the first one.
+ *
+ * Return: 0 on success, or a negative error code.
+ */
+int kbase_devfreq_frame_init(struct kbase_device *kbdev);
+
+/**
+ * kbase_devfreq_frame_term - Unregister the frame-aware devfreq governor.
+ * @kbdev: Device pointer
+ */
+void kbase_devfreq_frame_term(struct kbase_device *kbdev);
+
+#ifdef CONFIG_MALI_BIFROST_DEVFREQ
+/**
+ * kbase_devfreq_frame_hint - Notify the frame-aware governor of a frame end.
+ * @kbdev: Device pointer
+ *
+ * Called when a frame boundary is seen, i.e. when an output fence is
+ * signalled. The GPU busy time since the previous boundary is used to pick
+ * the lowest frequency that meets the frame deadline, and a devfreq update
+ * is queued if that differs from the current one. Does nothing unless
+ * "mali_frame" is the current governor of @kbdev.
+ */
+void kbase_devfreq_frame_hint(struct kbase_device *kbdev);
+#else
+static inline void kbase_devfreq_frame_hint(struct kbase_device *kbdev)
+{
+}
+#endif /* CONFIG_MALI_BIFROST_DEVFREQ */
 #endif /* _BASE_DEVFREQ_H_ */
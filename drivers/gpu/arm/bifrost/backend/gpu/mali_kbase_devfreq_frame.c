@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: GPL-2.0 WITH Linux-syscall-note
+/*
+ *
+ * (C) COPYRIGHT 2021 ARM Limited. All rights reserved.
+ *
+ * This program is free software and is provided to you under the terms of the
+ * GNU General Public License version 2 as published by the Free Software
+ * Foundation, and any use by you of this program is subject to the terms
+ * of such GNU licence.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ */
+
+/*
+ * Frame-aware devfreq governor.
+ *
+ * Utilisation governors sample the GPU every polling period, so they react to
+ * a frame burst only after it has already missed its deadline and then keep
+ * the clock high well after it. This governor instead measures how much GPU
+ * work each frame needed, using the job slot busy time accumulated by the PM
+ * metrics between two frame boundaries, and asks for the lowest frequency that
+ * fits that work within the frame period. Frame boundaries are signalled by
+ * the kbase_devfreq_frame_hint() calls made when an output fence is signalled.
+ *
+ * When no frame boundary has been seen recently, e.g. for compute workloads,
+ * the governor falls back to plain utilisation scaling on the polled stats.
+ */
+
+#include <mali_kbase.h>
+#include <mali_linux_trace.h>
+#include <backend/gpu/mali_kbase_devfreq.h>
+#include <backend/gpu/mali_kbase_pm_internal.h>
+
+#include <linux/devfreq.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+#include <linux/workqueue.h>
+
+#include "../../../../../devfreq/governor.h"
+
+/* Load percentage the chosen frequency should leave the GPU running at */
+#define KBASE_DEVFREQ_FRAME_UPTHRESHOLD		90
+
+/* Frame hints older than this are ignored, in number of frame periods */
+#define KBASE_DEVFREQ_FRAME_STALE_PERIODS	4
+
+static uint devfreq_frame_period_us = 16667;
+module_param(devfreq_frame_period_us, uint, 0644);
+MODULE_PARM_DESC(devfreq_frame_period_us,
+	"Frame deadline targeted by the mali_frame devfreq governor, in us");
+
+static DEFINE_MUTEX(kbase_devfreq_frame_gov_lock);
+static unsigned int kbase_devfreq_frame_gov_users;
+
+static struct devfreq_governor kbase_devfreq_frame_governor;
+
+static u64 kbase_devfreq_frame_period_ns(void)
+{
+	return max_t(u64, READ_ONCE(devfreq_frame_period_us), 1) *
+		NSEC_PER_USEC;
+}
+
+/**
+ * kbase_devfreq_frame_freq - Frequency needed to run some work in a frame
+ * @work: GPU work, in busy ns multiplied by the frequency in kHz it ran at
+ *
+ * Return: frequency in Hz at which @work fits the frame period with
+ *         KBASE_DEVFREQ_FRAME_UPTHRESHOLD percent load.
+ */
+static unsigned long kbase_devfreq_frame_freq(u64 work)
+{
+	u64 freq = div64_u64(work * 1000, kbase_devfreq_frame_period_ns());
+
+	return (unsigned long)div_u64(freq * 100,
+				      KBASE_DEVFREQ_FRAME_UPTHRESHOLD);
+}
+
+/**
+ * kbase_devfreq_frame_round - Round a frequency up to an OPP
+ * @kbdev: kbase device
+ * @freq:  frequency in Hz
+ *
+ * The frequency table is used rather than the OPP API, which takes a mutex,
+ * as frame hints may come from atomic context.
+ *
+ * Return: the lowest OPP frequency not below @freq, or the highest one.
+ */
+static unsigned long kbase_devfreq_frame_round(struct kbase_device *kbdev,
+					       unsigned long freq)
+{
+	struct devfreq_dev_profile *dp = &kbdev->devfreq_profile;
+	unsigned long opp_freq;
+	unsigned int i;
+
+	if (!dp->max_state)
+		return freq;
+
+	/* The table is sorted from the highest frequency down */
+	opp_freq = dp->freq_table[0];
+	for (i = 1; i < dp->max_state && dp->freq_table[i] >= freq; i++)
+		opp_freq = dp->freq_table[i];
+
+	return opp_freq;
+}
+
+static int kbase_devfreq_frame_get_target_freq(struct devfreq *df,
+					       unsigned long *freq)
+{
+	struct kbase_device *kbdev = dev_get_drvdata(df->dev.parent);
+	struct kbase_devfreq_frame_info *info = &kbdev->devfreq_frame;
+	struct devfreq_dev_status *stat = &df->last_status;
+	u64 stale_ns = kbase_devfreq_frame_period_ns() *
+		KBASE_DEVFREQ_FRAME_STALE_PERIODS;
+	unsigned long flags;
+	bool fresh;
+	int err;
+
+	/* Keep the polled stats current for the utilisation fallback */
+	err = devfreq_update_stats(df);
+	if (err)
+		return err;
+
+	spin_lock_irqsave(&info->lock, flags);
+	fresh = info->last_frame &&
+		ktime_get_ns() - info->last_frame < stale_ns;
+	if (fresh)
+		*freq = info->target_freq;
+	spin_unlock_irqrestore(&info->lock, flags);
+
+	if (fresh)
+		return 0;
+
+	if (!stat->total_time) {
+		*freq = DEVFREQ_MAX_FREQ;
+		return 0;
+	}
+
+	*freq = (unsigned long)div64_u64((u64)stat->current_frequency *
+					 stat->busy_time * 100,
+					 (u64)stat->total_time *
+					 KBASE_DEVFREQ_FRAME_UPTHRESHOLD);
+	return 0;
+}
+
+static int kbase_devfreq_frame_handler(struct devfreq *df,
+				       unsigned int event, void *data)
+{
+	switch (event) {
+	case DEVFREQ_GOV_START:
+		devfreq_monitor_start(df);
+		break;
+
+	case DEVFREQ_GOV_STOP:
+		devfreq_monitor_stop(df);
+		break;
+
+	case DEVFREQ_GOV_UPDATE_INTERVAL:
+		devfreq_update_interval(df, (unsigned int *)data);
+		break;
+
+	case DEVFREQ_GOV_SUSPEND:
+		devfreq_monitor_suspend(df);
+		break;
+
+	case DEVFREQ_GOV_RESUME:
+		devfreq_monitor_resume(df);
+		break;
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+static struct devfreq_governor kbase_devfreq_frame_governor = {
+	.name = KBASE_DEVFREQ_FRAME_GOVERNOR,
+	.get_target_freq = kbase_devfreq_frame_get_target_freq,
+	.event_handler = kbase_devfreq_frame_handler,
+};
+
+static void kbase_devfreq_frame_worker(struct work_struct *work)
+{
+	struct kbase_device *kbdev = container_of(work, struct kbase_device,
+						  devfreq_frame.work);
+	struct devfreq *df = kbdev->devfreq;
+
+	if (!df)
+		return;
+
+	mutex_lock(&df->lock);
+	if (df->governor == &kbase_devfreq_frame_governor && !df->stop_polling)
+		update_devfreq(df);
+	mutex_unlock(&df->lock);
+}
+
+void kbase_devfreq_frame_hint(struct kbase_device *kbdev)
+{
+	struct kbase_devfreq_frame_info *info = &kbdev->devfreq_frame;
+	struct devfreq *df = kbdev->devfreq;
+	struct kbasep_pm_metrics diff;
+	unsigned long cur_freq = kbdev->current_nominal_freq;
+	unsigned long flags;
+	u64 now, frame_ns, busy_ns, total, work;
+	bool update;
+
+	if (!df || READ_ONCE(df->governor) != &kbase_devfreq_frame_governor)
+		return;
+
+	now = ktime_get_ns();
+
+	spin_lock_irqsave(&info->lock, flags);
+
+	kbase_pm_get_dvfs_metrics(kbdev, &info->last_metrics, &diff);
+
+	if (!info->last_frame) {
+		info->last_frame = now;
+		spin_unlock_irqrestore(&info->lock, flags);
+		return;
+	}
+
+	frame_ns = now - info->last_frame;
+	info->last_frame = now;
+
+	/* The PM metrics are in a private unit, so scale the frame time */
+	total = (u64)diff.time_busy + diff.time_idle;
+	busy_ns = total ? div64_u64(frame_ns * diff.time_busy, total) : 0;
+
+	/*
+	 * Follow a heavier frame immediately so that the next one does not
+	 * miss its deadline too, but decay slowly so that a single light
+	 * frame does not drop the clock.
+	 */
+	work = busy_ns * (cur_freq / 1000);
+	if (work > info->work_avg)
+		info->work_avg = work;
+	else
+		info->work_avg = (info->work_avg * 3 + work) / 4;
+
+	/* Only kick devfreq when the frame needs another OPP */
+	info->target_freq = kbase_devfreq_frame_round(kbdev,
+			kbase_devfreq_frame_freq(info->work_avg));
+	update = info->target_freq != cur_freq;
+
+	trace_mali_devfreq_frame(kbdev->id, frame_ns, busy_ns, cur_freq,
+				 info->target_freq);
+
+	spin_unlock_irqrestore(&info->lock, flags);
+
+	if (update)
+		queue_work(system_highpri_wq, &info->work);
+}
+
+int kbase_devfreq_frame_init(struct kbase_device *kbdev)
+{
+	struct kbase_devfreq_frame_info *info = &kbdev->devfreq_frame;
+	int err = 0;
+
+	spin_lock_init(&info->lock);
+	INIT_WORK(&info->work, kbase_devfreq_frame_worker);
+	info->last_frame = 0;
+	info->work_avg = 0;
+	info->target_freq = kbdev->current_nominal_freq;
+
+	mutex_lock(&kbase_devfreq_frame_gov_lock);
+	if (!kbase_devfreq_frame_gov_users)
+		err = devfreq_add_governor(&kbase_devfreq_frame_governor);
+	if (!err)
+		kbase_devfreq_frame_gov_users++;
+	mutex_unlock(&kbase_devfreq_frame_gov_lock);
+
+	if (err)
+		dev_err(kbdev->dev, "Failed to add %s governor (%d)\n",
+			KBASE_DEVFREQ_FRAME_GOVERNOR, err);
+
+	return err;
+}
+
+void kbase_devfreq_frame_term(struct kbase_device *kbdev)
+{
+	int err = 0;
+
+	mutex_lock(&kbase_devfreq_frame_gov_lock);
+	if (!WARN_ON(!kbase_devfreq_frame_gov_users) &&
+	    !--kbase_devfreq_frame_gov_users)
+		err = devfreq_remove_governor(&kbase_devfreq_frame_governor);
+	mutex_unlock(&kbase_devfreq_frame_gov_lock);
+
+	/* No new hint queues the work once the governor is gone */
+	cancel_work_sync(&kbdev->devfreq_frame.work);
+
+	if (err)
+		dev_err(kbdev->dev, "Failed to remove %s governor (%d)\n",
+			KBASE_DEVFREQ_FRAME_GOVERNOR, err);
+}
@@ -290,6 +290,12 @@ static void kbase_gpu_release_atom(struct kbase_device *kbdev,
 		break;
 
 	case KBASE_ATOM_GPU_RB_SUBMITTED:
+		/* Atoms evicted without running have no end timestamp */
+		if (end_timestamp &&
+		    ktime_after(*end_timestamp, katom->start_timestamp))
+			kbase_js_ctx_gpu_time_add(kctx, ktime_to_ns(ktime_sub(
+				*end_timestamp, katom->start_timestamp)));
+
 		kbase_kinstr_jm_atom_hw_release(katom);
 		/* Inform power management at start/finish of atom so it can
 		 * update its GPU utilisation metrics. Mark atom as not
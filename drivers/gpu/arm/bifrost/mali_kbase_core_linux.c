@@ -611,6 +611,38 @@ static const struct file_operations kbase_force_same_va_fops = {
 	.write = write_ctx_force_same_va,
 	.read = read_ctx_force_same_va,
 };
+
+#if !MALI_USE_CSF
+static ssize_t read_ctx_gpu_time(struct file *f, char __user *ubuf,
+		size_t size, loff_t *off)
+{
+	struct kbase_context *kctx = f->private_data;
+	struct kbase_device *kbdev = kctx->kbdev;
+	unsigned long flags;
+	char buf[96];
+	int count;
+	u64 vtime;
+	int priority;
+
+	spin_lock_irqsave(&kbdev->hwaccess_lock, flags);
+	vtime = kctx->gpu_vtime;
+	priority = kctx->priority;
+	spin_unlock_irqrestore(&kbdev->hwaccess_lock, flags);
+
+	count = scnprintf(buf, sizeof(buf),
+			  "gpu_time_ns=%lld vtime=%llu priority=%d\n",
+			  (long long)atomic64_read(&kctx->gpu_time), vtime,
+			  priority);
+
+	return simple_read_from_buffer(ubuf, size, off, buf, count);
+}
+
+static const struct file_operations kbase_gpu_time_fops = {
+	.owner = THIS_MODULE,
+	.open = simple_open,
+	.read = read_ctx_gpu_time,
+};
+#endif /* !MALI_USE_CSF */
 #endif /* CONFIG_DEBUG_FS */
 
 static int kbase_file_create_kctx(struct kbase_file *const kfile,
@@ -673,6 +705,10 @@ static int kbase_file_create_kctx(struct kbase_file *const kfile,
 #endif
 		debugfs_create_file("force_same_va", 0600, kctx->kctx_dentry,
 			kctx, &kbase_force_same_va_fops);
+#if !MALI_USE_CSF
+		debugfs_create_file("gpu_time", 0444, kctx->kctx_dentry,
+			kctx, &kbase_gpu_time_fops);
+#endif /* !MALI_USE_CSF */
 
 		kbase_context_debugfs_init(kctx);
 	}
@@ -3915,6 +3951,73 @@ static ssize_t js_ctx_scheduling_mode_store(struct device *dev,
 
 static DEVICE_ATTR_RW(js_ctx_scheduling_mode);
 
+/**
+ * js_ctx_fair_sched_show - Show callback for js_ctx_fair_sched sysfs entry.
+ * @dev:  The device this sysfs file is for.
+ * @attr: The attributes of the sysfs file.
+ * @buf:  The output buffer to receive whether fair scheduling is enabled.
+ *
+ * Return: The number of bytes output to @buf.
+ */
+static ssize_t js_ctx_fair_sched_show(struct device *dev,
+		struct device_attribute *attr, char * const buf)
+{
+	struct kbase_device *kbdev;
+
+	kbdev = to_kbase_device(dev);
+	if (!kbdev)
+		return -ENODEV;
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", kbdev->js_ctx_fair_sched);
+}
+
+/**
+ * js_ctx_fair_sched_store - Set callback for js_ctx_fair_sched sysfs entry.
+ * @dev:   The device this sysfs file is for.
+ * @attr:  The attributes of the sysfs file.
+ * @buf:   The value written to the sysfs file.
+ * @count: The number of bytes written to the sysfs file.
+ *
+ * When enabled, the job scheduler picks the non-realtime context that has
+ * used the least GPU time, weighted by its priority, instead of going
+ * round-robin through the contexts of the highest priority.
+ *
+ * Return: @count if the function succeeded. An error code on failure.
+ */
+static ssize_t js_ctx_fair_sched_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct kbase_device *kbdev;
+	unsigned long flags;
+	bool enable;
+	int ret;
+
+	kbdev = to_kbase_device(dev);
+	if (!kbdev)
+		return -ENODEV;
+
+	ret = kstrtobool(buf, &enable);
+	if (ret) {
+		dev_err(kbdev->dev, "Couldn't process js_ctx_fair_sched"
+				" write operation.\n"
+				"Use format <0|1>\n");
+		return ret;
+	}
+
+	mutex_lock(&kbdev->kctx_list_lock);
+	spin_lock_irqsave(&kbdev->hwaccess_lock, flags);
+	if (enable != kbdev->js_ctx_fair_sched)
+		kbase_js_fair_sched_set(kbdev, enable);
+	spin_unlock_irqrestore(&kbdev->hwaccess_lock, flags);
+	mutex_unlock(&kbdev->kctx_list_lock);
+
+	dev_dbg(kbdev->dev, "JS ctx fair scheduling: %d\n", enable);
+
+	return count;
+}
+
+static DEVICE_ATTR_RW(js_ctx_fair_sched);
+
 /* Number of entries in serialize_jobs_settings[] */
 #define NR_SERIALIZE_JOBS_SETTINGS 5
 /* Maximum string length in serialize_jobs_settings[].name */
@@ -4804,6 +4907,8 @@ int kbase_device_debugfs_init(struct kbase_device *kbdev)
 #endif /* !MALI_USE_CSF */
 
 	kbasep_gpu_memory_debugfs_init(kbdev);
+	kbase_mem_pool_stats_debugfs_init(kbdev->mali_debugfs_directory,
+					  &kbdev->mem_pools);
 	kbase_as_fault_debugfs_init(kbdev);
 #ifdef CONFIG_MALI_PRFCNT_SET_SELECT_VIA_DEBUG_FS
 	kbase_instr_backend_debugfs_init(kbdev);
@@ -5209,6 +5314,7 @@ static struct attribute *kbase_attrs[] = {
 	&dev_attr_lp_mem_pool_max_size.attr,
 #if !MALI_USE_CSF
 	&dev_attr_js_ctx_scheduling_mode.attr,
+	&dev_attr_js_ctx_fair_sched.attr,
 #endif /* !MALI_USE_CSF */
 	NULL
 };
@@ -319,10 +319,14 @@ static inline int kbase_as_has_page_fault(struct kbase_as *as,
  *                on GPU page fault that can be used before the driver
  *                switches to incremental rendering, in 1/256ths.
  *                0 means disabled.
+ * @pool_zero_wq: Workqueue zeroing the pages spilled to the device memory
+ *                pools in the background, or NULL if they are zeroed
+ *                when spilled.
  */
 struct kbasep_mem_device {
 	atomic_t used_pages;
 	atomic_t ir_threshold;
+	struct workqueue_struct *pool_zero_wq;
 };
 
 struct kbase_clk_rate_listener;
@@ -444,6 +448,35 @@ struct kbase_pm_device_data {
 	struct kbase_clk_rate_trace_manager clk_rtm;
 };
 
+/* Maximum number of pages in a per-CPU magazine of a pool of 4 KiB pages */
+#define KBASE_MEM_POOL_MAGAZINE_SIZE 32
+
+/* Maximum number of pages in a per-CPU magazine of a pool of 2 MiB pages */
+#define KBASE_MEM_POOL_LP_MAGAZINE_SIZE 2
+
+/**
+ * struct kbase_mem_pool_magazine - Per-CPU cache of free pages of a pool
+ * @lock:        Lock protecting the magazine. Only contended when the pool
+ *               is drained, as each CPU uses its own magazine.
+ * @nr:          Number of pages in @pages
+ * @pages:       Free pages, the most recently freed one last
+ * @nr_hits:     Number of allocations served without taking the pool lock
+ * @nr_refills:  Number of times the magazine was refilled from the pool
+ * @nr_spills:   Number of times half the magazine was spilled to the pool
+ *
+ * Small allocations and frees go through the magazine of the current CPU, so
+ * that threads allocating in parallel only take the pool lock to move pages
+ * between their magazine and the pool, a batch at a time.
+ */
+struct kbase_mem_pool_magazine {
+	spinlock_t   lock;
+	size_t       nr;
+	struct page *pages[KBASE_MEM_POOL_MAGAZINE_SIZE];
+	size_t       nr_hits;
+	size_t       nr_refills;
+	size_t       nr_spills;
+};
+
 /**
  * struct kbase_mem_pool - Page based memory pool for kctx/kbdev
  * @kbdev:        Kbase device where memory is used
@@ -466,6 +499,21 @@ struct kbase_pm_device_data {
  *                operations should be abandoned
  * @dont_reclaim: true if the shrinker is forbidden from reclaiming memory from
  *                this pool, eg during a grow operation
+ * @async_zero:   true if pages spilled into this pool are zeroed in the
+ *                background by @zero_work rather than by the freeing thread
+ * @dirty_list:   List of pages spilled into this pool that still have to be
+ *                zeroed before they can be allocated
+ * @dirty_size:   Number of pages in @dirty_list
+ * @zero_work:    Work item zeroing the pages of @dirty_list and moving them
+ *                to @page_list
+ * @nr_async_zeroed: Number of pages zeroed by @zero_work
+ * @nr_sync_zeroed:  Number of pages of @dirty_list that an allocation had to
+ *                zero itself because @zero_work had not got to them yet
+ * @magazines:    Per-CPU caches of free pages in front of @page_list. Their
+ *                pages are not accounted in @cur_size, so the pool may exceed
+ *                @max_size by up to @magazine_size pages per CPU.
+ * @magazine_size: Maximum number of pages in each of @magazines
+ * @nr_lock_contended: Number of times @pool_lock was found already held
  */
 struct kbase_mem_pool {
 	struct kbase_device *kbdev;
@@ -481,6 +529,17 @@ struct kbase_mem_pool {
 
 	bool dying;
 	bool dont_reclaim;
+
+	bool async_zero;
+	struct list_head    dirty_list;
+	size_t              dirty_size;
+	struct work_struct  zero_work;
+	size_t              nr_async_zeroed;
+	size_t              nr_sync_zeroed;
+
+	struct kbase_mem_pool_magazine __percpu *magazines;
+	size_t              magazine_size;
+	size_t              nr_lock_contended;
 };
 
 /**
@@ -621,6 +680,29 @@ struct kbase_devfreq_queue_info {
 	enum kbase_devfreq_work_type acted_type;
 };
 
+/**
+ * struct kbase_devfreq_frame_info - State of the frame-aware devfreq governor
+ *                                   for a device.
+ * @lock:          Protects the fields below, which are updated at every frame
+ *                 boundary.
+ * @work:          Work item running update_devfreq() after a frame boundary
+ *                 changed the target frequency.
+ * @last_metrics:  PM metrics at the last frame boundary.
+ * @last_frame:    Time of the last frame boundary in ns, 0 if none yet.
+ * @work_avg:      Running estimate of the GPU work needed by a frame, in busy
+ *                 ns multiplied by the frequency in kHz it was busy at.
+ * @target_freq:   Nominal frequency in Hz needed to run @work_avg within the
+ *                 frame deadline.
+ */
+struct kbase_devfreq_frame_info {
+	spinlock_t lock;
+	struct work_struct work;
+	struct kbasep_pm_metrics last_metrics;
+	u64 last_frame;
+	u64 work_avg;
+	unsigned long target_freq;
+};
+
 /**
  * struct kbase_process - Representing an object of a kbase process instantiated
  *                        when the first kbase context is created under it.
@@ -822,6 +904,7 @@ struct kbase_process {
  * @last_devfreq_metrics:  last PM metrics
  * @devfreq_queue:         Per device object for storing data that manages devfreq
  *                         suspend & resume request queue and the related items.
+ * @devfreq_frame:         State of the frame-aware "mali_frame" devfreq governor.
  * @devfreq_cooling:       Pointer returned on registering devfreq cooling device
  *                         corresponding to @devfreq.
  * @ipa_protection_mode_switched: is set to TRUE when GPU is put into protected
@@ -928,6 +1011,14 @@ struct kbase_process {
  *                          on disabling of GWT.
  * @js_ctx_scheduling_mode: Context scheduling mode currently being used by
  *                          Job Scheduler
+ * @js_ctx_fair_sched:      true if contexts of the same class are picked in
+ *                          order of weighted GPU time rather than round-robin
+ *                          within strict priority levels. Realtime contexts
+ *                          are always picked first.
+ * @js_fair_min_vtime:      Lowest weighted GPU time of the contexts picked by
+ *                          fair scheduling, which contexts becoming runnable
+ *                          again are brought up to. Protected by
+ *                          hwaccess_lock.
  * @l2_size_override:       Used to set L2 cache size via device tree blob
  * @l2_hash_override:       Used to set L2 cache hash via device tree blob
  * @l2_hash_values_override: true if @l2_hash_values is valid.
@@ -1086,6 +1177,7 @@ struct kbase_device {
 	struct monitor_dev_info *mdev_info;
 	struct ipa_power_model_data *model_data;
 	struct kbase_devfreq_queue_info devfreq_queue;
+	struct kbase_devfreq_frame_info devfreq_frame;
 
 #if IS_ENABLED(CONFIG_DEVFREQ_THERMAL)
 	struct devfreq_cooling_power dfc_power;
@@ -1208,6 +1300,9 @@ struct kbase_device {
 	/* See KBASE_JS_*_PRIORITY_MODE for details. */
 	u32 js_ctx_scheduling_mode;
 
+	bool js_ctx_fair_sched;
+	u64 js_fair_min_vtime;
+
 	/* See KBASE_SERIALIZE_* for details */
 	u8 serialize_jobs;
 
@@ -1727,6 +1822,11 @@ struct kbase_sub_alloc {
  * @priority:             Indicates the context priority. Used along with @atoms_count
  *                        for context scheduling, protected by hwaccess_lock.
  * @atoms_count:          Number of GPU atoms currently in use, per priority
+ * @gpu_time:             Total time, in ns, that atoms of the context have spent
+ *                        running on the job slots.
+ * @gpu_vtime:            GPU time of the context scaled by the weight of its
+ *                        priority, used to order contexts when fair scheduling
+ *                        is enabled. Protected by hwaccess_lock.
  * @create_flags:         Flags used in context creation.
  * @kinstr_jm:            Kernel job manager instrumentation context handle
  * @tl_kctx_list_node:    List item into the device timeline's list of
@@ -1796,6 +1896,8 @@ struct kbase_context {
 	s16 atoms_count[KBASE_JS_ATOM_SCHED_PRIO_COUNT];
 	u32 slots_pullable;
 	u32 age_count;
+	atomic64_t gpu_time;
+	u64 gpu_vtime;
 #endif /* MALI_USE_CSF */
 
 	DECLARE_BITMAP(cookies, BITS_PER_LONG);
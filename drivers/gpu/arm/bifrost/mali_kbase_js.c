@@ -69,6 +69,19 @@ kbasep_js_relative_priority_to_atom[KBASE_JS_ATOM_SCHED_PRIO_COUNT] = {
 	BASE_JD_PRIO_LOW         /* KBASE_JS_ATOM_SCHED_PRIO_LOW */
 };
 
+/* Weight of a context of default priority under fair scheduling */
+#define KBASE_JS_FAIR_WEIGHT_DEFAULT 1024
+
+/*
+ * Share of GPU time each context priority gets relative to the others under
+ * fair scheduling. Realtime contexts are not subject to fair scheduling.
+ */
+static const u32 kbasep_js_fair_weight[KBASE_JS_ATOM_SCHED_PRIO_COUNT] = {
+	[KBASE_JS_ATOM_SCHED_PRIO_REALTIME] = KBASE_JS_FAIR_WEIGHT_DEFAULT * 16,
+	[KBASE_JS_ATOM_SCHED_PRIO_HIGH] = KBASE_JS_FAIR_WEIGHT_DEFAULT * 4,
+	[KBASE_JS_ATOM_SCHED_PRIO_MED] = KBASE_JS_FAIR_WEIGHT_DEFAULT,
+	[KBASE_JS_ATOM_SCHED_PRIO_LOW] = KBASE_JS_FAIR_WEIGHT_DEFAULT / 4,
+};
 
 /*
  * Private function prototypes
@@ -866,6 +879,27 @@ static bool kbase_jsctx_slot_atom_pulled_dec(struct kbase_context *kctx,
 	return slot_prio_became_unblocked;
 }
 
+/**
+ * kbase_js_fair_ctx_runnable - Bring the weighted GPU time of a context that
+ *                              becomes runnable up to date
+ * @kbdev:  Device pointer
+ * @kctx:   Context becoming pullable on its first slot
+ *
+ * A context that has been idle must not be allowed to monopolize the GPU
+ * until it has caught up with the GPU time the busy contexts used meanwhile,
+ * so its weighted GPU time is raised to that of the last context picked.
+ *
+ * Caller must hold hwaccess_lock
+ */
+static void kbase_js_fair_ctx_runnable(struct kbase_device *kbdev,
+				       struct kbase_context *kctx)
+{
+	lockdep_assert_held(&kbdev->hwaccess_lock);
+
+	if (kctx->gpu_vtime < kbdev->js_fair_min_vtime)
+		kctx->gpu_vtime = kbdev->js_fair_min_vtime;
+}
+
 /**
  * kbase_js_ctx_list_add_pullable_nolock - Variant of
  *                                         kbase_jd_ctx_list_add_pullable()
@@ -896,6 +930,7 @@ static bool kbase_js_ctx_list_add_pullable_nolock(struct kbase_device *kbdev,
 			&kbdev->js_data.ctx_list_pullable[js][kctx->priority]);
 
 	if (!kctx->slots_pullable) {
+		kbase_js_fair_ctx_runnable(kbdev, kctx);
 		kbdev->js_data.nr_contexts_pullable++;
 		ret = true;
 		if (!kbase_jsctx_atoms_pulled(kctx)) {
@@ -938,6 +973,7 @@ static bool kbase_js_ctx_list_add_pullable_head_nolock(
 			&kbdev->js_data.ctx_list_pullable[js][kctx->priority]);
 
 	if (!kctx->slots_pullable) {
+		kbase_js_fair_ctx_runnable(kbdev, kctx);
 		kbdev->js_data.nr_contexts_pullable++;
 		ret = true;
 		if (!kbase_jsctx_atoms_pulled(kctx)) {
@@ -1066,6 +1102,44 @@ static bool kbase_js_ctx_list_remove_nolock(struct kbase_device *kbdev,
 	return ret;
 }
 
+/**
+ * kbase_js_ctx_list_pick_fair_nolock - Find the pullable context that has
+ *                                      used the least weighted GPU time
+ * @kbdev:  Device pointer
+ * @js:     Job slot to use
+ *
+ * Realtime contexts are not considered, they are always picked first by
+ * priority order.
+ *
+ * Caller must hold hwaccess_lock
+ *
+ * Return:  Context to use for specified slot, still on its queue.
+ *          NULL if no contexts present for specified slot
+ */
+static struct kbase_context *kbase_js_ctx_list_pick_fair_nolock(
+		struct kbase_device *kbdev, int js)
+{
+	struct kbase_context *kctx, *best = NULL;
+	int prio;
+
+	lockdep_assert_held(&kbdev->hwaccess_lock);
+
+	for (prio = KBASE_JS_ATOM_SCHED_PRIO_FIRST;
+	     prio < KBASE_JS_ATOM_SCHED_PRIO_COUNT; prio++) {
+		if (prio == KBASE_JS_ATOM_SCHED_PRIO_REALTIME)
+			continue;
+
+		list_for_each_entry(kctx,
+				&kbdev->js_data.ctx_list_pullable[js][prio],
+				jctx.sched_info.ctx.ctx_list_entry[js]) {
+			if (!best || kctx->gpu_vtime < best->gpu_vtime)
+				best = kctx;
+		}
+	}
+
+	return best;
+}
+
 /**
  * kbase_js_ctx_list_pop_head_nolock - Variant of kbase_js_ctx_list_pop_head()
  *                                     where the caller must hold
@@ -1087,6 +1161,22 @@ static struct kbase_context *kbase_js_ctx_list_pop_head_nolock(
 
 	lockdep_assert_held(&kbdev->hwaccess_lock);
 
+	if (kbdev->js_ctx_fair_sched &&
+	    list_empty(&kbdev->js_data.ctx_list_pullable[js]
+				[KBASE_JS_ATOM_SCHED_PRIO_REALTIME])) {
+		kctx = kbase_js_ctx_list_pick_fair_nolock(kbdev, js);
+		if (!kctx)
+			return NULL;
+
+		list_del_init(&kctx->jctx.sched_info.ctx.ctx_list_entry[js]);
+		kbdev->js_fair_min_vtime = max(kbdev->js_fair_min_vtime,
+					       kctx->gpu_vtime);
+		dev_dbg(kbdev->dev,
+			"Picked %pK (vtime %llu) from the pullable queue (s:%d)\n",
+			(void *)kctx, kctx->gpu_vtime, js);
+		return kctx;
+	}
+
 	for (i = KBASE_JS_ATOM_SCHED_PRIO_FIRST; i < KBASE_JS_ATOM_SCHED_PRIO_COUNT; i++) {
 		if (list_empty(&kbdev->js_data.ctx_list_pullable[js][i]))
 			continue;
@@ -1366,6 +1456,29 @@ static bool kbase_js_dep_validate(struct kbase_context *kctx,
 	return ret;
 }
 
+void kbase_js_ctx_gpu_time_add(struct kbase_context *kctx, u64 time_ns)
+{
+	lockdep_assert_held(&kctx->kbdev->hwaccess_lock);
+
+	atomic64_add(time_ns, &kctx->gpu_time);
+	kctx->gpu_vtime += div_u64(time_ns * KBASE_JS_FAIR_WEIGHT_DEFAULT,
+				   kbasep_js_fair_weight[kctx->priority]);
+}
+
+void kbase_js_fair_sched_set(struct kbase_device *kbdev, bool enable)
+{
+	struct kbase_context *kctx;
+
+	lockdep_assert_held(&kbdev->kctx_list_lock);
+	lockdep_assert_held(&kbdev->hwaccess_lock);
+
+	/* GPU time used under the previous policy must not count */
+	list_for_each_entry(kctx, &kbdev->kctx_list, kctx_list_link)
+		kctx->gpu_vtime = 0;
+	kbdev->js_fair_min_vtime = 0;
+	kbdev->js_ctx_fair_sched = enable;
+}
+
 void kbase_js_set_ctx_priority(struct kbase_context *kctx, int new_priority)
 {
 	struct kbase_device *kbdev = kctx->kbdev;
@@ -33,4 +33,30 @@
 #include "jm/mali_kbase_jm_js.h"
 #include "jm/mali_kbase_js_defs.h"
 
+#if !MALI_USE_CSF
+/**
+ * kbase_js_ctx_gpu_time_add - Account GPU time used by an atom of a context
+ * @kctx:    Context the atom belongs to
+ * @time_ns: Time in ns the atom spent running on its job slot
+ *
+ * Adds to the total GPU time of @kctx and to its GPU time weighted by its
+ * priority, which fair scheduling orders contexts by.
+ *
+ * Caller must hold hwaccess_lock
+ */
+void kbase_js_ctx_gpu_time_add(struct kbase_context *kctx, u64 time_ns);
+
+/**
+ * kbase_js_fair_sched_set - Enable or disable fair scheduling of contexts
+ * @kbdev:  Device pointer
+ * @enable: true to order contexts by weighted GPU time, false for strict
+ *          priority round-robin
+ *
+ * The weighted GPU time of all the contexts is reset.
+ *
+ * Caller must hold kctx_list_lock and hwaccess_lock
+ */
+void kbase_js_fair_sched_set(struct kbase_device *kbdev, bool enable);
+#endif /* !MALI_USE_CSF */
+
 #endif	/* _KBASE_JS_H_ */
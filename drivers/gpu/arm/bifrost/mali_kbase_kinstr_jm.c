@@ -109,6 +109,9 @@ struct kbase_kinstr_jm {
  * @data.start.slot: Extra data for the state change. Active member depends on
  *                   state.
  * @data.padding:    Padding
+ * @padding:   Padding
+ * @gpu_time:  Total time in ns the atoms of the context had spent running on
+ *             the job slots at the time of the state change.
  *
  * We can add new fields to the structure and old user code will gracefully
  * ignore the new fields.
@@ -146,6 +149,8 @@ struct kbase_kinstr_jm_atom_state_change {
 		} start;
 		u8 padding[4];
 	} data;
+	u8 padding[8];
+	u64 gpu_time;
 };
 static_assert(
 	((1 << 8 * sizeof(((struct kbase_kinstr_jm_atom_state_change *)0)->state)) - 1) >=
@@ -823,12 +828,17 @@ void kbasep_kinstr_jm_atom_state(
 	struct kbase_context *const kctx = katom->kctx;
 	struct kbase_kinstr_jm *const ctx = kctx->kinstr_jm;
 	const u8 id = kbase_jd_atom_id(kctx, katom);
-	struct kbase_kinstr_jm_atom_state_change change = {
-		.timestamp = ktime_get_raw_ns(), .atom = id, .state = state
-	};
+	struct kbase_kinstr_jm_atom_state_change change;
 	struct reader *reader;
 	struct hlist_bl_node *node;
 
+	/* The record is copied to userspace, clear the padding too */
+	memset(&change, 0, sizeof(change));
+	change.timestamp = ktime_get_raw_ns();
+	change.atom = id;
+	change.state = state;
+	change.gpu_time = atomic64_read(&kctx->gpu_time);
+
 	WARN(KBASE_KINSTR_JM_READER_ATOM_STATE_COUNT < state || 0 > state,
 	     PR_ "unsupported katom (%u) state (%i)", id, state);
 
@@ -55,6 +55,13 @@
  */
 #define KBASE_GPU_ALLOCATED_OBJECT_ALIGN_BYTES (128u)
 
+static bool mem_pool_async_zero;
+module_param(mem_pool_async_zero, bool, 0444);
+MODULE_PARM_DESC(mem_pool_async_zero,
+		"Zero the pages freed to the device memory pools from a "
+		"background worker rather than in the freeing thread, so that "
+		"neither frees nor allocations wait for the pages to be cleared.");
+
 /*
  * Maximum size of objects allocated by the GPU inside a just-in-time memory
  * region whose size is given by an end address
@@ -1478,8 +1485,24 @@ int kbase_mem_init(struct kbase_device *kbdev)
 		kbase_mem_pool_group_config_set_max_size(&mem_pool_defaults,
 			KBASE_MEM_POOL_MAX_SIZE_KBDEV);
 
+		/* A single low priority worker is enough to keep up with the
+		 * frees, without competing with the GPU clients for CPU time.
+		 */
+		if (mem_pool_async_zero) {
+			memdev->pool_zero_wq = alloc_workqueue(
+				"mali_mem_pool_zero",
+				WQ_UNBOUND | WQ_FREEZABLE, 1);
+			if (!memdev->pool_zero_wq)
+				dev_warn(kbdev->dev,
+					 "Failed to allocate memory pool zeroing workqueue\n");
+		}
+
 		err = kbase_mem_pool_group_init(&kbdev->mem_pools, kbdev,
 			&mem_pool_defaults, NULL);
+		if (err && memdev->pool_zero_wq) {
+			destroy_workqueue(memdev->pool_zero_wq);
+			memdev->pool_zero_wq = NULL;
+		}
 	}
 
 	return err;
@@ -1505,6 +1528,11 @@ void kbase_mem_term(struct kbase_device *kbdev)
 
 	kbase_mem_pool_group_term(&kbdev->mem_pools);
 
+	if (memdev->pool_zero_wq) {
+		destroy_workqueue(memdev->pool_zero_wq);
+		memdev->pool_zero_wq = NULL;
+	}
+
 	WARN_ON(kbdev->total_gpu_pages);
 	WARN_ON(!RB_EMPTY_ROOT(&kbdev->process_root));
 	WARN_ON(!RB_EMPTY_ROOT(&kbdev->dma_buf_root));
@@ -1969,7 +1969,10 @@ void kbase_sticky_resource_term(struct kbase_context *kctx);
  */
 static inline void kbase_mem_pool_lock(struct kbase_mem_pool *pool)
 {
-	spin_lock(&pool->pool_lock);
+	if (!spin_trylock(&pool->pool_lock)) {
+		spin_lock(&pool->pool_lock);
+		pool->nr_lock_contended++;
+	}
 }
 
 /**
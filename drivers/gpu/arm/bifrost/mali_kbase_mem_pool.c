@@ -38,17 +38,23 @@
 #define NOT_DIRTY false
 #define NOT_RECLAIMED false
 
+/* Number of free pages in the pool, including the ones still to be zeroed */
+static size_t kbase_mem_pool_total_size(struct kbase_mem_pool *pool)
+{
+	return kbase_mem_pool_size(pool) + READ_ONCE(pool->dirty_size);
+}
+
 static size_t kbase_mem_pool_capacity(struct kbase_mem_pool *pool)
 {
 	ssize_t max_size = kbase_mem_pool_max_size(pool);
-	ssize_t cur_size = kbase_mem_pool_size(pool);
+	ssize_t cur_size = kbase_mem_pool_total_size(pool);
 
 	return max(max_size - cur_size, (ssize_t)0);
 }
 
 static bool kbase_mem_pool_is_full(struct kbase_mem_pool *pool)
 {
-	return kbase_mem_pool_size(pool) >= kbase_mem_pool_max_size(pool);
+	return kbase_mem_pool_total_size(pool) >= kbase_mem_pool_max_size(pool);
 }
 
 static bool kbase_mem_pool_is_empty(struct kbase_mem_pool *pool)
@@ -111,6 +117,23 @@ static struct page *kbase_mem_pool_remove_locked(struct kbase_mem_pool *pool)
 	return p;
 }
 
+static struct page *kbase_mem_pool_remove_dirty_locked(
+		struct kbase_mem_pool *pool)
+{
+	struct page *p;
+
+	lockdep_assert_held(&pool->pool_lock);
+
+	if (!pool->dirty_size)
+		return NULL;
+
+	p = list_first_entry(&pool->dirty_list, struct page, lru);
+	list_del_init(&p->lru);
+	pool->dirty_size--;
+
+	return p;
+}
+
 static struct page *kbase_mem_pool_remove(struct kbase_mem_pool *pool)
 {
 	struct page *p;
@@ -142,15 +165,269 @@ static void kbase_mem_pool_zero_page(struct kbase_mem_pool *pool,
 	kbase_mem_pool_sync_page(pool, p);
 }
 
+/*
+ * Add pages that still have to be zeroed to the pool and let the background
+ * worker zero them. They are not allocated before that is done.
+ */
+static void kbase_mem_pool_add_dirty_list(struct kbase_mem_pool *pool,
+		struct list_head *page_list, size_t nr_pages)
+{
+	kbase_mem_pool_lock(pool);
+	list_splice(page_list, &pool->dirty_list);
+	pool->dirty_size += nr_pages;
+	if (!pool->dying)
+		queue_work(pool->kbdev->memdev.pool_zero_wq, &pool->zero_work);
+	kbase_mem_pool_unlock(pool);
+
+	pool_dbg(pool, "added %zu pages to zero\n", nr_pages);
+}
+
+static void kbase_mem_pool_zero_worker(struct work_struct *work)
+{
+	struct kbase_mem_pool *pool = container_of(work,
+			struct kbase_mem_pool, zero_work);
+	struct page *p;
+
+	kbase_mem_pool_lock(pool);
+	while (!pool->dying) {
+		p = kbase_mem_pool_remove_dirty_locked(pool);
+		if (!p)
+			break;
+		kbase_mem_pool_unlock(pool);
+
+		kbase_mem_pool_zero_page(pool, p);
+		cond_resched();
+
+		kbase_mem_pool_lock(pool);
+		kbase_mem_pool_add_locked(pool, p);
+		pool->nr_async_zeroed++;
+	}
+	kbase_mem_pool_unlock(pool);
+}
+
+/*
+ * Zero up to @nr_pages of the pages waiting for the background worker, so that
+ * an allocation does not go to the kernel while the pool still has free pages.
+ * Returns the number of pages made available for allocation.
+ */
+static size_t kbase_mem_pool_zero_dirty(struct kbase_mem_pool *pool,
+		size_t nr_pages)
+{
+	struct page *p;
+	LIST_HEAD(page_list);
+	size_t i;
+
+	kbase_mem_pool_lock(pool);
+	for (i = 0; i < nr_pages; i++) {
+		p = kbase_mem_pool_remove_dirty_locked(pool);
+		if (!p)
+			break;
+		list_add(&p->lru, &page_list);
+	}
+	kbase_mem_pool_unlock(pool);
+
+	if (!i)
+		return 0;
+
+	list_for_each_entry(p, &page_list, lru)
+		kbase_mem_pool_zero_page(pool, p);
+
+	kbase_mem_pool_lock(pool);
+	kbase_mem_pool_add_list_locked(pool, &page_list, i);
+	pool->nr_sync_zeroed += i;
+	kbase_mem_pool_unlock(pool);
+
+	return i;
+}
+
 static void kbase_mem_pool_spill(struct kbase_mem_pool *next_pool,
 		struct page *p)
 {
+	if (next_pool->async_zero) {
+		LIST_HEAD(page_list);
+
+		list_add(&p->lru, &page_list);
+		kbase_mem_pool_add_dirty_list(next_pool, &page_list, 1);
+		return;
+	}
+
 	/* Zero page before spilling */
 	kbase_mem_pool_zero_page(next_pool, p);
 
 	kbase_mem_pool_add(next_pool, p);
 }
 
+/* Fill the entries of @pages describing the pool page @p, return how many */
+static size_t kbase_mem_pool_page_to_tagged(struct kbase_mem_pool *pool,
+		struct page *p, struct tagged_addr *pages)
+{
+	size_t j;
+
+	if (!pool->order) {
+		pages[0] = as_tagged(page_to_phys(p));
+		return 1;
+	}
+
+	pages[0] = as_tagged_tag(page_to_phys(p), HUGE_HEAD | HUGE_PAGE);
+	for (j = 1; j < (1u << pool->order); j++)
+		pages[j] = as_tagged_tag(page_to_phys(p) + PAGE_SIZE * j,
+					 HUGE_PAGE);
+
+	return 1u << pool->order;
+}
+
+static size_t kbase_mem_pool_magazine_pages(struct kbase_mem_pool *pool)
+{
+	size_t nr = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		nr += READ_ONCE(per_cpu_ptr(pool->magazines, cpu)->nr);
+
+	return nr;
+}
+
+/*
+ * Move the oldest half of a full magazine to the pool, in one go.
+ */
+static void kbase_mem_pool_magazine_spill(struct kbase_mem_pool *pool,
+		struct kbase_mem_pool_magazine *mag)
+{
+	size_t nr_to_spill = max_t(size_t, pool->magazine_size / 2, 1);
+	LIST_HEAD(page_list);
+	size_t i;
+
+	lockdep_assert_held(&mag->lock);
+
+	for (i = 0; i < nr_to_spill; i++)
+		list_add(&mag->pages[i]->lru, &page_list);
+
+	mag->nr -= nr_to_spill;
+	memmove(mag->pages, mag->pages + nr_to_spill,
+		mag->nr * sizeof(mag->pages[0]));
+
+	kbase_mem_pool_add_list(pool, &page_list, nr_to_spill);
+	mag->nr_spills++;
+}
+
+/*
+ * Give the pages of all the magazines back to the pool, so that they can be
+ * freed or counted.
+ */
+static void kbase_mem_pool_drain_magazines(struct kbase_mem_pool *pool)
+{
+	struct kbase_mem_pool_magazine *mag;
+	LIST_HEAD(page_list);
+	size_t nr;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		mag = per_cpu_ptr(pool->magazines, cpu);
+
+		spin_lock(&mag->lock);
+		nr = mag->nr;
+		while (mag->nr)
+			list_add(&mag->pages[--mag->nr]->lru, &page_list);
+		spin_unlock(&mag->lock);
+
+		if (nr)
+			kbase_mem_pool_add_list(pool, &page_list, nr);
+		INIT_LIST_HEAD(&page_list);
+	}
+}
+
+/*
+ * Take @nr_pages pages from the magazine of the current CPU, refilling it from
+ * the pool in one batch if it runs short. Only small allocations are served
+ * from the magazines.
+ *
+ * Return: number of entries of @pages filled.
+ */
+static size_t kbase_mem_pool_magazine_alloc_pages(struct kbase_mem_pool *pool,
+		size_t nr_pages, struct tagged_addr *pages)
+{
+	struct kbase_mem_pool_magazine *mag;
+	size_t nr_to_refill;
+	struct page *p;
+	size_t i = 0;
+
+	if (nr_pages > pool->magazine_size)
+		return 0;
+
+	mag = raw_cpu_ptr(pool->magazines);
+	spin_lock(&mag->lock);
+
+	if (mag->nr < nr_pages) {
+		/* Refill up to half the magazine, to leave room for frees */
+		nr_to_refill = max(nr_pages, pool->magazine_size / 2) - mag->nr;
+
+		kbase_mem_pool_lock(pool);
+		while (nr_to_refill--) {
+			p = kbase_mem_pool_remove_locked(pool);
+			if (!p)
+				break;
+			mag->pages[mag->nr++] = p;
+		}
+		kbase_mem_pool_unlock(pool);
+		mag->nr_refills++;
+	} else {
+		mag->nr_hits++;
+	}
+
+	while (nr_pages-- && mag->nr)
+		i += kbase_mem_pool_page_to_tagged(pool, mag->pages[--mag->nr],
+						   pages + i);
+
+	spin_unlock(&mag->lock);
+
+	return i;
+}
+
+/*
+ * Put the pages described by the first @nr_pages entries of @pages into the
+ * magazine of the current CPU, spilling to the pool whenever it is full. Only
+ * small frees go through the magazines.
+ *
+ * Return: number of entries of @pages consumed.
+ */
+static size_t kbase_mem_pool_magazine_free_pages(struct kbase_mem_pool *pool,
+		size_t nr_pages, struct tagged_addr *pages, bool sync)
+{
+	struct kbase_mem_pool_magazine *mag;
+	struct page *p;
+	size_t i;
+
+	if (!nr_pages || nr_pages > (pool->magazine_size << pool->order))
+		return 0;
+
+	/* Sync pages first without holding the magazine lock */
+	for (i = 0; sync && i < nr_pages; i++) {
+		if (likely(as_phys_addr_t(pages[i])) &&
+		    (is_huge_head(pages[i]) || !is_huge(pages[i])))
+			kbase_mem_pool_sync_page(pool, as_page(pages[i]));
+	}
+
+	mag = raw_cpu_ptr(pool->magazines);
+	spin_lock(&mag->lock);
+
+	for (i = 0; i < nr_pages; i++) {
+		if (unlikely(!as_phys_addr_t(pages[i])))
+			continue;
+
+		if (is_huge_head(pages[i]) || !is_huge(pages[i])) {
+			p = as_page(pages[i]);
+			if (mag->nr == pool->magazine_size)
+				kbase_mem_pool_magazine_spill(pool, mag);
+			mag->pages[mag->nr++] = p;
+		}
+		pages[i] = as_tagged(0);
+	}
+
+	spin_unlock(&mag->lock);
+
+	return nr_pages;
+}
+
 struct page *kbase_mem_alloc_page(struct kbase_mem_pool *pool)
 {
 	struct page *p;
@@ -212,7 +489,13 @@ static size_t kbase_mem_pool_shrink_locked(struct kbase_mem_pool *pool,
 
 	lockdep_assert_held(&pool->pool_lock);
 
-	for (i = 0; i < nr_to_shrink && !kbase_mem_pool_is_empty(pool); i++) {
+	/* Give back the pages nobody has spent time zeroing yet first */
+	for (i = 0; i < nr_to_shrink && pool->dirty_size; i++) {
+		p = kbase_mem_pool_remove_dirty_locked(pool);
+		kbase_mem_pool_free_page(pool, p);
+	}
+
+	for (; i < nr_to_shrink && !kbase_mem_pool_is_empty(pool); i++) {
 		p = kbase_mem_pool_remove_locked(pool);
 		kbase_mem_pool_free_page(pool, p);
 	}
@@ -225,6 +508,8 @@ static size_t kbase_mem_pool_shrink(struct kbase_mem_pool *pool,
 {
 	size_t nr_freed;
 
+	kbase_mem_pool_drain_magazines(pool);
+
 	kbase_mem_pool_lock(pool);
 	nr_freed = kbase_mem_pool_shrink_locked(pool, nr_to_shrink);
 	kbase_mem_pool_unlock(pool);
@@ -238,6 +523,9 @@ int kbase_mem_pool_grow(struct kbase_mem_pool *pool,
 	struct page *p;
 	size_t i;
 
+	if (pool->async_zero)
+		nr_to_grow -= kbase_mem_pool_zero_dirty(pool, nr_to_grow);
+
 	kbase_mem_pool_lock(pool);
 
 	pool->dont_reclaim = true;
@@ -298,11 +586,13 @@ void kbase_mem_pool_set_max_size(struct kbase_mem_pool *pool, size_t max_size)
 	size_t cur_size;
 	size_t nr_to_shrink;
 
+	kbase_mem_pool_drain_magazines(pool);
+
 	kbase_mem_pool_lock(pool);
 
 	pool->max_size = max_size;
 
-	cur_size = kbase_mem_pool_size(pool);
+	cur_size = kbase_mem_pool_total_size(pool);
 	if (max_size < cur_size) {
 		nr_to_shrink = cur_size - max_size;
 		kbase_mem_pool_shrink_locked(pool, nr_to_shrink);
@@ -325,10 +615,10 @@ static unsigned long kbase_mem_pool_reclaim_count_objects(struct shrinker *s,
 		kbase_mem_pool_unlock(pool);
 		return 0;
 	}
-	pool_size = kbase_mem_pool_size(pool);
+	pool_size = kbase_mem_pool_total_size(pool);
 	kbase_mem_pool_unlock(pool);
 
-	return pool_size;
+	return pool_size + kbase_mem_pool_magazine_pages(pool);
 }
 
 static unsigned long kbase_mem_pool_reclaim_scan_objects(struct shrinker *s,
@@ -339,6 +629,8 @@ static unsigned long kbase_mem_pool_reclaim_scan_objects(struct shrinker *s,
 
 	pool = container_of(s, struct kbase_mem_pool, reclaim);
 
+	kbase_mem_pool_drain_magazines(pool);
+
 	kbase_mem_pool_lock(pool);
 	if (pool->dont_reclaim && !pool->dying) {
 		kbase_mem_pool_unlock(pool);
@@ -363,11 +655,24 @@ int kbase_mem_pool_init(struct kbase_mem_pool *pool,
 		struct kbase_device *kbdev,
 		struct kbase_mem_pool *next_pool)
 {
+	int cpu;
+
 	if (WARN_ON(group_id < 0) ||
 		WARN_ON(group_id >= MEMORY_GROUP_MANAGER_NR_GROUPS)) {
 		return -EINVAL;
 	}
 
+	pool->magazines = alloc_percpu(struct kbase_mem_pool_magazine);
+	if (!pool->magazines)
+		return -ENOMEM;
+
+	for_each_possible_cpu(cpu)
+		spin_lock_init(&per_cpu_ptr(pool->magazines, cpu)->lock);
+
+	pool->magazine_size = order ? KBASE_MEM_POOL_LP_MAGAZINE_SIZE :
+				      KBASE_MEM_POOL_MAGAZINE_SIZE;
+	pool->nr_lock_contended = 0;
+
 	pool->cur_size = 0;
 	pool->max_size = kbase_mem_pool_config_get_max_size(config);
 	pool->order = order;
@@ -376,8 +681,16 @@ int kbase_mem_pool_init(struct kbase_mem_pool *pool,
 	pool->next_pool = next_pool;
 	pool->dying = false;
 
+	/* Only the device pools zero the pages spilled into them */
+	pool->async_zero = !next_pool && kbdev->memdev.pool_zero_wq;
+	pool->dirty_size = 0;
+	pool->nr_async_zeroed = 0;
+	pool->nr_sync_zeroed = 0;
+
 	spin_lock_init(&pool->pool_lock);
 	INIT_LIST_HEAD(&pool->page_list);
+	INIT_LIST_HEAD(&pool->dirty_list);
+	INIT_WORK(&pool->zero_work, kbase_mem_pool_zero_worker);
 
 	pool->reclaim.count_objects = kbase_mem_pool_reclaim_count_objects;
 	pool->reclaim.scan_objects = kbase_mem_pool_reclaim_scan_objects;
@@ -412,6 +725,8 @@ void kbase_mem_pool_term(struct kbase_mem_pool *pool)
 	pool_dbg(pool, "terminate()\n");
 
 	unregister_shrinker(&pool->reclaim);
+	cancel_work_sync(&pool->zero_work);
+	kbase_mem_pool_drain_magazines(pool);
 
 	kbase_mem_pool_lock(pool);
 	pool->max_size = 0;
@@ -434,14 +749,23 @@ void kbase_mem_pool_term(struct kbase_mem_pool *pool)
 		list_add(&p->lru, &free_list);
 	}
 
+	while ((p = kbase_mem_pool_remove_dirty_locked(pool)))
+		list_add(&p->lru, &free_list);
+
 	kbase_mem_pool_unlock(pool);
 
 	if (next_pool && nr_to_spill) {
-		list_for_each_entry(p, &spill_list, lru)
-			kbase_mem_pool_zero_page(pool, p);
+		if (next_pool->async_zero) {
+			kbase_mem_pool_add_dirty_list(next_pool, &spill_list,
+						      nr_to_spill);
+		} else {
+			list_for_each_entry(p, &spill_list, lru)
+				kbase_mem_pool_zero_page(pool, p);
 
-		/* Add new page list to next_pool */
-		kbase_mem_pool_add_list(next_pool, &spill_list, nr_to_spill);
+			/* Add new page list to next_pool */
+			kbase_mem_pool_add_list(next_pool, &spill_list,
+						nr_to_spill);
+		}
 
 		pool_dbg(pool, "terminate() spilled %zu pages\n", nr_to_spill);
 	}
@@ -451,6 +775,9 @@ void kbase_mem_pool_term(struct kbase_mem_pool *pool)
 		kbase_mem_pool_free_page(pool, p);
 	}
 
+	free_percpu(pool->magazines);
+	pool->magazines = NULL;
+
 	pool_dbg(pool, "terminated\n");
 }
 
@@ -460,6 +787,8 @@ struct page *kbase_mem_pool_alloc(struct kbase_mem_pool *pool)
 
 	do {
 		pool_dbg(pool, "alloc()\n");
+		if (pool->async_zero && kbase_mem_pool_is_empty(pool))
+			kbase_mem_pool_zero_dirty(pool, 1);
 		p = kbase_mem_pool_remove(pool);
 
 		if (p)
@@ -544,9 +873,18 @@ int kbase_mem_pool_alloc_pages(struct kbase_mem_pool *pool, size_t nr_4k_pages,
 	pool_dbg(pool, "alloc_pages(4k=%zu):\n", nr_4k_pages);
 	pool_dbg(pool, "alloc_pages(internal=%zu):\n", nr_pages_internal);
 
+	if (pool->async_zero &&
+	    kbase_mem_pool_size(pool) < nr_pages_internal)
+		kbase_mem_pool_zero_dirty(pool,
+				nr_pages_internal - kbase_mem_pool_size(pool));
+
+	/* Small allocations are served from the magazine of this CPU */
+	i = kbase_mem_pool_magazine_alloc_pages(pool, nr_pages_internal, pages);
+
 	/* Get pages from this pool */
 	kbase_mem_pool_lock(pool);
-	nr_from_pool = min(nr_pages_internal, kbase_mem_pool_size(pool));
+	nr_from_pool = min(nr_pages_internal - (i >> pool->order),
+			   kbase_mem_pool_size(pool));
 	while (nr_from_pool--) {
 		int j;
 
@@ -663,6 +1001,8 @@ static void kbase_mem_pool_add_array(struct kbase_mem_pool *pool,
 	size_t nr_to_pool = 0;
 	LIST_HEAD(new_page_list);
 	size_t i;
+	/* Pages spilled to a device pool may be zeroed by its worker */
+	bool zero_later = zero && pool->async_zero;
 
 	if (!nr_pages)
 		return;
@@ -677,9 +1017,9 @@ static void kbase_mem_pool_add_array(struct kbase_mem_pool *pool,
 
 		if (is_huge_head(pages[i]) || !is_huge(pages[i])) {
 			p = as_page(pages[i]);
-			if (zero)
+			if (zero && !zero_later)
 				kbase_mem_pool_zero_page(pool, p);
-			else if (sync)
+			else if (sync && !zero)
 				kbase_mem_pool_sync_page(pool, p);
 
 			list_add(&p->lru, &new_page_list);
@@ -689,7 +1029,10 @@ static void kbase_mem_pool_add_array(struct kbase_mem_pool *pool,
 	}
 
 	/* Add new page list to pool */
-	kbase_mem_pool_add_list(pool, &new_page_list, nr_to_pool);
+	if (zero_later)
+		kbase_mem_pool_add_dirty_list(pool, &new_page_list, nr_to_pool);
+	else
+		kbase_mem_pool_add_list(pool, &new_page_list, nr_to_pool);
 
 	pool_dbg(pool, "add_array(%zu) added %zu pages\n",
 			nr_pages, nr_to_pool);
@@ -753,9 +1096,14 @@ void kbase_mem_pool_free_pages(struct kbase_mem_pool *pool, size_t nr_pages,
 		nr_to_pool = kbase_mem_pool_capacity(pool);
 		nr_to_pool = min(nr_pages, nr_to_pool);
 
-		kbase_mem_pool_add_array(pool, nr_to_pool, pages, false, dirty);
+		/* Small frees go to the magazine of this CPU */
+		i = kbase_mem_pool_magazine_free_pages(pool, nr_to_pool, pages,
+						       dirty);
 
-		i += nr_to_pool;
+		kbase_mem_pool_add_array(pool, nr_to_pool - i, pages + i,
+					 false, dirty);
+
+		i = nr_to_pool;
 
 		if (i != nr_pages && next_pool) {
 			/* Spill to next pool (may overspill) */
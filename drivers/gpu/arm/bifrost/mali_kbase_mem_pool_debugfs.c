@@ -165,6 +165,76 @@ static const struct file_operations kbase_mem_pool_debugfs_max_size_fops = {
 	.release = single_release,
 };
 
+static int kbase_mem_pool_debugfs_stats_show(struct seq_file *sfile,
+	void *data)
+{
+	struct kbase_mem_pool *const mem_pools = sfile->private;
+	size_t size, dirty_size, nr_async_zeroed, nr_sync_zeroed, nr_contended;
+	size_t mag_size, mag_hits, mag_refills, mag_spills;
+	int gid, cpu;
+
+	CSTD_UNUSED(data);
+
+	seq_puts(sfile, "group size dirty async_zeroed sync_zeroed contended mag_size mag_hits mag_refills mag_spills\n");
+
+	for (gid = 0; gid < MEMORY_GROUP_MANAGER_NR_GROUPS; gid++) {
+		struct kbase_mem_pool *const pool = &mem_pools[gid];
+
+		kbase_mem_pool_lock(pool);
+		size = kbase_mem_pool_size(pool);
+		dirty_size = pool->dirty_size;
+		nr_async_zeroed = pool->nr_async_zeroed;
+		nr_sync_zeroed = pool->nr_sync_zeroed;
+		nr_contended = pool->nr_lock_contended;
+		kbase_mem_pool_unlock(pool);
+
+		mag_size = mag_hits = mag_refills = mag_spills = 0;
+		for_each_possible_cpu(cpu) {
+			struct kbase_mem_pool_magazine *const mag =
+				per_cpu_ptr(pool->magazines, cpu);
+
+			spin_lock(&mag->lock);
+			mag_size += mag->nr;
+			mag_hits += mag->nr_hits;
+			mag_refills += mag->nr_refills;
+			mag_spills += mag->nr_spills;
+			spin_unlock(&mag->lock);
+		}
+
+		seq_printf(sfile, "%d %zu %zu %zu %zu %zu %zu %zu %zu %zu\n",
+			   gid, size, dirty_size, nr_async_zeroed,
+			   nr_sync_zeroed, nr_contended, mag_size, mag_hits,
+			   mag_refills, mag_spills);
+	}
+
+	return 0;
+}
+
+static int kbase_mem_pool_debugfs_stats_open(struct inode *in,
+	struct file *file)
+{
+	return single_open(file, kbase_mem_pool_debugfs_stats_show,
+		in->i_private);
+}
+
+static const struct file_operations kbase_mem_pool_debugfs_stats_fops = {
+	.owner = THIS_MODULE,
+	.open = kbase_mem_pool_debugfs_stats_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+void kbase_mem_pool_stats_debugfs_init(struct dentry *parent,
+		struct kbase_mem_pool_group *mem_pools)
+{
+	debugfs_create_file("mem_pool_stats", 0444, parent,
+		mem_pools->small, &kbase_mem_pool_debugfs_stats_fops);
+
+	debugfs_create_file("lp_mem_pool_stats", 0444, parent,
+		mem_pools->large, &kbase_mem_pool_debugfs_stats_fops);
+}
+
 void kbase_mem_pool_debugfs_init(struct dentry *parent,
 		struct kbase_context *kctx)
 {
@@ -187,4 +257,6 @@ void kbase_mem_pool_debugfs_init(struct dentry *parent,
 
 	debugfs_create_file("lp_mem_pool_max_size", mode, parent,
 		&kctx->mem_pools.large, &kbase_mem_pool_debugfs_max_size_fops);
+
+	kbase_mem_pool_stats_debugfs_init(parent, &kctx->mem_pools);
 }
@@ -34,10 +34,28 @@
  * - mem_pool_max_size: get/set the max sizes of @kctx: mem_pools
  * - lp_mem_pool_size: get/set the current sizes of @kctx: lp_mem_pool
  * - lp_mem_pool_max_size: get/set the max sizes of @kctx:lp_mem_pool
+ * as well as the statistics files of kbase_mem_pool_stats_debugfs_init().
  */
 void kbase_mem_pool_debugfs_init(struct dentry *parent,
 		struct kbase_context *kctx);
 
+/**
+ * kbase_mem_pool_stats_debugfs_init - add debugfs statistics of a set of pools
+ * @parent:    Parent debugfs dentry
+ * @mem_pools: The memory pools to report on
+ *
+ * Adds two read-only debugfs files under @parent, listing for each memory
+ * group the number of free pages in the pool, the number of pages still to
+ * be zeroed by the background worker, how many pages were zeroed by the
+ * worker and by allocations that could not wait for it, how many times the
+ * pool lock was contended, and the number of pages, hits, refills and spills
+ * of the per-CPU magazines:
+ * - mem_pool_stats: statistics of the small page pools of @mem_pools
+ * - lp_mem_pool_stats: statistics of the large page pools of @mem_pools
+ */
+void kbase_mem_pool_stats_debugfs_init(struct dentry *parent,
+		struct kbase_mem_pool_group *mem_pools);
+
 /**
  * kbase_mem_pool_debugfs_trim - Grow or shrink a memory pool to a new size
  *
@@ -25,6 +25,7 @@
 #include <asm/cacheflush.h>
 #if defined(CONFIG_SYNC) || defined(CONFIG_SYNC_FILE)
 #include <mali_kbase_sync.h>
+#include <backend/gpu/mali_kbase_devfreq.h>
 #endif
 #include <linux/dma-mapping.h>
 #include <uapi/gpu/arm/bifrost/mali_base_kernel.h>
@@ -1552,6 +1553,9 @@ int kbase_process_soft_job(struct kbase_jd_atom *katom)
 		katom->event_code = kbase_sync_fence_out_trigger(katom,
 				katom->event_code == BASE_JD_EVENT_DONE ?
 								0 : -EFAULT);
+		/* A signalled output fence marks the end of a frame */
+		if (katom->event_code == BASE_JD_EVENT_DONE)
+			kbase_devfreq_frame_hint(kbdev);
 		break;
 	case BASE_JD_REQ_SOFT_FENCE_WAIT:
 	{
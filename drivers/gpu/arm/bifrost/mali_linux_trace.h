@@ -531,6 +531,36 @@ TRACE_EVENT(mali_jit_trim,
 	TP_printk("freed_pages=%zu", __entry->freed_pages)
 );
 
+#ifdef CONFIG_MALI_BIFROST_DEVFREQ
+/* trace_mali_devfreq_frame
+ *
+ * Tracepoint about the GPU busy time of a frame and the frequency the
+ * frame-aware devfreq governor chose for the next one
+ */
+TRACE_EVENT(mali_devfreq_frame,
+	TP_PROTO(u32 gpu_id, u64 frame_ns, u64 busy_ns,
+		unsigned long cur_freq, unsigned long target_freq),
+	TP_ARGS(gpu_id, frame_ns, busy_ns, cur_freq, target_freq),
+	TP_STRUCT__entry(
+		__field(u32, gpu_id)
+		__field(u64, frame_ns)
+		__field(u64, busy_ns)
+		__field(unsigned long, cur_freq)
+		__field(unsigned long, target_freq)
+	),
+	TP_fast_assign(
+		__entry->gpu_id      = gpu_id;
+		__entry->frame_ns    = frame_ns;
+		__entry->busy_ns     = busy_ns;
+		__entry->cur_freq    = cur_freq;
+		__entry->target_freq = target_freq;
+	),
+	TP_printk("gpu=%u frame_ns=%llu busy_ns=%llu cur_freq=%lu target_freq=%lu",
+		__entry->gpu_id, __entry->frame_ns, __entry->busy_ns,
+		__entry->cur_freq, __entry->target_freq)
+);
+#endif /* CONFIG_MALI_BIFROST_DEVFREQ */
+
 #include "debug/mali_kbase_debug_linux_ktrace.h"
 
 #endif /* _TRACE_MALI_H */
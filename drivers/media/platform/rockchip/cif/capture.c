@@ -1607,6 +1607,93 @@ static void rkcif_assign_new_buffer_init(struct rkcif_stream *stream,
 
 }
 
+/*
+ * Return every buffer of the pending batch to vb2. Called from the irq when
+ * the batch is full, from done_timer and when the stream stops.
+ */
+static void rkcif_done_batch_flush(struct rkcif_stream *stream)
+{
+	struct rkcif_buffer *buf, *tmp;
+	unsigned long flags;
+	LIST_HEAD(done);
+
+	spin_lock_irqsave(&stream->vbq_lock, flags);
+	list_splice_init(&stream->done_head, &done);
+	stream->done_cnt = 0;
+	spin_unlock_irqrestore(&stream->vbq_lock, flags);
+
+	list_for_each_entry_safe(buf, tmp, &done, queue) {
+		list_del(&buf->queue);
+		vb2_buffer_done(&buf->vb.vb2_buf, VB2_BUF_STATE_DONE);
+	}
+}
+
+static void rkcif_done_batch_timer(struct timer_list *t)
+{
+	struct rkcif_stream *stream = from_timer(stream, t, done_timer);
+
+	rkcif_done_batch_flush(stream);
+}
+
+static void rkcif_done_batch_add(struct rkcif_stream *stream,
+				 struct vb2_v4l2_buffer *vb_done)
+{
+	struct rkcif_buffer *buf = to_rkcif_buffer(vb_done);
+	unsigned long flags;
+	unsigned int cnt;
+
+	spin_lock_irqsave(&stream->vbq_lock, flags);
+	list_add_tail(&buf->queue, &stream->done_head);
+	cnt = ++stream->done_cnt;
+	spin_unlock_irqrestore(&stream->vbq_lock, flags);
+
+	if (cnt >= stream->done_batch) {
+		del_timer(&stream->done_timer);
+		rkcif_done_batch_flush(stream);
+	} else if (cnt == 1) {
+		mod_timer(&stream->done_timer, jiffies + stream->done_timeout);
+	}
+}
+
+/*
+ * Pick the number of frames to return at once for this stream on. Batching
+ * is only done for plain frame capture, line wake up and hdr readback want
+ * every frame as early as possible. At least two buffers are kept out of a
+ * batch so that the ping-pong registers can still be fed while it fills.
+ */
+static void rkcif_done_batch_setup(struct rkcif_stream *stream)
+{
+	struct rkcif_device *dev = stream->cifdev;
+	struct v4l2_fract *fi = &dev->terminal_sensor.fi.interval;
+	unsigned int num_buffers = stream->vnode.buf_queue.num_buffers;
+	unsigned int batch, frame_ms = 0;
+
+	batch = clamp_t(unsigned int, READ_ONCE(rkcif_done_batch), 1,
+			RKCIF_DONE_BATCH_MAX);
+	if (dev->hdr.hdr_mode != NO_HDR || stream->is_line_wake_up ||
+	    stream->cif_fmt_in->field == V4L2_FIELD_INTERLACED)
+		batch = 1;
+	if (num_buffers > 2)
+		batch = min(batch, num_buffers - 2);
+	else
+		batch = 1;
+
+	if (fi->denominator)
+		frame_ms = fi->numerator * 1000 / fi->denominator;
+	if (!frame_ms)
+		frame_ms = 33;
+
+	stream->done_batch = batch;
+	stream->done_cnt = 0;
+	stream->done_timeout = msecs_to_jiffies(frame_ms * (batch + 1));
+	stream->starve_frames = 0;
+	memset(stream->starve_hist, 0, sizeof(stream->starve_hist));
+
+	if (batch > 1)
+		v4l2_info(&dev->v4l2_dev, "stream[%d] return %u frames at once\n",
+			  stream->id, batch);
+}
+
 static int rkcif_assign_new_buffer_update(struct rkcif_stream *stream,
 					   int channel_id)
 {
@@ -1639,6 +1726,10 @@ static int rkcif_assign_new_buffer_update(struct rkcif_stream *stream,
 
 	spin_lock_irqsave(&stream->vbq_lock, flags);
 	if (!list_empty(&stream->buf_head)) {
+		if (stream->starve_frames) {
+			rkcif_hist_add(stream->starve_hist, stream->starve_frames);
+			stream->starve_frames = 0;
+		}
 		if (!dummy_buf->vaddr &&
 		    stream->curr_buf == stream->next_buf &&
 		    stream->cif_fmt_in->field != V4L2_FIELD_INTERLACED)
@@ -1670,6 +1761,7 @@ static int rkcif_assign_new_buffer_update(struct rkcif_stream *stream,
 		}
 	} else {
 		buffer = NULL;
+		stream->starve_frames++;
 		if (dummy_buf->vaddr) {
 			if (stream->frame_phase == CIF_CSI_FRAME0_READY) {
 				stream->curr_buf = NULL;
@@ -3204,6 +3296,11 @@ void rkcif_do_stop_stream(struct rkcif_stream *stream,
 				   msecs_to_jiffies(1000));
 	}
 	if ((mode & RKCIF_STREAM_MODE_CAPTURE) == RKCIF_STREAM_MODE_CAPTURE) {
+		/* frames already captured are still good, hand them out first */
+		stream->done_batch = 1;
+		del_timer_sync(&stream->done_timer);
+		rkcif_done_batch_flush(stream);
+
 		/* release buffers */
 		if (stream->curr_buf)
 			list_add_tail(&stream->curr_buf->queue, &stream->buf_head);
@@ -4173,6 +4270,9 @@ int rkcif_do_start_stream(struct rkcif_stream *stream, unsigned int mode)
 	if (ret < 0)
 		goto destroy_buf;
 
+	if (mode & RKCIF_STREAM_MODE_CAPTURE)
+		rkcif_done_batch_setup(stream);
+
 	if (((dev->active_sensor && dev->active_sensor->mbus.type == V4L2_MBUS_BT656) ||
 	     dev->is_use_dummybuf) &&
 	    (!dev->dummy_buf.vaddr)) {
@@ -4516,6 +4616,9 @@ void rkcif_stream_init(struct rkcif_device *dev, u32 id)
 
 	INIT_LIST_HEAD(&stream->buf_head);
 	INIT_LIST_HEAD(&stream->rx_buf_head);
+	INIT_LIST_HEAD(&stream->done_head);
+	timer_setup(&stream->done_timer, rkcif_done_batch_timer, 0);
+	stream->done_batch = 1;
 	spin_lock_init(&stream->vbq_lock);
 	spin_lock_init(&stream->fps_lock);
 	stream->state = RKCIF_STATE_READY;
@@ -5634,7 +5737,11 @@ static void rkcif_vb_done_oneframe(struct rkcif_stream *stream,
 	if (stream->cifdev->hdr.hdr_mode == NO_HDR)
 		vb_done->vb2_buf.timestamp = ktime_get_ns();
 
-	vb2_buffer_done(&vb_done->vb2_buf, VB2_BUF_STATE_DONE);
+	/* timestamp and sequence are per frame, so they survive batching */
+	if (stream->done_batch > 1)
+		rkcif_done_batch_add(stream, vb_done);
+	else
+		vb2_buffer_done(&vb_done->vb2_buf, VB2_BUF_STATE_DONE);
 	v4l2_dbg(1, rkcif_debug, &stream->cifdev->v4l2_dev,
 		 "stream[%d] vb done, index: %d, sequence %d\n", stream->id,
 		 vb_done->vb2_buf.index, vb_done->sequence);
@@ -33,6 +33,10 @@ int rkcif_debug;
 module_param_named(debug, rkcif_debug, int, 0644);
 MODULE_PARM_DESC(debug, "Debug level (0-1)");
 
+uint rkcif_done_batch = 1;
+module_param_named(done_batch, rkcif_done_batch, uint, 0644);
+MODULE_PARM_DESC(done_batch, "Frames returned to userspace at once (1-8), applied at stream on");
+
 static char rkcif_version[RKCIF_VERNO_LEN];
 module_param_string(version, rkcif_version, RKCIF_VERNO_LEN, 0444);
 MODULE_PARM_DESC(version, "version number");
@@ -1433,6 +1437,8 @@ static int rkcif_register_platform_subdevs(struct rkcif_device *cif_dev)
 
 static irqreturn_t rkcif_irq_handler(int irq, struct rkcif_device *cif_dev)
 {
+	u64 start = ktime_get_ns();
+
 	if (cif_dev->workmode == RKCIF_WORKMODE_PINGPONG) {
 		if (cif_dev->chip_id < CHIP_RK3588_CIF)
 			rkcif_irq_pingpong(cif_dev);
@@ -1441,6 +1447,9 @@ static irqreturn_t rkcif_irq_handler(int irq, struct rkcif_device *cif_dev)
 	} else {
 		rkcif_irq_oneframe(cif_dev);
 	}
+
+	rkcif_hist_add(cif_dev->irq_stats.irq_time_hist,
+		       div_u64(ktime_get_ns() - start, NSEC_PER_USEC));
 	return IRQ_HANDLED;
 }
 
@@ -75,6 +75,9 @@
 
 #define RKCIF_RX_BUF_MAX	8
 
+#define RKCIF_HIST_BUCKETS	8
+#define RKCIF_DONE_BATCH_MAX	8
+
 #define RKCIF_MAX_INTERVAL_NS	5000000
 /*
  * for HDR mode sync buf
@@ -195,6 +198,7 @@ struct rkcif_dummy_buffer {
 };
 
 extern int rkcif_debug;
+extern uint rkcif_done_batch;
 
 /*
  * struct rkcif_sensor_info - Sensor infomations
@@ -337,6 +341,7 @@ struct rkcif_readout_stats {
  * @dvp_pix_err_cnt: count dvp pix err irq
  * @all_frm_end_cnt: raw frame end count
  * @all_err_cnt: all err count
+ * @irq_time_hist: histogram of irq handler time, see rkcif_hist_add()
  * @
  */
 struct rkcif_irq_stats {
@@ -351,8 +356,18 @@ struct rkcif_irq_stats {
 	u64 dvp_bwidth_lack_cnt;
 	u64 all_frm_end_cnt;
 	u64 all_err_cnt;
+	u64 irq_time_hist[RKCIF_HIST_BUCKETS];
 };
 
+/*
+ * Log2 histogram: bucket 0 counts zero, bucket n counts values in
+ * [2^(n-1), 2^n) and the last bucket counts everything above.
+ */
+static inline void rkcif_hist_add(u64 *hist, u64 val)
+{
+	hist[min_t(unsigned int, fls64(val), RKCIF_HIST_BUCKETS - 1)]++;
+}
+
 /*
  * the detecting mode of cif reset timer
  * related with dts property:rockchip,cif-monitor
@@ -445,6 +460,14 @@ enum rkcif_dma_en_mode {
  * @curr_buf: the buffer used for current frame
  * @next_buf: the buffer used for next frame
  * @fps_lock: to protect parameters about calculating fps
+ * @done_head: filled buffers waiting to be returned to vb2 as one batch,
+ *	       protected by vbq_lock
+ * @done_cnt: number of buffers in done_head
+ * @done_batch: number of frames returned to vb2 at once, 1 if not batching
+ * @done_timer: returns a partial batch when frames stop arriving
+ * @done_timeout: done_timer period in jiffies
+ * @starve_frames: consecutive frames captured without a free buffer
+ * @starve_hist: histogram of starve_frames runs, see rkcif_hist_add()
  */
 struct rkcif_stream {
 	unsigned id:3;
@@ -486,6 +509,13 @@ struct rkcif_stream {
 	struct list_head		rx_buf_head;
 	int				buf_num_toisp;
 	u64				line_int_cnt;
+	struct list_head		done_head;
+	unsigned int			done_cnt;
+	unsigned int			done_batch;
+	struct timer_list		done_timer;
+	unsigned long			done_timeout;
+	unsigned int			starve_frames;
+	u64				starve_hist[RKCIF_HIST_BUCKETS];
 	bool				stopping;
 	bool				crop_enable;
 	bool				crop_dyn_en;
@@ -241,6 +241,18 @@ static void rkcif_show_clks(struct rkcif_device *dev, struct seq_file *f)
 	}
 }
 
+/* print a histogram filled by rkcif_hist_add() as one line of ranges */
+static void rkcif_show_hist(struct seq_file *f, const char *name, const u64 *hist)
+{
+	int i;
+
+	seq_printf(f, "\t%s:", name);
+	seq_printf(f, " 0:%llu", hist[0]);
+	for (i = 1; i < RKCIF_HIST_BUCKETS - 1; i++)
+		seq_printf(f, " %u-%u:%llu", 1U << (i - 1), (1U << i) - 1, hist[i]);
+	seq_printf(f, " %u+:%llu\n", 1U << (i - 1), hist[i]);
+}
+
 static void rkcif_show_format(struct rkcif_device *dev, struct seq_file *f)
 {
 	struct rkcif_stream *stream = &dev->stream[0];
@@ -351,6 +363,9 @@ static void rkcif_show_format(struct rkcif_device *dev, struct seq_file *f)
 		}
 		seq_printf(f, "\t\t\tall err count:%llu\n", dev->irq_stats.all_err_cnt);
 		seq_printf(f, "\t\t\tframe dma end:%llu\n", dev->irq_stats.all_frm_end_cnt);
+		seq_printf(f, "\tdone batch:%u\n", stream->done_batch);
+		rkcif_show_hist(f, "irq time(us)", dev->irq_stats.irq_time_hist);
+		rkcif_show_hist(f, "starved frames", stream->starve_hist);
 	}
 }
 
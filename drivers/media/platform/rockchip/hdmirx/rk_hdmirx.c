@@ -9,7 +9,10 @@
 #include <linux/cpufreq.h>
 #include <linux/debugfs.h>
 #include <linux/delay.h>
+#include <linux/dma-buf.h>
+#include <linux/dma-fence.h>
 #include <linux/dma-mapping.h>
+#include <linux/dma-resv.h>
 #include <linux/fs.h>
 #include <linux/gpio/consumer.h>
 #include <linux/interrupt.h>
@@ -49,6 +52,10 @@ static int debug;
 module_param(debug, int, 0644);
 MODULE_PARM_DESC(debug, "debug level (0-3)");
 
+static bool low_latency;
+module_param(low_latency, bool, 0644);
+MODULE_PARM_DESC(low_latency, "capture into the newest free mmap buffer, fence dmabuf buffers");
+
 #define	RK_HDMIRX_DRVNAME		"rk_hdmirx"
 #define EDID_NUM_BLOCKS_MAX		2
 #define EDID_BLOCK_SIZE			128
@@ -133,6 +140,14 @@ struct hdmirx_buffer {
 		u32 buff_addr[VIDEO_MAX_PLANES];
 		void *vaddr[VIDEO_MAX_PLANES];
 	};
+	struct dma_fence *fence;
+	u64 done_ns;
+};
+
+struct hdmirx_latency {
+	u64 cnt;
+	u64 total_ns;
+	u64 max_ns;
 };
 
 struct hdmirx_output_fmt {
@@ -158,6 +173,11 @@ struct hdmirx_stream {
 	u32 frame_idx;
 	u32 line_flag_int_cnt;
 	u32 irq_stat;
+	u32 drop_cnt;
+	u64 fence_context;
+	u32 fence_seqno;
+	spinlock_t fence_lock;
+	struct hdmirx_latency dq_latency;
 };
 
 struct rk_hdmirx_dev {
@@ -1558,6 +1578,83 @@ static int hdmirx_queue_setup(struct vb2_queue *queue,
 	return 0;
 }
 
+static const char *hdmirx_fence_get_driver_name(struct dma_fence *fence)
+{
+	return RK_HDMIRX_DRVNAME;
+}
+
+static const char *hdmirx_fence_get_timeline_name(struct dma_fence *fence)
+{
+	return HDMIRX_VDEV_NAME;
+}
+
+static const struct dma_fence_ops hdmirx_fence_ops = {
+	.get_driver_name = hdmirx_fence_get_driver_name,
+	.get_timeline_name = hdmirx_fence_get_timeline_name,
+};
+
+/*
+ * In low latency mode an imported dmabuf gets an exclusive fence that
+ * signals when the frame has been captured into it, so an encoder or
+ * display sharing the dmabuf can be queued before the buffer is dequeued.
+ * Dmabuf buffers are captured in queue order, see hdmirx_capture_newest().
+ */
+static void hdmirx_buf_arm_fence(struct hdmirx_stream *stream,
+				 struct hdmirx_buffer *buf)
+{
+	struct vb2_buffer *vb = &buf->vb.vb2_buf;
+	struct dma_fence *fence;
+	unsigned long flags;
+	u32 i;
+
+	if (!low_latency || vb->memory != VB2_MEMORY_DMABUF)
+		return;
+
+	fence = kzalloc(sizeof(*fence), GFP_KERNEL);
+	if (!fence)
+		return;
+
+	spin_lock_irqsave(&stream->fence_lock, flags);
+	dma_fence_init(fence, &hdmirx_fence_ops, &stream->fence_lock,
+		       stream->fence_context, ++stream->fence_seqno);
+	spin_unlock_irqrestore(&stream->fence_lock, flags);
+
+	for (i = 0; i < vb->num_planes; i++) {
+		struct dma_buf *dbuf = vb->planes[i].dbuf;
+
+		if (!dbuf)
+			continue;
+		dma_resv_lock(dbuf->resv, NULL);
+		dma_resv_add_excl_fence(dbuf->resv, fence);
+		dma_resv_unlock(dbuf->resv);
+	}
+	buf->fence = fence;
+}
+
+/*
+ * Fences on one context must signal in seqno order, which is the order the
+ * buffers were queued in. Only skip ahead to the newest buffer when the queue
+ * holds no fenced (dmabuf) buffers.
+ */
+static bool hdmirx_capture_newest(struct hdmirx_stream *stream)
+{
+	return low_latency && stream->buf_queue.memory != VB2_MEMORY_DMABUF;
+}
+
+static void hdmirx_buf_signal_fence(struct hdmirx_buffer *buf, bool error)
+{
+	struct dma_fence *fence = buf->fence;
+
+	if (!fence)
+		return;
+
+	buf->fence = NULL;
+	if (error)
+		dma_fence_set_error(fence, -EIO);
+	dma_fence_signal(fence);
+	dma_fence_put(fence);
+}
+
 /*
  * The vb2_buffer are stored in hdmirx_buffer, in order to unify
  * mplane buffer and none-mplane buffer.
@@ -1606,11 +1703,35 @@ static void hdmirx_buf_queue(struct vb2_buffer *vb)
 		}
 	}
 
+	hdmirx_buf->done_ns = 0;
+	hdmirx_buf_arm_fence(stream, hdmirx_buf);
+
 	spin_lock_irqsave(&stream->vbq_lock, lock_flags);
 	list_add_tail(&hdmirx_buf->queue, &stream->buf_head);
 	spin_unlock_irqrestore(&stream->vbq_lock, lock_flags);
 }
 
+static void hdmirx_buf_finish(struct vb2_buffer *vb)
+{
+	struct vb2_v4l2_buffer *vbuf = to_vb2_v4l2_buffer(vb);
+	struct hdmirx_buffer *hdmirx_buf = to_hdmirx_buffer(vbuf);
+	struct hdmirx_stream *stream = vb2_get_drv_priv(vb->vb2_queue);
+	struct hdmirx_latency *lat = &stream->dq_latency;
+	u64 ns;
+
+	/* buffers cancelled by streamoff are not dequeued by userspace */
+	if (vb->state != VB2_BUF_STATE_DONE || !hdmirx_buf->done_ns ||
+	    !vb2_is_streaming(vb->vb2_queue))
+		return;
+
+	ns = ktime_get_ns() - hdmirx_buf->done_ns;
+	hdmirx_buf->done_ns = 0;
+	lat->cnt++;
+	lat->total_ns += ns;
+	if (ns > lat->max_ns)
+		lat->max_ns = ns;
+}
+
 static void return_all_buffers(struct hdmirx_stream *stream,
 			       enum vb2_buffer_state state)
 {
@@ -1630,6 +1751,7 @@ static void return_all_buffers(struct hdmirx_stream *stream,
 				       struct hdmirx_buffer, queue);
 		list_del(&buf->queue);
 		spin_unlock_irqrestore(&stream->vbq_lock, flags);
+		hdmirx_buf_signal_fence(buf, true);
 		vb2_buffer_done(&buf->vb.vb2_buf, state);
 		spin_lock_irqsave(&stream->vbq_lock, flags);
 	}
@@ -1678,6 +1800,8 @@ static int hdmirx_start_streaming(struct vb2_queue *queue, unsigned int count)
 	stream->curr_buf = NULL;
 	stream->next_buf = NULL;
 	stream->irq_stat = 0;
+	stream->drop_cnt = 0;
+	memset(&stream->dq_latency, 0, sizeof(stream->dq_latency));
 	stream->stopping = false;
 
 	spin_lock_irqsave(&stream->vbq_lock, lock_flags);
@@ -1746,6 +1870,7 @@ static int hdmirx_start_streaming(struct vb2_queue *queue, unsigned int count)
 static struct vb2_ops hdmirx_vb2_ops = {
 	.queue_setup = hdmirx_queue_setup,
 	.buf_queue = hdmirx_buf_queue,
+	.buf_finish = hdmirx_buf_finish,
 	.wait_prepare = vb2_ops_wait_prepare,
 	.wait_finish = vb2_ops_wait_finish,
 	.stop_streaming = hdmirx_stop_streaming,
@@ -1829,6 +1954,8 @@ static int hdmirx_register_stream_vdev(struct hdmirx_stream *stream)
 	strscpy(vdev->name, vdev_name, sizeof(vdev->name));
 	INIT_LIST_HEAD(&stream->buf_head);
 	spin_lock_init(&stream->vbq_lock);
+	spin_lock_init(&stream->fence_lock);
+	stream->fence_context = dma_fence_context_alloc(1);
 	mutex_init(&stream->vlock);
 	init_waitqueue_head(&stream->wq_stopped);
 	stream->curr_buf = NULL;
@@ -2056,6 +2183,7 @@ static void hdmirx_vb_done(struct hdmirx_stream *stream,
 				   struct vb2_v4l2_buffer *vb_done)
 {
 	const struct hdmirx_output_fmt *fmt = stream->out_fmt;
+	struct hdmirx_buffer *buf = to_hdmirx_buffer(vb_done);
 	u32 i;
 
 	/* Dequeue a filled buffer */
@@ -2065,6 +2193,8 @@ static void hdmirx_vb_done(struct hdmirx_stream *stream,
 	}
 
 	vb_done->vb2_buf.timestamp = ktime_get_ns();
+	buf->done_ns = vb_done->vb2_buf.timestamp;
+	hdmirx_buf_signal_fence(buf, false);
 	vb2_buffer_done(&vb_done->vb2_buf, VB2_BUF_STATE_DONE);
 }
 
@@ -2102,6 +2232,13 @@ static void dma_idle_int_handler(struct rk_hdmirx_dev *hdmirx_dev, bool *handled
 				stream->next_buf = NULL;
 			}
 		} else {
+			/*
+			 * The dma keeps writing into curr_buf, so the frame it
+			 * held is dropped in favour of the newest one.
+			 */
+			stream->drop_cnt++;
+			if (low_latency)
+				stream->frame_idx++;
 			v4l2_dbg(3, debug, v4l2_dev,
 				 "%s: next_buf NULL, skip vb_done!\n", __func__);
 		}
@@ -2137,8 +2274,12 @@ static void line_flag_int_handler(struct rk_hdmirx_dev *hdmirx_dev, bool *handle
 		if (!stream->next_buf) {
 			spin_lock(&stream->vbq_lock);
 			if (!list_empty(&stream->buf_head)) {
-				stream->next_buf = list_first_entry(&stream->buf_head,
-						struct hdmirx_buffer, queue);
+				if (hdmirx_capture_newest(stream))
+					stream->next_buf = list_last_entry(&stream->buf_head,
+							struct hdmirx_buffer, queue);
+				else
+					stream->next_buf = list_first_entry(&stream->buf_head,
+							struct hdmirx_buffer, queue);
 				list_del(&stream->next_buf->queue);
 			} else {
 				stream->next_buf = NULL;
@@ -3174,6 +3315,8 @@ static const struct file_operations hdmirx_phy_fops = {
 static int hdmirx_status_show(struct seq_file *s, void *v)
 {
 	struct rk_hdmirx_dev *hdmirx_dev = s->private;
+	struct hdmirx_stream *stream = &hdmirx_dev->stream;
+	struct hdmirx_latency *lat = &stream->dq_latency;
 	struct v4l2_dv_timings timings = hdmirx_dev->timings;
 	struct v4l2_bt_timings *bt = &timings.bt;
 	bool plugin;
@@ -3270,6 +3413,11 @@ static int hdmirx_status_show(struct seq_file *s, void *v)
 		   bt->hfrontporch, bt->hsync, bt->hbackporch,
 		   bt->vfrontporch, bt->vsync, bt->vbackporch);
 	seq_printf(s, "Pixel Clk: %llu\n", bt->pixelclock);
+	seq_printf(s, "Capture: frame:%u drop:%u dq-latency cnt:%llu avg:%lluus max:%lluus%s\n",
+		   stream->frame_idx, stream->drop_cnt, lat->cnt,
+		   lat->cnt ? div64_u64(lat->total_ns, lat->cnt * 1000) : 0,
+		   div_u64(lat->max_ns, 1000),
+		   low_latency ? " (low latency)" : "");
 
 	return 0;
 }
@@ -132,6 +132,7 @@ struct rkisp_dummy_buffer {
 
 extern int rkisp_debug;
 extern bool rkisp_monitor;
+extern bool rkisp_params_lazy;
 extern u64 rkisp_debug_reg;
 extern struct platform_driver rkisp_plat_drv;
 
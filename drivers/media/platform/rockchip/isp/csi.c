@@ -658,6 +658,7 @@ int rkisp_csi_config_patch(struct rkisp_device *dev)
 	dev->rdbk_cnt_x1 = -1;
 	dev->rdbk_cnt_x2 = -1;
 	dev->rdbk_cnt_x3 = -1;
+	memset(&dev->rdbk_wait, 0, sizeof(dev->rdbk_wait));
 	dev->rd_mode = dev->hdr.op_mode;
 
 	return ret;
@@ -26,6 +26,7 @@ enum {
 	T_CMD_QUEUE,
 	T_CMD_DEQUEUE,
 	T_CMD_LEN,
+	T_CMD_PEEK,
 	T_CMD_END,
 };
 
@@ -63,6 +63,10 @@ bool rkisp_monitor;
 module_param_named(monitor, rkisp_monitor, bool, 0644);
 MODULE_PARM_DESC(monitor, "rkisp abnormal restart monitor");
 
+bool rkisp_params_lazy = true;
+module_param_named(params_lazy, rkisp_params_lazy, bool, 0644);
+MODULE_PARM_DESC(params_lazy, "rkisp only write isp params modules that changed");
+
 static bool rkisp_clk_dbg;
 module_param_named(clk_dbg, rkisp_clk_dbg, bool, 0644);
 MODULE_PARM_DESC(clk_dbg, "rkisp clk set by user");
@@ -858,6 +862,8 @@ static int rkisp_plat_probe(struct platform_device *pdev)
 
 	rkisp_wait_line = 0;
 	of_property_read_u32(dev->of_node, "wait-line", &rkisp_wait_line);
+	of_property_read_u32(dev->of_node, "rockchip,rdbk-priority",
+			     &isp_dev->rdbk_prio);
 
 	rkisp_proc_init(isp_dev);
 
@@ -159,6 +159,37 @@ struct rkisp_hdr {
 	struct rkisp_dummy_buffer dummy_buf[HDR_DMA_MAX][HDR_MAX_DUMMY_BUF];
 };
 
+#define RKISP_RDBK_FIFO_NUM		16
+#define RKISP_RDBK_WAIT_HIST		8
+
+/*
+ * struct rkisp_rdbk_trigger - read back request waiting in rdbk_kfifo
+ *
+ * @trigger: request from userspace or dmarx
+ * @queue_ns: time the request was queued
+ * @deadline_ns: queue time plus one sensor frame interval
+ */
+struct rkisp_rdbk_trigger {
+	struct isp2x_csi_trigger trigger;
+	u64 queue_ns;
+	u64 deadline_ns;
+};
+
+/*
+ * struct rkisp_rdbk_wait - time read back requests waited for the shared isp
+ *
+ * @cnt: requests started
+ * @total_ns: sum of the wait times
+ * @max_ns: longest wait
+ * @hist: wait times, bucket 0 below 1ms and bucket n in [2^(n-1), 2^n) ms
+ */
+struct rkisp_rdbk_wait {
+	u64 cnt;
+	u64 total_ns;
+	u64 max_ns;
+	u32 hist[RKISP_RDBK_WAIT_HIST];
+};
+
 /*
  * struct rkisp_device - ISP platform device
  * @base_addr: base register address
@@ -227,6 +258,8 @@ struct rkisp_device {
 	int rdbk_cnt_x1;
 	int rdbk_cnt_x2;
 	int rdbk_cnt_x3;
+	u32 rdbk_prio;
+	struct rkisp_rdbk_wait rdbk_wait;
 	u32 rd_mode;
 
 	struct rkisp_rx_buf_pool pv_pool[RKISP_RX_BUF_POOL_MAX];
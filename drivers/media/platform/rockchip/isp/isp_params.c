@@ -358,6 +358,9 @@ void rkisp_params_first_cfg(struct rkisp_isp_params_vdev *params_vdev,
 	params_vdev->quantization = quantization;
 	params_vdev->raw_type = in_fmt->bayer_pat;
 	params_vdev->in_mbus_code = in_fmt->mbus_code;
+	/* nothing of the first params is in hardware yet */
+	memset(params_vdev->cfg_rec_mask, 0, sizeof(params_vdev->cfg_rec_mask));
+	memset(&params_vdev->cfg_stats, 0, sizeof(params_vdev->cfg_stats));
 	params_vdev->ops->first_cfg(params_vdev);
 }
 
@@ -388,6 +391,60 @@ void rkisp_params_stream_stop(struct rkisp_isp_params_vdev *params_vdev)
 		params_vdev->ops->stream_stop(params_vdev);
 }
 
+/*
+ * Return module_cfg_update without the modules of @modules whose config in
+ * @new_params is the one already written to hardware, and record the others
+ * in @rec_params. @rec_params is the first params struct of the isp version,
+ * which holds the last config written for each module. @id selects the isp
+ * of a unite pair. Modules not in @modules are always kept.
+ */
+u64 rkisp_params_cfg_changed(struct rkisp_isp_params_vdev *params_vdev,
+			     const struct rkisp_params_module *modules, int num,
+			     u64 module_cfg_update, const void *new_params,
+			     void *rec_params, u32 id)
+{
+	u64 *rec_mask = &params_vdev->cfg_rec_mask[id];
+	u64 skip = 0;
+	int i;
+
+	for (i = 0; i < num; i++) {
+		const struct rkisp_params_module *mod = &modules[i];
+		const void *new_cfg = new_params + mod->offset;
+		void *rec_cfg = rec_params + mod->offset;
+
+		if (!(module_cfg_update & mod->id))
+			continue;
+		/* first config is written from the record itself */
+		if (new_params != rec_params) {
+			if (rkisp_params_lazy && (*rec_mask & mod->id) &&
+			    !memcmp(new_cfg, rec_cfg, mod->size)) {
+				skip |= mod->id;
+				continue;
+			}
+			memcpy(rec_cfg, new_cfg, mod->size);
+		}
+		*rec_mask |= mod->id;
+	}
+
+	params_vdev->cfg_stats.skipped += hweight64(skip);
+	return module_cfg_update & ~skip;
+}
+
+void rkisp_params_cfg_stats_start(struct rkisp_isp_params_vdev *params_vdev)
+{
+	params_vdev->cfg_stats.cur_bytes = 0;
+}
+
+void rkisp_params_cfg_stats_end(struct rkisp_isp_params_vdev *params_vdev)
+{
+	struct rkisp_params_cfg_stats *stats = &params_vdev->cfg_stats;
+
+	stats->last_bytes = stats->cur_bytes;
+	stats->max_bytes = max(stats->max_bytes, stats->cur_bytes);
+	stats->total_bytes += stats->cur_bytes;
+	stats->frames++;
+}
+
 bool rkisp_params_check_bigmode(struct rkisp_isp_params_vdev *params_vdev)
 {
 	if (params_vdev->ops->check_bigmode)
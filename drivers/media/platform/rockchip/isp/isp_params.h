@@ -24,6 +24,49 @@ enum rkisp_params_type {
 	RKISP_PARAMS_SHD,
 };
 
+/*
+ * struct rkisp_params_module - where a module config lives in a params buffer
+ *
+ * @id: module bit in module_cfg_update
+ * @offset: offset of the module config in the params buffer
+ * @size: size of the module config
+ *
+ * Modules listed in these tables are only written when their config differs
+ * from the one in hardware. Modules that are also written at readback, hand
+ * buffers over on every config or depend on another module are left out and
+ * always written.
+ */
+struct rkisp_params_module {
+	u64 id;
+	u32 offset;
+	u32 size;
+};
+
+#define RKISP_PARAMS_MODULE(_id, _type, _member) {	\
+	.id = (_id),					\
+	.offset = offsetof(_type, _member),		\
+	.size = sizeof_field(_type, _member),		\
+}
+
+/*
+ * struct rkisp_params_cfg_stats - register writes done to apply params
+ *
+ * @cur_bytes: bytes written for the params buffer being applied
+ * @last_bytes: bytes written for the last applied params buffer
+ * @max_bytes: largest last_bytes since stream on
+ * @total_bytes: bytes written for all params buffers since stream on
+ * @frames: params buffers applied since stream on
+ * @skipped: module configs not written since they did not change
+ */
+struct rkisp_params_cfg_stats {
+	u32 cur_bytes;
+	u32 last_bytes;
+	u32 max_bytes;
+	u64 total_bytes;
+	u32 frames;
+	u64 skipped;
+};
+
 struct rkisp_isp_params_vdev;
 struct rkisp_isp_params_ops {
 	void (*save_first_param)(struct rkisp_isp_params_vdev *params_vdev, void *param);
@@ -49,6 +92,9 @@ struct rkisp_isp_params_ops {
  *
  * @cur_params: Current ISP parameters
  * @first_params: the first params should take effect immediately
+ * @cfg_rec_mask: modules whose config in the first params struct, used as
+ *		  the record of the config in hardware, has been written
+ * @cfg_stats: register writes done to apply params
  */
 struct rkisp_isp_params_vdev {
 	struct rkisp_vdev_node vnode;
@@ -88,6 +134,9 @@ struct rkisp_isp_params_vdev {
 
 	bool is_subs_evt;
 	bool is_first_cfg;
+
+	u64 cfg_rec_mask[ISP3_UNITE_MAX];
+	struct rkisp_params_cfg_stats cfg_stats;
 };
 
 static inline void
@@ -146,5 +195,11 @@ void rkisp_params_get_meshbuf_inf(struct rkisp_isp_params_vdev *params_vdev,
 void rkisp_params_set_meshbuf_size(struct rkisp_isp_params_vdev *params_vdev,
 				   void *meshsize);
 void rkisp_params_stream_stop(struct rkisp_isp_params_vdev *params_vdev);
+u64 rkisp_params_cfg_changed(struct rkisp_isp_params_vdev *params_vdev,
+			     const struct rkisp_params_module *modules, int num,
+			     u64 module_cfg_update, const void *new_params,
+			     void *rec_params, u32 id);
+void rkisp_params_cfg_stats_start(struct rkisp_isp_params_vdev *params_vdev);
+void rkisp_params_cfg_stats_end(struct rkisp_isp_params_vdev *params_vdev);
 bool rkisp_params_check_bigmode(struct rkisp_isp_params_vdev *params_vdev);
 #endif /* _RKISP_ISP_PARAM_H */
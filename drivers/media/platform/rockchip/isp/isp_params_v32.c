@@ -29,6 +29,7 @@ static inline void
 isp3_param_write_direct(struct rkisp_isp_params_vdev *params_vdev,
 			u32 value, u32 addr)
 {
+	params_vdev->cfg_stats.cur_bytes += 4;
 	rkisp_write(params_vdev->dev, addr, value, true);
 }
 
@@ -36,6 +37,7 @@ static inline void
 isp3_param_write(struct rkisp_isp_params_vdev *params_vdev,
 		 u32 value, u32 addr)
 {
+	params_vdev->cfg_stats.cur_bytes += 4;
 	rkisp_write(params_vdev->dev, addr, value, false);
 }
 
@@ -61,6 +63,7 @@ static inline void
 isp3_param_set_bits(struct rkisp_isp_params_vdev *params_vdev,
 		    u32 reg, u32 bit_mask)
 {
+	params_vdev->cfg_stats.cur_bytes += 4;
 	rkisp_set_bits(params_vdev->dev, reg, 0, bit_mask, false);
 }
 
@@ -68,6 +71,7 @@ static inline void
 isp3_param_clear_bits(struct rkisp_isp_params_vdev *params_vdev,
 		      u32 reg, u32 bit_mask)
 {
+	params_vdev->cfg_stats.cur_bytes += 4;
 	rkisp_clear_bits(params_vdev->dev, reg, bit_mask, false);
 }
 
@@ -3670,6 +3674,41 @@ struct rkisp_isp_params_ops_v32 isp_params_ops_v32 = {
 	.vsm_enable = isp_vsm_enable,
 };
 
+static const struct rkisp_params_module isp32_other_modules[] = {
+	RKISP_PARAMS_MODULE(ISP32_MODULE_LSC, struct isp32_isp_params_cfg, others.lsc_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_DPCC, struct isp32_isp_params_cfg, others.dpcc_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_BLS, struct isp32_isp_params_cfg, others.bls_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_SDG, struct isp32_isp_params_cfg, others.sdg_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_AWB_GAIN, struct isp32_isp_params_cfg, others.awb_gain_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_DEBAYER, struct isp32_isp_params_cfg, others.debayer_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_CCM, struct isp32_isp_params_cfg, others.ccm_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_GOC, struct isp32_isp_params_cfg, others.gammaout_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_CGC, struct isp32_isp_params_cfg, others.cgc_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_CSM, struct isp32_isp_params_cfg, others.csm_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_GIC, struct isp32_isp_params_cfg, others.gic_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_DHAZ, struct isp32_isp_params_cfg, others.dhaz_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_3DLUT, struct isp32_isp_params_cfg, others.isp3dlut_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_YNR, struct isp32_isp_params_cfg, others.ynr_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_CNR, struct isp32_isp_params_cfg, others.cnr_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_SHARP, struct isp32_isp_params_cfg, others.sharp_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_BAYNR, struct isp32_isp_params_cfg, others.baynr_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_BAY3D, struct isp32_isp_params_cfg, others.bay3d_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_GAIN, struct isp32_isp_params_cfg, others.gain_cfg),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_VSM, struct isp32_isp_params_cfg, others.vsm_cfg),
+};
+
+static const struct rkisp_params_module isp32_meas_modules[] = {
+	RKISP_PARAMS_MODULE(ISP32_MODULE_RAWAF, struct isp32_isp_params_cfg, meas.rawaf),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_RAWAE0, struct isp32_isp_params_cfg, meas.rawae0),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_RAWAE1, struct isp32_isp_params_cfg, meas.rawae1),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_RAWAE2, struct isp32_isp_params_cfg, meas.rawae2),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_RAWHIST0, struct isp32_isp_params_cfg, meas.rawhist0),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_RAWHIST1, struct isp32_isp_params_cfg, meas.rawhist1),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_RAWHIST2, struct isp32_isp_params_cfg, meas.rawhist2),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_RAWHIST3, struct isp32_isp_params_cfg, meas.rawhist3),
+	RKISP_PARAMS_MODULE(ISP32_MODULE_RAWAWB, struct isp32_isp_params_cfg, meas.rawawb),
+};
+
 static __maybe_unused
 void __isp_isr_other_config(struct rkisp_isp_params_vdev *params_vdev,
 			    const struct isp32_isp_params_cfg *new_params,
@@ -3688,6 +3727,11 @@ void __isp_isr_other_config(struct rkisp_isp_params_vdev *params_vdev,
 		return;
 	}
 
+	module_cfg_update = rkisp_params_cfg_changed(params_vdev, isp32_other_modules,
+						     ARRAY_SIZE(isp32_other_modules),
+						     module_cfg_update, new_params,
+						     params_vdev->isp32_params, 0);
+
 	v4l2_dbg(4, rkisp_debug, &params_vdev->dev->v4l2_dev,
 		 "%s seq:%d module_cfg_update:0x%llx\n",
 		 __func__, new_params->frame_id, module_cfg_update);
@@ -3898,6 +3942,11 @@ void __isp_isr_meas_config(struct rkisp_isp_params_vdev *params_vdev,
 	if (type == RKISP_PARAMS_SHD)
 		return;
 
+	module_cfg_update = rkisp_params_cfg_changed(params_vdev, isp32_meas_modules,
+						     ARRAY_SIZE(isp32_meas_modules),
+						     module_cfg_update, new_params,
+						     params_vdev->isp32_params, 0);
+
 	v4l2_dbg(4, rkisp_debug, &params_vdev->dev->v4l2_dev,
 		 "%s seq:%d module_cfg_update:0x%llx\n",
 		 __func__, new_params->frame_id, module_cfg_update);
@@ -4452,12 +4501,14 @@ rkisp_params_cfg_v32(struct rkisp_isp_params_vdev *params_vdev,
 		goto unlock;
 
 	new_params = (struct isp32_isp_params_cfg *)(cur_buf->vaddr[0]);
+	rkisp_params_cfg_stats_start(params_vdev);
 	__isp_isr_meas_config(params_vdev, new_params, type);
 	__isp_isr_other_config(params_vdev, new_params, type);
 	__isp_isr_other_en(params_vdev, new_params, type);
 	__isp_isr_meas_en(params_vdev, new_params, type);
 	if (!hw_dev->is_single && type != RKISP_PARAMS_SHD)
 		__isp_config_hdrshd(params_vdev);
+	rkisp_params_cfg_stats_end(params_vdev);
 
 	if (type != RKISP_PARAMS_IMD) {
 		struct rkisp_isp_params_val_v32 *priv_val =
@@ -28,6 +28,7 @@ static inline void
 isp3_param_write_direct(struct rkisp_isp_params_vdev *params_vdev,
 			u32 value, u32 addr, u32 id)
 {
+	params_vdev->cfg_stats.cur_bytes += 4;
 	if (id == ISP3_LEFT)
 		rkisp_write(params_vdev->dev, addr, value, true);
 	else
@@ -38,6 +39,7 @@ static inline void
 isp3_param_write(struct rkisp_isp_params_vdev *params_vdev,
 		 u32 value, u32 addr, u32 id)
 {
+	params_vdev->cfg_stats.cur_bytes += 4;
 	if (id == ISP3_LEFT)
 		rkisp_write(params_vdev->dev, addr, value, false);
 	else
@@ -87,6 +89,7 @@ static inline void
 isp3_param_set_bits(struct rkisp_isp_params_vdev *params_vdev,
 		    u32 reg, u32 bit_mask, u32 id)
 {
+	params_vdev->cfg_stats.cur_bytes += 4;
 	if (id == ISP3_LEFT)
 		rkisp_set_bits(params_vdev->dev, reg, 0, bit_mask, false);
 	else
@@ -97,6 +100,7 @@ static inline void
 isp3_param_clear_bits(struct rkisp_isp_params_vdev *params_vdev,
 		      u32 reg, u32 bit_mask, u32 id)
 {
+	params_vdev->cfg_stats.cur_bytes += 4;
 	if (id == ISP3_LEFT)
 		rkisp_clear_bits(params_vdev->dev, reg, bit_mask, false);
 	else
@@ -3779,6 +3783,40 @@ struct rkisp_isp_params_ops_v3x isp_params_ops_v3x = {
 	.cgc_config = isp_cgc_config,
 };
 
+static const struct rkisp_params_module isp3x_other_modules[] = {
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_LSC, struct isp3x_isp_params_cfg, others.lsc_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_DPCC, struct isp3x_isp_params_cfg, others.dpcc_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_BLS, struct isp3x_isp_params_cfg, others.bls_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_SDG, struct isp3x_isp_params_cfg, others.sdg_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_AWB_GAIN, struct isp3x_isp_params_cfg, others.awb_gain_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_DEBAYER, struct isp3x_isp_params_cfg, others.debayer_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_CCM, struct isp3x_isp_params_cfg, others.ccm_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_GOC, struct isp3x_isp_params_cfg, others.gammaout_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_CGC, struct isp3x_isp_params_cfg, others.cgc_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_CSM, struct isp3x_isp_params_cfg, others.csm_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_GIC, struct isp3x_isp_params_cfg, others.gic_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_DHAZ, struct isp3x_isp_params_cfg, others.dhaz_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_3DLUT, struct isp3x_isp_params_cfg, others.isp3dlut_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_YNR, struct isp3x_isp_params_cfg, others.ynr_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_CNR, struct isp3x_isp_params_cfg, others.cnr_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_SHARP, struct isp3x_isp_params_cfg, others.sharp_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_BAYNR, struct isp3x_isp_params_cfg, others.baynr_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_BAY3D, struct isp3x_isp_params_cfg, others.bay3d_cfg),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_GAIN, struct isp3x_isp_params_cfg, others.gain_cfg),
+};
+
+static const struct rkisp_params_module isp3x_meas_modules[] = {
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_RAWAF, struct isp3x_isp_params_cfg, meas.rawaf),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_RAWAE0, struct isp3x_isp_params_cfg, meas.rawae0),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_RAWAE1, struct isp3x_isp_params_cfg, meas.rawae1),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_RAWAE2, struct isp3x_isp_params_cfg, meas.rawae2),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_RAWHIST0, struct isp3x_isp_params_cfg, meas.rawhist0),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_RAWHIST1, struct isp3x_isp_params_cfg, meas.rawhist1),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_RAWHIST2, struct isp3x_isp_params_cfg, meas.rawhist2),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_RAWHIST3, struct isp3x_isp_params_cfg, meas.rawhist3),
+	RKISP_PARAMS_MODULE(ISP3X_MODULE_RAWAWB, struct isp3x_isp_params_cfg, meas.rawawb),
+};
+
 static __maybe_unused
 void __isp_isr_other_config(struct rkisp_isp_params_vdev *params_vdev,
 			    const struct isp3x_isp_params_cfg *new_params,
@@ -3797,6 +3835,11 @@ void __isp_isr_other_config(struct rkisp_isp_params_vdev *params_vdev,
 		return;
 	}
 
+	module_cfg_update = rkisp_params_cfg_changed(params_vdev, isp3x_other_modules,
+						     ARRAY_SIZE(isp3x_other_modules),
+						     module_cfg_update, new_params,
+						     params_vdev->isp3x_params + id, id);
+
 	v4l2_dbg(4, rkisp_debug, &params_vdev->dev->v4l2_dev,
 		 "%s id:%d seq:%d module_cfg_update:0x%llx\n",
 		 __func__, id, new_params->frame_id, module_cfg_update);
@@ -4001,6 +4044,11 @@ void __isp_isr_meas_config(struct rkisp_isp_params_vdev *params_vdev,
 	if (type == RKISP_PARAMS_SHD)
 		return;
 
+	module_cfg_update = rkisp_params_cfg_changed(params_vdev, isp3x_meas_modules,
+						     ARRAY_SIZE(isp3x_meas_modules),
+						     module_cfg_update, new_params,
+						     params_vdev->isp3x_params + id, id);
+
 	v4l2_dbg(4, rkisp_debug, &params_vdev->dev->v4l2_dev,
 		 "%s id:%d seq:%d module_cfg_update:0x%llx\n",
 		 __func__, id, new_params->frame_id, module_cfg_update);
@@ -4573,6 +4621,7 @@ rkisp_params_cfg_v3x(struct rkisp_isp_params_vdev *params_vdev,
 		goto unlock;
 
 	new_params = (struct isp3x_isp_params_cfg *)(cur_buf->vaddr[0]);
+	rkisp_params_cfg_stats_start(params_vdev);
 	if (hw_dev->is_unite) {
 		__isp_isr_meas_config(params_vdev, new_params + 1, type, 1);
 		__isp_isr_other_config(params_vdev, new_params + 1, type, 1);
@@ -4585,6 +4634,7 @@ rkisp_params_cfg_v3x(struct rkisp_isp_params_vdev *params_vdev,
 	__isp_isr_meas_en(params_vdev, new_params, type, 0);
 	if (!hw_dev->is_single && type != RKISP_PARAMS_SHD)
 		__isp_config_hdrshd(params_vdev);
+	rkisp_params_cfg_stats_end(params_vdev);
 
 	if (type != RKISP_PARAMS_IMD) {
 		struct rkisp_isp_params_val_v3x *priv_val =
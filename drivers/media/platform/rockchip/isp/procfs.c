@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0
 /* Copyright (c) Rockchip Electronics Co., Ltd. */
 #include <linux/clk.h>
+#include <linux/math64.h>
 #include <linux/proc_fs.h>
 #include <linux/sem.h>
 #include <linux/seq_file.h>
@@ -717,6 +718,20 @@ static int isp_show(struct seq_file *p, void *v)
 			   (dev->isp_state & ISP_FRAME_END) ? "idle" : "working",
 			   sdev->dbg.interval / 1000 / 1000,
 			   sdev->dbg.delay / 1000);
+	if (IS_HDR_RDBK(dev->hdr.op_mode) && dev->hw_dev->dev_num > 1) {
+		struct rkisp_rdbk_wait *wait = &dev->rdbk_wait;
+		int i;
+
+		seq_printf(p, "%-10s prio:%u cnt:%llu avg:%lluus max:%lluus hist(ms):",
+			   "Isp Wait",
+			   dev->rdbk_prio,
+			   wait->cnt,
+			   wait->cnt ? div64_u64(wait->total_ns, wait->cnt * 1000) : 0,
+			   div_u64(wait->max_ns, 1000));
+		for (i = 0; i < RKISP_RDBK_WAIT_HIST; i++)
+			seq_printf(p, " %u", wait->hist[i]);
+		seq_puts(p, "\n");
+	}
 
 	if (dev->br_dev.en)
 		seq_printf(p, "%-10s rkispp%d Format:%s%s Size:%dx%d (frame:%d rate:%dms frameloss:%d)\n",
@@ -769,6 +784,19 @@ static int isp_show(struct seq_file *p, void *v)
 		break;
 	}
 
+	if (dev->isp_ver == ISP_V30 || dev->isp_ver == ISP_V32) {
+		struct rkisp_params_cfg_stats *stats = &dev->params_vdev.cfg_stats;
+
+		seq_printf(p, "%-10s %s Cnt:%u Bytes(last:%u max:%u avg:%llu) Skip:%llu\n",
+			   "Params",
+			   rkisp_params_lazy ? "LAZY" : "ALL",
+			   stats->frames,
+			   stats->last_bytes,
+			   stats->max_bytes,
+			   stats->frames ? div_u64(stats->total_bytes, stats->frames) : 0,
+			   stats->skipped);
+	}
+
 	seq_printf(p, "%-10s %s Cnt:%d\n",
 		   "Monitor",
 		   dev->hw_dev->monitor.is_en ? "ON" : "OFF",
@@ -682,14 +682,48 @@ void rkisp_trigger_read_back(struct rkisp_device *dev, u8 dma2frm, u32 mode, boo
 		rkisp_unite_write(dev, CSI2RX_CTRL0, val, true, hw->is_unite);
 }
 
+static void rkisp_rdbk_wait_update(struct rkisp_device *dev, u64 queue_ns)
+{
+	struct rkisp_rdbk_wait *wait = &dev->rdbk_wait;
+	u64 ns = ktime_get_ns() - queue_ns;
+	u32 ms = div_u64(ns, NSEC_PER_MSEC);
+	int i = min_t(int, fls(ms), RKISP_RDBK_WAIT_HIST - 1);
+
+	wait->cnt++;
+	wait->total_ns += ns;
+	if (ns > wait->max_ns)
+		wait->max_ns = ns;
+	wait->hist[i]++;
+}
+
+/*
+ * Pick the next isp to read back when several share the hardware:
+ * higher rdbk_prio first, then the request closest to its frame
+ * deadline so each camera is served in proportion to its frame rate,
+ * then the longest queue.
+ */
+static bool rkisp_rdbk_is_prior(struct rkisp_device *isp, int len,
+				struct rkisp_rdbk_trigger *t,
+				struct rkisp_device *best, int best_len,
+				struct rkisp_rdbk_trigger *best_t)
+{
+	if (!best)
+		return true;
+	if (isp->rdbk_prio != best->rdbk_prio)
+		return isp->rdbk_prio > best->rdbk_prio;
+	if (t->deadline_ns != best_t->deadline_ns)
+		return t->deadline_ns < best_t->deadline_ns;
+	return len > best_len;
+}
+
 static void rkisp_rdbk_trigger_handle(struct rkisp_device *dev, u32 cmd)
 {
 	struct rkisp_hw_dev *hw = dev->hw_dev;
-	struct rkisp_device *isp = NULL;
-	struct isp2x_csi_trigger t = { 0 };
+	struct rkisp_device *isp = NULL, *best = NULL;
+	struct rkisp_rdbk_trigger rt, best_rt = { 0 };
+	struct isp2x_csi_trigger *t = &best_rt.trigger;
 	unsigned long lock_flags = 0;
-	int i, times = -1, max = 0, id = 0;
-	int len[DEV_MAX] = { 0 };
+	int i, times = -1, len, max = 0, id = 0;
 	u32 mode = 0;
 
 	spin_lock_irqsave(&hw->rdbk_lock, lock_flags);
@@ -707,29 +741,36 @@ static void rkisp_rdbk_trigger_handle(struct rkisp_device *dev, u32 cmd)
 		if (!isp ||
 		    (isp && !(isp->isp_state & ISP_START)))
 			continue;
-		rkisp_rdbk_trigger_event(isp, T_CMD_LEN, &len[i]);
-		if (max < len[i]) {
-			max = len[i];
+		len = 0;
+		rkisp_rdbk_trigger_event(isp, T_CMD_LEN, &len);
+		if (!len || rkisp_rdbk_trigger_event(isp, T_CMD_PEEK, &rt))
+			continue;
+		if (rkisp_rdbk_is_prior(isp, len, &rt, best, max, &best_rt)) {
+			best = isp;
+			best_rt = rt;
+			max = len;
 			id = i;
 		}
 	}
 
-	if (max) {
+	if (best) {
 		v4l2_dbg(2, rkisp_debug, &dev->v4l2_dev,
-			 "trigger fifo len:%d\n", max);
-		isp = hw->isp[id];
-		rkisp_rdbk_trigger_event(isp, T_CMD_DEQUEUE, &t);
+			 "trigger isp%d fifo len:%d prio:%d\n",
+			 id, max, best->rdbk_prio);
+		isp = best;
+		rkisp_rdbk_trigger_event(isp, T_CMD_DEQUEUE, &best_rt);
+		rkisp_rdbk_wait_update(isp, best_rt.queue_ns);
 		isp->dmarx_dev.pre_frame = isp->dmarx_dev.cur_frame;
-		if (t.frame_id > isp->dmarx_dev.pre_frame.id &&
-		    t.frame_id - isp->dmarx_dev.pre_frame.id > 1)
+		if (t->frame_id > isp->dmarx_dev.pre_frame.id &&
+		    t->frame_id - isp->dmarx_dev.pre_frame.id > 1)
 			isp->isp_sdev.dbg.frameloss +=
-				t.frame_id - isp->dmarx_dev.pre_frame.id + 1;
-		isp->dmarx_dev.cur_frame.id = t.frame_id;
-		isp->dmarx_dev.cur_frame.sof_timestamp = t.sof_timestamp;
-		isp->dmarx_dev.cur_frame.timestamp = t.frame_timestamp;
-		isp->isp_sdev.frm_timestamp = t.sof_timestamp;
-		mode = t.mode;
-		times = t.times;
+				t->frame_id - isp->dmarx_dev.pre_frame.id + 1;
+		isp->dmarx_dev.cur_frame.id = t->frame_id;
+		isp->dmarx_dev.cur_frame.sof_timestamp = t->sof_timestamp;
+		isp->dmarx_dev.cur_frame.timestamp = t->frame_timestamp;
+		isp->isp_sdev.frm_timestamp = t->sof_timestamp;
+		mode = t->mode;
+		times = t->times;
 		hw->cur_dev_id = id;
 		hw->is_idle = false;
 	}
@@ -739,10 +780,25 @@ static void rkisp_rdbk_trigger_handle(struct rkisp_device *dev, u32 cmd)
 		rkisp_trigger_read_back(isp, times, mode, false);
 }
 
+static u64 rkisp_rdbk_interval_ns(struct rkisp_device *dev)
+{
+	struct rkisp_sensor_info *sensor = dev->active_sensor;
+	u32 num, den;
+
+	if (!sensor)
+		return NSEC_PER_SEC / 30;
+	num = sensor->fi.interval.numerator;
+	den = sensor->fi.interval.denominator;
+	if (!num || !den)
+		return NSEC_PER_SEC / 30;
+	return div_u64((u64)num * NSEC_PER_SEC, den);
+}
+
 int rkisp_rdbk_trigger_event(struct rkisp_device *dev, u32 cmd, void *arg)
 {
 	struct kfifo *fifo = &dev->rdbk_kfifo;
 	struct isp2x_csi_trigger *trigger = NULL;
+	struct rkisp_rdbk_trigger rt;
 	unsigned long lock_flags = 0;
 	int val, ret = 0;
 
@@ -755,19 +811,27 @@ int rkisp_rdbk_trigger_event(struct rkisp_device *dev, u32 cmd, void *arg)
 		trigger = arg;
 		if (!trigger)
 			break;
-		if (!kfifo_is_full(fifo))
-			kfifo_in(fifo, trigger, sizeof(*trigger));
-		else
+		if (kfifo_avail(fifo) >= sizeof(rt)) {
+			rt.trigger = *trigger;
+			rt.queue_ns = ktime_get_ns();
+			rt.deadline_ns = rt.queue_ns + rkisp_rdbk_interval_ns(dev);
+			kfifo_in(fifo, &rt, sizeof(rt));
+		} else {
 			v4l2_err(&dev->v4l2_dev, "rdbk fifo is full\n");
+		}
 		break;
 	case T_CMD_DEQUEUE:
 		if (!kfifo_is_empty(fifo))
-			ret = kfifo_out(fifo, arg, sizeof(struct isp2x_csi_trigger));
+			ret = kfifo_out(fifo, arg, sizeof(rt));
 		if (!ret)
 			ret = -EINVAL;
 		break;
+	case T_CMD_PEEK:
+		if (!kfifo_out_peek(fifo, arg, sizeof(rt)))
+			ret = -EINVAL;
+		break;
 	case T_CMD_LEN:
-		val = kfifo_len(fifo) / sizeof(struct isp2x_csi_trigger);
+		val = kfifo_len(fifo) / sizeof(rt);
 		*(u32 *)arg = val;
 		break;
 	default:
@@ -3230,7 +3294,8 @@ int rkisp_register_isp_subdev(struct rkisp_device *isp_dev,
 	spin_lock_init(&isp_dev->cmsk_lock);
 	spin_lock_init(&isp_dev->rdbk_lock);
 	ret = kfifo_alloc(&isp_dev->rdbk_kfifo,
-		16 * sizeof(struct isp2x_csi_trigger), GFP_KERNEL);
+		RKISP_RDBK_FIFO_NUM * sizeof(struct rkisp_rdbk_trigger),
+		GFP_KERNEL);
 	if (ret < 0) {
 		v4l2_err(v4l2_dev, "Failed to alloc csi kfifo %d", ret);
 		return ret;
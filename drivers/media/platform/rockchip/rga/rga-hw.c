@@ -379,6 +379,16 @@ static void rga_cmd_set(struct rga_ctx *ctx)
 {
 	struct rockchip_rga *rga = ctx->rga;
 
+	/*
+	 * The command buffer only depends on the context formats and
+	 * controls, buffers are reached through the fixed mmu tables, so
+	 * consecutive jobs of one context can reuse it.
+	 */
+	if (rga->cmd_ctx == ctx && !ctx->cmd_dirty) {
+		rga_write(rga, RGA_CMD_BASE, rga->cmdbuf_phy);
+		return;
+	}
+
 	memset(rga->cmdbuf_virt, 0, RGA_CMDBUF_SIZE * 4);
 
 	rga_cmd_set_src_addr(ctx, rga->src_mmu_pages);
@@ -398,6 +408,9 @@ static void rga_cmd_set(struct rga_ctx *ctx)
 	/* sync CMD buf for RGA */
 	dma_sync_single_for_device(rga->dev, rga->cmdbuf_phy,
 		PAGE_SIZE, DMA_BIDIRECTIONAL);
+
+	rga->cmd_ctx = ctx;
+	ctx->cmd_dirty = false;
 }
 
 void rga_hw_start(struct rockchip_rga *rga)
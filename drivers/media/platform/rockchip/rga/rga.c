@@ -31,6 +31,10 @@
 static int debug;
 module_param(debug, int, 0644);
 
+static unsigned int batch = 8;
+module_param(batch, uint, 0644);
+MODULE_PARM_DESC(batch, "max buffer pairs of one context run per m2m job");
+
 static void device_run(void *prv)
 {
 	struct rga_ctx *ctx = prv;
@@ -41,6 +45,8 @@ static void device_run(void *prv)
 	spin_lock_irqsave(&rga->ctrl_lock, flags);
 
 	rga->curr = ctx;
+	ctx->batch_left = batch ? batch - 1 : 0;
+	ctx->aborting = false;
 
 	src = v4l2_m2m_next_src_buf(ctx->fh.m2m_ctx);
 	dst = v4l2_m2m_next_dst_buf(ctx->fh.m2m_ctx);
@@ -53,6 +59,47 @@ static void device_run(void *prv)
 	spin_unlock_irqrestore(&rga->ctrl_lock, flags);
 }
 
+/*
+ * Start the next queued buffer pair of the same context straight from the
+ * interrupt, skipping the m2m job_finish/device_run round trip through the
+ * workqueue. The batch size bounds how long other contexts wait.
+ */
+static bool rga_run_next(struct rga_ctx *ctx)
+{
+	struct rockchip_rga *rga = ctx->rga;
+	struct vb2_v4l2_buffer *src, *dst;
+
+	if (!ctx->batch_left || ctx->aborting)
+		return false;
+
+	src = v4l2_m2m_next_src_buf(ctx->fh.m2m_ctx);
+	dst = v4l2_m2m_next_dst_buf(ctx->fh.m2m_ctx);
+	if (!src || !dst)
+		return false;
+
+	spin_lock(&rga->ctrl_lock);
+
+	ctx->batch_left--;
+	rga->curr = ctx;
+
+	rga_buf_map(&src->vb2_buf);
+	rga_buf_map(&dst->vb2_buf);
+
+	rga_hw_start(rga);
+
+	spin_unlock(&rga->ctrl_lock);
+
+	return true;
+}
+
+static void job_abort(void *prv)
+{
+	struct rga_ctx *ctx = prv;
+
+	/* Let the running buffer pair finish, but start no more */
+	ctx->aborting = true;
+}
+
 static irqreturn_t rga_isr(int irq, void *prv)
 {
 	struct rockchip_rga *rga = prv;
@@ -83,7 +130,8 @@ static irqreturn_t rga_isr(int irq, void *prv)
 
 		v4l2_m2m_buf_done(src, VB2_BUF_STATE_DONE);
 		v4l2_m2m_buf_done(dst, VB2_BUF_STATE_DONE);
-		v4l2_m2m_job_finish(rga->m2m_dev, ctx->fh.m2m_ctx);
+		if (!rga_run_next(ctx))
+			v4l2_m2m_job_finish(rga->m2m_dev, ctx->fh.m2m_ctx);
 	}
 
 	return IRQ_HANDLED;
@@ -91,6 +139,7 @@ static irqreturn_t rga_isr(int irq, void *prv)
 
 static const struct v4l2_m2m_ops rga_m2m_ops = {
 	.device_run = device_run,
+	.job_abort = job_abort,
 };
 
 static int
@@ -147,6 +196,7 @@ static int rga_s_ctrl(struct v4l2_ctrl *ctrl)
 		ctx->fill_color = ctrl->val;
 		break;
 	}
+	ctx->cmd_dirty = true;
 	spin_unlock_irqrestore(&ctx->rga->ctrl_lock, flags);
 	return 0;
 }
@@ -380,6 +430,7 @@ static int rga_open(struct file *file)
 	/* Set default formats */
 	ctx->in = def_frame;
 	ctx->out = def_frame;
+	ctx->cmd_dirty = true;
 
 	if (mutex_lock_interruptible(&rga->mutex)) {
 		kfree(ctx);
@@ -412,11 +463,17 @@ static int rga_release(struct file *file)
 	struct rga_ctx *ctx =
 		container_of(file->private_data, struct rga_ctx, fh);
 	struct rockchip_rga *rga = ctx->rga;
+	unsigned long flags;
 
 	mutex_lock(&rga->mutex);
 
 	v4l2_m2m_ctx_release(ctx->fh.m2m_ctx);
 
+	spin_lock_irqsave(&rga->ctrl_lock, flags);
+	if (rga->cmd_ctx == ctx)
+		rga->cmd_ctx = NULL;
+	spin_unlock_irqrestore(&rga->ctrl_lock, flags);
+
 	v4l2_ctrl_handler_free(&ctx->ctrl_handler);
 	v4l2_fh_del(&ctx->fh);
 	v4l2_fh_exit(&ctx->fh);
@@ -554,6 +611,7 @@ static int vidioc_s_fmt(struct file *file, void *prv, struct v4l2_format *f)
 	frm->crop.top = 0;
 	frm->crop.width = frm->width;
 	frm->crop.height = frm->height;
+	ctx->cmd_dirty = true;
 
 	return 0;
 }
@@ -612,6 +670,7 @@ static int vidioc_s_selection(struct file *file, void *prv,
 	struct rga_ctx *ctx = prv;
 	struct rockchip_rga *rga = ctx->rga;
 	struct rga_frame *f;
+	unsigned long flags;
 	int ret = 0;
 
 	f = rga_get_frame(ctx, s->type);
@@ -656,7 +715,10 @@ static int vidioc_s_selection(struct file *file, void *prv,
 		return -EINVAL;
 	}
 
+	spin_lock_irqsave(&rga->ctrl_lock, flags);
 	f->crop = s->r;
+	ctx->cmd_dirty = true;
+	spin_unlock_irqrestore(&rga->ctrl_lock, flags);
 
 	return ret;
 }
@@ -58,6 +58,12 @@ struct rga_ctx {
 	u32 vflip;
 	u32 rotate;
 	u32 fill_color;
+
+	/* Command buffer must be rebuilt before the next job */
+	bool cmd_dirty;
+	/* Buffer pairs the running job may still process */
+	u32 batch_left;
+	bool aborting;
 };
 
 struct rockchip_rga {
@@ -79,6 +85,8 @@ struct rockchip_rga {
 	spinlock_t ctrl_lock;
 
 	struct rga_ctx *curr;
+	/* Context the command buffer was last built for */
+	struct rga_ctx *cmd_ctx;
 	dma_addr_t cmdbuf_phy;
 	void *cmdbuf_virt;
 	unsigned int *src_mmu_pages;
@@ -62,6 +62,7 @@
 #include <net/rtnetlink.h>
 #include <net/sock.h>
 #include <net/xdp.h>
+#include <net/page_pool.h>
 #include <net/ip_tunnels.h>
 #include <linux/seq_file.h>
 #include <linux/uio.h>
@@ -85,6 +86,8 @@ static void tun_default_link_ksettings(struct net_device *dev,
 				       struct ethtool_link_ksettings *cmd);
 
 #define TUN_RX_PAD (NET_IP_ALIGN + NET_SKB_PAD)
+/* Pages kept for recycling per queue, see tun_build_skb() */
+#define TUN_PAGE_POOL_SIZE 256
 
 /* TUN device flags */
 
@@ -156,6 +159,12 @@ struct tun_file {
 	struct tun_struct *detached;
 	struct ptr_ring tx_ring;
 	struct xdp_rxq_info xdp_rxq;
+	/* Pages for packets built by tun_build_skb(), pp_lock serializes
+	 * allocations from concurrent writers of the queue.
+	 */
+	struct page_pool *page_pool;
+	struct xdp_rxq_info pp_rxq;
+	struct mutex pp_lock;
 };
 
 struct tun_page {
@@ -632,6 +641,50 @@ static void tun_queue_purge(struct tun_file *tfile)
 	skb_queue_purge(&tfile->sk.sk_error_queue);
 }
 
+static int tun_page_pool_init(struct tun_file *tfile, struct net_device *dev)
+{
+	struct page_pool_params pp_params = {
+		.order = 0,
+		.pool_size = TUN_PAGE_POOL_SIZE,
+		.nid = NUMA_NO_NODE,
+	};
+	int err;
+
+	tfile->page_pool = page_pool_create(&pp_params);
+	if (IS_ERR(tfile->page_pool)) {
+		err = PTR_ERR(tfile->page_pool);
+		tfile->page_pool = NULL;
+		return err;
+	}
+
+	err = xdp_rxq_info_reg(&tfile->pp_rxq, dev, tfile->queue_index);
+	if (err < 0)
+		goto err_pool;
+	err = xdp_rxq_info_reg_mem_model(&tfile->pp_rxq, MEM_TYPE_PAGE_POOL,
+					 tfile->page_pool);
+	if (err < 0)
+		goto err_rxq;
+
+	return 0;
+
+err_rxq:
+	xdp_rxq_info_unreg(&tfile->pp_rxq);
+err_pool:
+	page_pool_destroy(tfile->page_pool);
+	tfile->page_pool = NULL;
+	return err;
+}
+
+static void tun_page_pool_free(struct tun_file *tfile)
+{
+	if (!tfile->page_pool)
+		return;
+
+	xdp_rxq_info_unreg(&tfile->pp_rxq);
+	page_pool_destroy(tfile->page_pool);
+	tfile->page_pool = NULL;
+}
+
 static void __tun_detach(struct tun_file *tfile, bool clean)
 {
 	struct tun_file *ntfile;
@@ -680,8 +733,10 @@ static void __tun_detach(struct tun_file *tfile, bool clean)
 			    tun->dev->reg_state == NETREG_REGISTERED)
 				unregister_netdevice(tun->dev);
 		}
-		if (tun)
+		if (tun) {
 			xdp_rxq_info_unreg(&tfile->xdp_rxq);
+			tun_page_pool_free(tfile);
+		}
 		ptr_ring_cleanup(&tfile->tx_ring, tun_ptr_free);
 		sock_put(&tfile->sk);
 	}
@@ -730,12 +785,14 @@ static void tun_detach_all(struct net_device *dev)
 		/* Drop read queue */
 		tun_queue_purge(tfile);
 		xdp_rxq_info_unreg(&tfile->xdp_rxq);
+		tun_page_pool_free(tfile);
 		sock_put(&tfile->sk);
 	}
 	list_for_each_entry_safe(tfile, tmp, &tun->disabled, next) {
 		tun_enable_queue(tfile);
 		tun_queue_purge(tfile);
 		xdp_rxq_info_unreg(&tfile->xdp_rxq);
+		tun_page_pool_free(tfile);
 		sock_put(&tfile->sk);
 	}
 	BUG_ON(tun->numdisabled != 0);
@@ -796,6 +853,7 @@ static int tun_attach(struct tun_struct *tun, struct file *file,
 
 		if (tfile->xdp_rxq.queue_index    != tfile->queue_index)
 			tfile->xdp_rxq.queue_index = tfile->queue_index;
+		tfile->pp_rxq.queue_index = tfile->queue_index;
 	} else {
 		/* Setup XDP RX-queue info, for new tfile getting attached */
 		err = xdp_rxq_info_reg(&tfile->xdp_rxq,
@@ -808,6 +866,11 @@ static int tun_attach(struct tun_struct *tun, struct file *file,
 			xdp_rxq_info_unreg(&tfile->xdp_rxq);
 			goto out;
 		}
+		err = tun_page_pool_init(tfile, tun->dev);
+		if (err < 0) {
+			xdp_rxq_info_unreg(&tfile->xdp_rxq);
+			goto out;
+		}
 		err = 0;
 	}
 
@@ -1534,28 +1597,46 @@ static bool tun_can_build_skb(struct tun_struct *tun, struct tun_file *tfile,
 	if (zerocopy)
 		return false;
 
-	if (SKB_DATA_ALIGN(len + TUN_RX_PAD) +
+	/* The packet is built in a single page_pool page, leave room for
+	 * XDP headroom even if no program is attached yet. Small packets
+	 * take a whole page too: their truesize is a page, but each page
+	 * goes back to the pool as soon as its skb is freed, instead of
+	 * staying pinned until every packet sharing it is gone.
+	 */
+	if (SKB_DATA_ALIGN(len + TUN_RX_PAD + XDP_PACKET_HEADROOM) +
 	    SKB_DATA_ALIGN(sizeof(struct skb_shared_info)) > PAGE_SIZE)
 		return false;
 
 	return true;
 }
 
+static struct page *tun_pp_alloc_page(struct tun_file *tfile)
+{
+	struct page *page;
+
+	/* Writers run in process context, so the allocation may sleep */
+	mutex_lock(&tfile->pp_lock);
+	page = page_pool_alloc_pages(tfile->page_pool, GFP_KERNEL);
+	mutex_unlock(&tfile->pp_lock);
+
+	return page;
+}
+
 static struct sk_buff *__tun_build_skb(struct tun_file *tfile,
-				       struct page_frag *alloc_frag, char *buf,
-				       int buflen, int len, int pad)
+				       struct page *page, int len, int pad)
 {
-	struct sk_buff *skb = build_skb(buf, buflen);
+	struct sk_buff *skb = build_skb(page_address(page), PAGE_SIZE);
 
-	if (!skb)
+	if (!skb) {
+		page_pool_put_full_page(tfile->page_pool, page, false);
 		return ERR_PTR(-ENOMEM);
+	}
 
 	skb_reserve(skb, pad);
 	skb_put(skb, len);
 	skb_set_owner_w(skb, tfile->socket.sk);
-
-	get_page(alloc_frag->page);
-	alloc_frag->offset += buflen;
+	/* Freeing the skb returns the page to tfile->page_pool */
+	skb_mark_for_recycle(skb);
 
 	return skb;
 }
@@ -1598,9 +1679,8 @@ static struct sk_buff *tun_build_skb(struct tun_struct *tun,
 				     struct virtio_net_hdr *hdr,
 				     int len, int *skb_xdp)
 {
-	struct page_frag *alloc_frag = &current->task_frag;
 	struct bpf_prog *xdp_prog;
-	int buflen = SKB_DATA_ALIGN(sizeof(struct skb_shared_info));
+	struct page *page;
 	char *buf;
 	size_t copied;
 	int pad = TUN_RX_PAD;
@@ -1610,19 +1690,18 @@ static struct sk_buff *tun_build_skb(struct tun_struct *tun,
 	xdp_prog = rcu_dereference(tun->xdp_prog);
 	if (xdp_prog)
 		pad += XDP_PACKET_HEADROOM;
-	buflen += SKB_DATA_ALIGN(len + pad);
 	rcu_read_unlock();
 
-	alloc_frag->offset = ALIGN((u64)alloc_frag->offset, SMP_CACHE_BYTES);
-	if (unlikely(!skb_page_frag_refill(buflen, alloc_frag, GFP_KERNEL)))
+	page = tun_pp_alloc_page(tfile);
+	if (unlikely(!page))
 		return ERR_PTR(-ENOMEM);
 
-	buf = (char *)page_address(alloc_frag->page) + alloc_frag->offset;
-	copied = copy_page_from_iter(alloc_frag->page,
-				     alloc_frag->offset + pad,
-				     len, from);
-	if (copied != len)
+	buf = page_address(page);
+	copied = copy_page_from_iter(page, pad, len, from);
+	if (copied != len) {
+		page_pool_put_full_page(tfile->page_pool, page, false);
 		return ERR_PTR(-EFAULT);
+	}
 
 	/* There's a small window that XDP may be set after the check
 	 * of xdp_prog above, this should be rare and for simplicity
@@ -1630,8 +1709,7 @@ static struct sk_buff *tun_build_skb(struct tun_struct *tun,
 	 */
 	if (hdr->gso_type || !xdp_prog) {
 		*skb_xdp = 1;
-		return __tun_build_skb(tfile, alloc_frag, buf, buflen, len,
-				       pad);
+		return __tun_build_skb(tfile, page, len, pad);
 	}
 
 	*skb_xdp = 0;
@@ -1647,25 +1725,21 @@ static struct sk_buff *tun_build_skb(struct tun_struct *tun,
 		xdp.data = buf + pad;
 		xdp_set_data_meta_invalid(&xdp);
 		xdp.data_end = xdp.data + len;
-		xdp.rxq = &tfile->xdp_rxq;
-		xdp.frame_sz = buflen;
+		/* Frames redirected or sent back return to the page_pool */
+		xdp.rxq = &tfile->pp_rxq;
+		xdp.frame_sz = PAGE_SIZE;
 
 		act = bpf_prog_run_xdp(xdp_prog, &xdp);
-		if (act == XDP_REDIRECT || act == XDP_TX) {
-			get_page(alloc_frag->page);
-			alloc_frag->offset += buflen;
-		}
 		err = tun_xdp_act(tun, xdp_prog, &xdp, act);
-		if (err < 0) {
-			if (act == XDP_REDIRECT || act == XDP_TX)
-				put_page(alloc_frag->page);
-			goto out;
-		}
+		if (err < 0)
+			goto drop;
 
 		if (err == XDP_REDIRECT)
 			xdp_do_flush();
-		if (err != XDP_PASS)
+		if (err == XDP_REDIRECT || err == XDP_TX)
 			goto out;
+		if (err != XDP_PASS)
+			goto drop;
 
 		pad = xdp.data - xdp.data_hard_start;
 		len = xdp.data_end - xdp.data;
@@ -1673,8 +1747,10 @@ static struct sk_buff *tun_build_skb(struct tun_struct *tun,
 	rcu_read_unlock();
 	local_bh_enable();
 
-	return __tun_build_skb(tfile, alloc_frag, buf, buflen, len, pad);
+	return __tun_build_skb(tfile, page, len, pad);
 
+drop:
+	page_pool_put_full_page(tfile->page_pool, page, false);
 out:
 	rcu_read_unlock();
 	local_bh_enable();
@@ -2381,7 +2457,7 @@ static void tun_put_page(struct tun_page *tpage)
 static int tun_xdp_one(struct tun_struct *tun,
 		       struct tun_file *tfile,
 		       struct xdp_buff *xdp, int *flush,
-		       struct tun_page *tpage)
+		       struct tun_page *tpage, struct list_head *skbs)
 {
 	unsigned int datasize = xdp->data_end - xdp->data;
 	struct tun_xdp_hdr *hdr = xdp->data_hard_start;
@@ -2465,7 +2541,8 @@ static int tun_xdp_one(struct tun_struct *tun,
 	    !tfile->detached)
 		rxhash = __skb_get_hash_symmetric(skb);
 
-	netif_receive_skb(skb);
+	/* Delivered as a list by tun_sendmsg() once the batch is done */
+	list_add_tail(&skb->list, skbs);
 
 	/* No need for get_cpu_ptr() here since this function is
 	 * always called with bh disabled
@@ -2498,6 +2575,7 @@ static int tun_sendmsg(struct socket *sock, struct msghdr *m, size_t total_len)
 		struct tun_page tpage;
 		int n = ctl->num;
 		int flush = 0;
+		LIST_HEAD(skbs);
 
 		memset(&tpage, 0, sizeof(tpage));
 
@@ -2506,9 +2584,11 @@ static int tun_sendmsg(struct socket *sock, struct msghdr *m, size_t total_len)
 
 		for (i = 0; i < n; i++) {
 			xdp = &((struct xdp_buff *)ctl->ptr)[i];
-			tun_xdp_one(tun, tfile, xdp, &flush, &tpage);
+			tun_xdp_one(tun, tfile, xdp, &flush, &tpage, &skbs);
 		}
 
+		netif_receive_skb_list(&skbs);
+
 		if (flush)
 			xdp_do_flush();
 
@@ -3416,6 +3496,7 @@ static int tun_chr_open(struct inode *inode, struct file * file)
 	}
 
 	mutex_init(&tfile->napi_mutex);
+	mutex_init(&tfile->pp_lock);
 	RCU_INIT_POINTER(tfile->tun, NULL);
 	tfile->flags = 0;
 	tfile->ifindex = 0;
@@ -11,6 +11,7 @@
 #include <linux/device.h>
 #include <linux/kref.h>
 #include <linux/platform_device.h>
+#include <linux/psi_types.h>
 #include <linux/spinlock.h>
 #include <linux/regulator/consumer.h>
 #include <linux/version.h>
@@ -106,6 +107,7 @@ struct rknpu_device {
 	struct device *genpd_dev_npu1;
 	struct device *genpd_dev_npu2;
 	bool multiple_domains;
+	struct psi_accel psi;
 };
 
 #endif /* __LINUX_RKNPU_DRV_H_ */
@@ -18,6 +18,7 @@
 #include <linux/of_reserved_mem.h>
 #include <linux/platform_device.h>
 #include <linux/printk.h>
+#include <linux/psi.h>
 #include <linux/slab.h>
 #include <linux/spinlock.h>
 #include <linux/time.h>
@@ -993,10 +994,13 @@ static int rknpu_probe(struct platform_device *pdev)
 	if (!rknpu_dev->bypass_irq_handler)
 		rknpu_register_irq(pdev, rknpu_dev);
 
+	/* Jobs may be submitted as soon as the device node exists */
+	psi_accel_register(&rknpu_dev->psi, dev_name(dev));
+
 	ret = rknpu_drm_probe(rknpu_dev);
 	if (ret) {
 		LOG_DEV_ERROR(dev, "failed to probe device for rknpu\n");
-		return ret;
+		goto err_psi;
 	}
 
 	ret = rknpu_fence_context_alloc(rknpu_dev);
@@ -1036,6 +1040,8 @@ static int rknpu_probe(struct platform_device *pdev)
 
 err_remove_drm:
 	rknpu_drm_remove(rknpu_dev);
+err_psi:
+	psi_accel_unregister(&rknpu_dev->psi);
 
 	return ret;
 }
@@ -1052,6 +1058,8 @@ static int rknpu_remove(struct platform_device *pdev)
 
 	rknpu_drm_remove(rknpu_dev);
 
+	psi_accel_unregister(&rknpu_dev->psi);
+
 	rknpu_power_off(rknpu_dev);
 
 	if (rknpu_dev->multiple_domains) {
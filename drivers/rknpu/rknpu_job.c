@@ -8,6 +8,7 @@
 #include <linux/delay.h>
 #include <linux/sync_file.h>
 #include <linux/io.h>
+#include <linux/psi.h>
 
 #include "rknpu_ioctl.h"
 #include "rknpu_drv.h"
@@ -140,12 +141,15 @@ static inline int rknpu_job_wait(struct rknpu_job *job)
 	struct rknpu_subcore_data *subcore_data = NULL;
 	void __iomem *rknpu_core_base = NULL;
 	int core_index = rknpu_core_index(job->args->core_mask);
+	unsigned long pflags;
 	int ret = -EINVAL;
 
 	subcore_data = &rknpu_dev->subcore_datas[core_index];
+	psi_accelstall_enter(&rknpu_dev->psi, &pflags);
 	ret = wait_event_interruptible_timeout(subcore_data->job_done_wq,
 					       job->flags & RKNPU_JOB_DONE,
 					       msecs_to_jiffies(args->timeout));
+	psi_accelstall_leave(&rknpu_dev->psi, &pflags);
 
 	last_task = job->last_task;
 	if (!last_task)
@@ -3,7 +3,9 @@
  * Copyright (C) 2020 Rockchip Electronics Co., Ltd
  */
 #include <linux/clk.h>
+#include <linux/completion.h>
 #include <linux/delay.h>
+#include <linux/dma-mapping.h>
 #include <linux/initramfs.h>
 #include <linux/interrupt.h>
 #include <linux/kernel.h>
@@ -89,9 +91,14 @@ struct rk_decom {
 	phys_addr_t mem_start;
 	size_t mem_size;
 	struct reset_control *reset;
+	/* set while rk_decom_run() waits for the engine */
+	bool run_busy;
+	u32 run_status;
+	struct completion run_done;
 };
 
 static struct rk_decom *g_decom;
+static DEFINE_MUTEX(rk_decom_run_lock);
 
 static DECLARE_WAIT_QUEUE_HEAD(initrd_decom_done);
 static bool initrd_continue;
@@ -103,18 +110,12 @@ void __init wait_initrd_hw_decom_done(void)
 
 static DECLARE_WAIT_QUEUE_HEAD(decom_init_done);
 
-int rk_decom_start(u32 mode, phys_addr_t src, phys_addr_t dst, u32 dst_max_size)
+static int __rk_decom_start(u32 mode, phys_addr_t src, phys_addr_t dst,
+			    u32 dst_max_size)
 {
 	u32 irq_status;
 	u32 decom_enr;
 
-	pr_info("%s: mode %u src %pa dst %pa max_size %u\n",
-		__func__, mode, &src, &dst, dst_max_size);
-
-	wait_event_timeout(decom_init_done, g_decom, HZ);
-	if (!g_decom)
-		return -EINVAL;
-
 	decom_enr = readl(g_decom->regs + DECOM_ENR);
 	if (decom_enr & 0x1) {
 		pr_err("decompress busy\n");
@@ -161,12 +162,117 @@ int rk_decom_start(u32 mode, phys_addr_t src, phys_addr_t dst, u32 dst_max_size)
 	writel(DECOM_INT_MASK, g_decom->regs + DECOM_IEN);
 	writel(DECOM_ENABLE, g_decom->regs + DECOM_ENR);
 
+	return 0;
+}
+
+int rk_decom_start(u32 mode, phys_addr_t src, phys_addr_t dst, u32 dst_max_size)
+{
+	int ret;
+
+	pr_info("%s: mode %u src %pa dst %pa max_size %u\n",
+		__func__, mode, &src, &dst, dst_max_size);
+
+	wait_event_timeout(decom_init_done, g_decom, HZ);
+	if (!g_decom)
+		return -EINVAL;
+
+	mutex_lock(&rk_decom_run_lock);
+	ret = __rk_decom_start(mode, src, dst, dst_max_size);
+	mutex_unlock(&rk_decom_run_lock);
+	if (ret)
+		return ret;
+
 	pr_info("%s: started\n", __func__);
 
 	return 0;
 }
 EXPORT_SYMBOL(rk_decom_start);
 
+/*
+ * Decompress @src to @dst and wait for the engine to finish. Unlike
+ * rk_decom_start(), which is meant for a single decompression of the whole
+ * initrd at boot, this can be called any number of times, e.g. to decompress
+ * a ramdisk chunk by chunk. Both buffers must be in the linear map, they are
+ * mapped for the engine here. May sleep.
+ */
+int rk_decom_run(u32 mode, phys_addr_t src, u32 src_size, phys_addr_t dst,
+		 u32 dst_max_size, u64 *decom_len)
+{
+	struct rk_decom *rk_dec = g_decom;
+	dma_addr_t src_dma, dst_dma;
+	int ret;
+
+	/* The engine is probed at pure_initcall, long before any user */
+	if (!rk_dec)
+		return -ENODEV;
+
+	src_dma = dma_map_single(rk_dec->dev, phys_to_virt(src), src_size,
+				 DMA_TO_DEVICE);
+	if (dma_mapping_error(rk_dec->dev, src_dma))
+		return -ENOMEM;
+
+	dst_dma = dma_map_single(rk_dec->dev, phys_to_virt(dst), dst_max_size,
+				 DMA_FROM_DEVICE);
+	if (dma_mapping_error(rk_dec->dev, dst_dma)) {
+		ret = -ENOMEM;
+		goto unmap_src;
+	}
+
+	mutex_lock(&rk_decom_run_lock);
+
+	ret = clk_bulk_prepare_enable(rk_dec->num_clocks, rk_dec->clocks);
+	if (ret)
+		goto unlock;
+
+	/*
+	 * Leave the interrupt of a running initrd decompression to its own
+	 * path, it is started under rk_decom_run_lock as well.
+	 */
+	if (readl(rk_dec->regs + DECOM_ENR) & 0x1) {
+		ret = -EBUSY;
+		goto clk_off;
+	}
+
+	reinit_completion(&rk_dec->run_done);
+	WRITE_ONCE(rk_dec->run_busy, true);
+
+	ret = __rk_decom_start(mode, src_dma, dst_dma, dst_max_size);
+	if (ret)
+		goto idle;
+
+	if (!wait_for_completion_timeout(&rk_dec->run_done, HZ)) {
+		dev_err(rk_dec->dev, "decom timeout, src %pa dst %pa\n",
+			&src, &dst);
+		writel(DECOM_DISABLE, rk_dec->regs + DECOM_ENR);
+		ret = -ETIMEDOUT;
+		goto idle;
+	}
+
+	if (!(rk_dec->run_status & DECOM_COMPLETE)) {
+		dev_err(rk_dec->dev, "decom failed, decom_status = 0x%x\n",
+			rk_dec->run_status);
+		ret = -EIO;
+		goto idle;
+	}
+
+	if (decom_len)
+		*decom_len = readl(rk_dec->regs + DECOM_TSIZEL) |
+			     (u64)readl(rk_dec->regs + DECOM_TSIZEH) << 32;
+
+idle:
+	WRITE_ONCE(rk_dec->run_busy, false);
+clk_off:
+	clk_bulk_disable_unprepare(rk_dec->num_clocks, rk_dec->clocks);
+unlock:
+	mutex_unlock(&rk_decom_run_lock);
+	dma_unmap_single(rk_dec->dev, dst_dma, dst_max_size, DMA_FROM_DEVICE);
+unmap_src:
+	dma_unmap_single(rk_dec->dev, src_dma, src_size, DMA_TO_DEVICE);
+
+	return ret;
+}
+EXPORT_SYMBOL(rk_decom_run);
+
 static irqreturn_t rk_decom_irq_handler(int irq, void *priv)
 {
 	struct rk_decom *rk_dec = priv;
@@ -176,6 +282,16 @@ static irqreturn_t rk_decom_irq_handler(int irq, void *priv)
 	irq_status = readl(rk_dec->regs + DECOM_ISR);
 	/* clear interrupts */
 	writel(irq_status, rk_dec->regs + DECOM_ISR);
+
+	/* rk_decom_run() reports errors itself rather than retrying */
+	if (READ_ONCE(rk_dec->run_busy)) {
+		if (irq_status & DECOM_STOP) {
+			rk_dec->run_status = readl(rk_dec->regs + DECOM_STAT);
+			complete(&rk_dec->run_done);
+		}
+		return IRQ_HANDLED;
+	}
+
 	if (irq_status & DECOM_STOP) {
 		decom_status = readl(rk_dec->regs + DECOM_STAT);
 		if (decom_status & DECOM_COMPLETE) {
@@ -232,6 +348,7 @@ static int __init rockchip_decom_probe(struct platform_device *pdev)
 		return -ENOMEM;
 
 	rk_dec->dev = dev;
+	init_completion(&rk_dec->run_done);
 	rk_dec->irq = platform_get_irq(pdev, 0);
 	if (rk_dec->irq < 0) {
 		dev_err(dev, "failed to get rk_dec irq\n");
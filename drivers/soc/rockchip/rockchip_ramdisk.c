@@ -7,13 +7,58 @@
  */
 
 #include <linux/backing-dev.h>
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
+#include <linux/mm.h>
 #include <linux/module.h>
 #include <linux/of_address.h>
 #include <linux/platform_device.h>
+#include <linux/seq_file.h>
+#include <linux/soc/rockchip/rockchip_decompress.h>
+#include <linux/vmalloc.h>
+#include <linux/workqueue.h>
+#include <linux/zlib.h>
 
 #define PAGE_SECTORS_SHIFT	(PAGE_SHIFT - SECTOR_SHIFT)
 #define PAGE_SECTORS		(1 << PAGE_SECTORS_SHIFT)
 
+/*
+ * A compressed ramdisk image, found in "memory-region-src", starts with this
+ * header followed by one entry per chunk. Each chunk holds 1 << chunk_shift
+ * bytes of the disk (the last one may be shorter) compressed in zlib format,
+ * at the given offset from the start of the image. Chunks are decompressed
+ * straight into "memory-region" the first time they are accessed.
+ */
+#define RD_CHUNK_MAGIC		0x4b434452	/* "RDCK" */
+
+struct rd_chunk_entry {
+	__le32	offset;
+	__le32	size;
+};
+
+struct rd_chunk_header {
+	__le32	magic;
+	__le32	chunk_shift;
+	__le32	nr_chunks;
+	__le32	reserved;
+	__le64	disk_size;
+	struct rd_chunk_entry	chunks[];
+};
+
+enum rd_chunk_method {
+	RD_CHUNK_PENDING,
+	RD_CHUNK_HW,
+	RD_CHUNK_SW,
+	RD_CHUNK_FAILED,
+};
+
+struct rd_chunk_stat {
+	u32	comp_size;
+	u32	time_us;
+	u8	method;
+	bool	prefetched;
+};
+
 struct rd_device {
 	struct request_queue	*rd_queue;
 	struct gendisk		*rd_disk;
@@ -21,10 +66,182 @@ struct rd_device {
 	struct device		*dev;
 	phys_addr_t		mem_addr;
 	size_t			mem_size;
+
+	/* Lazy decompression, only set up with "memory-region-src" */
+	phys_addr_t		src_addr;
+	size_t			src_size;
+	const struct rd_chunk_header *hdr;
+	unsigned int		chunk_shift;
+	unsigned int		nr_chunks;
+	unsigned int		nr_ready;
+	unsigned long		*chunk_ready;
+	struct rd_chunk_stat	*stats;
+	struct mutex		decom_lock;
+	void			*zlib_workspace;
+	u32			*prefetch;
+	unsigned int		nr_prefetch;
+	struct work_struct	prefetch_work;
+	struct dentry		*debugfs;
 };
 
 static int rd_major;
 
+/* Decompress with zlib instead of the decompression engine, for testing */
+static bool sw_decompress;
+module_param(sw_decompress, bool, 0644);
+MODULE_PARM_DESC(sw_decompress, "Decompress ramdisk chunks in software");
+
+static size_t rd_chunk_len(struct rd_device *rd, unsigned int idx)
+{
+	u64 disk_size = get_capacity(rd->rd_disk) << SECTOR_SHIFT;
+	u64 start = (u64)idx << rd->chunk_shift;
+
+	return min_t(u64, disk_size - start, 1ULL << rd->chunk_shift);
+}
+
+static int rd_decompress_sw(struct rd_device *rd, void *src, size_t src_len,
+			    void *dst, size_t dst_len)
+{
+	z_stream strm = {
+		.workspace	= rd->zlib_workspace,
+		.next_in	= src,
+		.avail_in	= src_len,
+		.next_out	= dst,
+		.avail_out	= dst_len,
+	};
+	int ret;
+
+	if (!strm.workspace)
+		return -ENOMEM;
+
+	if (zlib_inflateInit(&strm) != Z_OK)
+		return -EINVAL;
+
+	ret = zlib_inflate(&strm, Z_FINISH);
+	zlib_inflateEnd(&strm);
+
+	if (ret != Z_STREAM_END || strm.total_out != dst_len)
+		return -EIO;
+
+	return 0;
+}
+
+static int rd_decompress_hw(struct rd_device *rd, phys_addr_t src,
+			    size_t src_len, phys_addr_t dst, size_t dst_len)
+{
+	u64 decom_len = 0;
+	int ret;
+
+	/*
+	 * Decompress in place in the disk memory, without any bounce buffer.
+	 * rk_decom_run() maps both buffers for the decompressor device.
+	 */
+	ret = rk_decom_run(ZLIB_MOD, src, src_len, dst, dst_len, &decom_len);
+	if (!ret && decom_len != dst_len)
+		ret = -EIO;
+
+	return ret;
+}
+
+static void rd_free_src(struct rd_device *rd)
+{
+	void *start = phys_to_virt(rd->src_addr);
+
+	/* Every chunk is in the disk memory now, the image is not needed */
+	rd->hdr = NULL;
+	free_reserved_area(start, start + rd->src_size, -1,
+			   "ramdisk compressed image");
+	dev_info(rd->dev, "all %u chunks decompressed\n", rd->nr_chunks);
+}
+
+static int rd_decompress_chunk(struct rd_device *rd, unsigned int idx,
+			       bool prefetch)
+{
+	struct rd_chunk_stat *stat = &rd->stats[idx];
+	const struct rd_chunk_entry *entry;
+	phys_addr_t src, dst;
+	size_t src_len, dst_len;
+	ktime_t start;
+	int ret = 0;
+
+	mutex_lock(&rd->decom_lock);
+
+	if (test_bit(idx, rd->chunk_ready))
+		goto out;
+
+	entry = &rd->hdr->chunks[idx];
+	src = rd->src_addr + le32_to_cpu(entry->offset);
+	src_len = le32_to_cpu(entry->size);
+	dst = rd->mem_addr + ((phys_addr_t)idx << rd->chunk_shift);
+	dst_len = rd_chunk_len(rd, idx);
+
+	start = ktime_get();
+
+	ret = -ENODEV;
+	if (!sw_decompress) {
+		ret = rd_decompress_hw(rd, src, src_len, dst, dst_len);
+		if (!ret)
+			stat->method = RD_CHUNK_HW;
+	}
+	if (ret) {
+		ret = rd_decompress_sw(rd, phys_to_virt(src), src_len,
+				       phys_to_virt(dst), dst_len);
+		if (!ret)
+			stat->method = RD_CHUNK_SW;
+	}
+
+	stat->time_us = ktime_us_delta(ktime_get(), start);
+	stat->prefetched = prefetch;
+
+	if (ret) {
+		stat->method = RD_CHUNK_FAILED;
+		dev_err_ratelimited(rd->dev, "failed to decompress chunk %u (%d)\n",
+				    idx, ret);
+		goto out;
+	}
+
+	/* Publish the chunk data before the ready bit */
+	smp_wmb();
+	set_bit(idx, rd->chunk_ready);
+
+	if (++rd->nr_ready == rd->nr_chunks)
+		rd_free_src(rd);
+out:
+	mutex_unlock(&rd->decom_lock);
+
+	return ret;
+}
+
+/*
+ * Make sure the chunks backing n bytes of the rd starting at sector have
+ * been decompressed. May sleep.
+ */
+static int rd_prepare(struct rd_device *rd, sector_t sector, size_t n)
+{
+	unsigned int idx, last;
+	int ret;
+
+	if (!rd->chunk_ready)
+		return 0;
+
+	idx = (sector << SECTOR_SHIFT) >> rd->chunk_shift;
+	last = (((sector << SECTOR_SHIFT) + n - 1) >> rd->chunk_shift);
+
+	for (; idx <= last; idx++) {
+		if (test_bit(idx, rd->chunk_ready))
+			continue;
+
+		ret = rd_decompress_chunk(rd, idx, false);
+		if (ret)
+			return ret;
+	}
+
+	/* Pairs with the barrier in rd_decompress_chunk() */
+	smp_rmb();
+
+	return 0;
+}
+
 /*
  * Look up and return a rd's page for a given sector.
  */
@@ -116,6 +333,12 @@ static int rd_do_bvec(struct rd_device *rd, struct page *page,
 		      sector_t sector)
 {
 	void *mem;
+	int err;
+
+	/* Writes to a chunk must not be overwritten by its decompression */
+	err = rd_prepare(rd, sector, len);
+	if (err)
+		return err;
 
 	mem = kmap_atomic(page);
 	if (!op_is_write(op)) {
@@ -206,7 +429,10 @@ static int rd_init(struct rd_device *rd, int major, int minor)
 	disk->private_data	= rd;
 	disk->flags		= GENHD_FL_EXT_DEVT;
 	sprintf(disk->disk_name, "rd%d", minor);
-	set_capacity(disk, rd->mem_size >> SECTOR_SHIFT);
+	if (rd->hdr)
+		set_capacity(disk, le64_to_cpu(rd->hdr->disk_size) >> SECTOR_SHIFT);
+	else
+		set_capacity(disk, rd->mem_size >> SECTOR_SHIFT);
 	rd->rd_disk = disk;
 
 	/* Tell the block layer that this is not a rotational device */
@@ -223,6 +449,145 @@ static int rd_init(struct rd_device *rd, int major, int minor)
 	return -ENOMEM;
 }
 
+static void rd_prefetch_work(struct work_struct *work)
+{
+	struct rd_device *rd = container_of(work, struct rd_device,
+					    prefetch_work);
+	ktime_t start = ktime_get();
+	unsigned int i;
+
+	for (i = 0; i < rd->nr_prefetch; i++) {
+		if (!test_bit(rd->prefetch[i], rd->chunk_ready))
+			rd_decompress_chunk(rd, rd->prefetch[i], true);
+	}
+
+	dev_info(rd->dev, "prefetched %u chunks in %lld us\n",
+		 rd->nr_prefetch, ktime_us_delta(ktime_get(), start));
+}
+
+static const char * const rd_chunk_method_name[] = {
+	[RD_CHUNK_PENDING]	= "-",
+	[RD_CHUNK_HW]		= "hw",
+	[RD_CHUNK_SW]		= "sw",
+	[RD_CHUNK_FAILED]	= "failed",
+};
+
+static int rd_chunks_show(struct seq_file *s, void *unused)
+{
+	struct rd_device *rd = s->private;
+	u64 total_us = 0;
+	unsigned int i;
+
+	mutex_lock(&rd->decom_lock);
+
+	for (i = 0; i < rd->nr_chunks; i++)
+		total_us += rd->stats[i].time_us;
+
+	seq_printf(s, "chunks: %u ready: %u chunk_size: %u total_us: %llu\n",
+		   rd->nr_chunks, rd->nr_ready, 1U << rd->chunk_shift,
+		   total_us);
+	seq_puts(s, "chunk comp_size method time_us prefetched\n");
+	for (i = 0; i < rd->nr_chunks; i++) {
+		struct rd_chunk_stat *stat = &rd->stats[i];
+
+		seq_printf(s, "%5u %9u %6s %7u %d\n", i, stat->comp_size,
+			   rd_chunk_method_name[stat->method], stat->time_us,
+			   stat->prefetched);
+	}
+
+	mutex_unlock(&rd->decom_lock);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(rd_chunks);
+
+static int rd_init_chunks(struct rd_device *rd, struct device_node *node)
+{
+	struct device *dev = rd->dev;
+	const struct rd_chunk_header *hdr;
+	struct resource reg;
+	unsigned int i;
+	u64 disk_size;
+	int ret, count;
+
+	ret = of_address_to_resource(node, 0, &reg);
+	if (ret) {
+		dev_err(dev, "missing \"reg\" property of source\n");
+		return -ENODEV;
+	}
+
+	rd->src_addr = reg.start;
+	rd->src_size = resource_size(&reg);
+	hdr = phys_to_virt(rd->src_addr);
+
+	if (rd->src_size < sizeof(*hdr) ||
+	    le32_to_cpu(hdr->magic) != RD_CHUNK_MAGIC) {
+		dev_err(dev, "bad compressed ramdisk header\n");
+		return -EINVAL;
+	}
+
+	rd->chunk_shift = le32_to_cpu(hdr->chunk_shift);
+	rd->nr_chunks = le32_to_cpu(hdr->nr_chunks);
+	disk_size = le64_to_cpu(hdr->disk_size);
+	if (rd->chunk_shift < PAGE_SHIFT || rd->chunk_shift > 30 ||
+	    !rd->nr_chunks || disk_size > rd->mem_size ||
+	    DIV_ROUND_UP_ULL(disk_size, 1ULL << rd->chunk_shift) != rd->nr_chunks ||
+	    struct_size(hdr, chunks, rd->nr_chunks) > rd->src_size) {
+		dev_err(dev, "invalid compressed ramdisk geometry\n");
+		return -EINVAL;
+	}
+
+	rd->stats = devm_kcalloc(dev, rd->nr_chunks, sizeof(*rd->stats),
+				 GFP_KERNEL);
+	rd->chunk_ready = devm_kcalloc(dev, BITS_TO_LONGS(rd->nr_chunks),
+				       sizeof(unsigned long), GFP_KERNEL);
+	if (!rd->stats || !rd->chunk_ready)
+		return -ENOMEM;
+
+	for (i = 0; i < rd->nr_chunks; i++) {
+		const struct rd_chunk_entry *entry = &hdr->chunks[i];
+
+		if ((u64)le32_to_cpu(entry->offset) + le32_to_cpu(entry->size) >
+		    rd->src_size) {
+			dev_err(dev, "chunk %u is out of the image\n", i);
+			return -EINVAL;
+		}
+		rd->stats[i].comp_size = le32_to_cpu(entry->size);
+	}
+
+	/* The software fallback is always available */
+	rd->zlib_workspace = vmalloc(zlib_inflate_workspacesize());
+	if (!rd->zlib_workspace)
+		return -ENOMEM;
+
+	mutex_init(&rd->decom_lock);
+	rd->hdr = hdr;
+
+	/* Chunks needed early in boot, decompressed before anyone asks */
+	count = of_property_count_u32_elems(dev->of_node,
+					    "rockchip,prefetch-chunks");
+	if (count > 0) {
+		rd->prefetch = devm_kcalloc(dev, count, sizeof(u32),
+					    GFP_KERNEL);
+		if (!rd->prefetch)
+			return -ENOMEM;
+
+		of_property_read_u32_array(dev->of_node,
+					   "rockchip,prefetch-chunks",
+					   rd->prefetch, count);
+		for (i = 0; i < count; i++) {
+			if (rd->prefetch[i] < rd->nr_chunks)
+				rd->prefetch[rd->nr_prefetch++] = rd->prefetch[i];
+		}
+	}
+	INIT_WORK(&rd->prefetch_work, rd_prefetch_work);
+
+	dev_info(dev, "%u chunks of %u bytes, %u to prefetch\n",
+		 rd->nr_chunks, 1U << rd->chunk_shift, rd->nr_prefetch);
+
+	return 0;
+}
+
 static int rd_probe(struct platform_device *pdev)
 {
 	struct rd_device *rd;
@@ -252,8 +617,30 @@ static int rd_probe(struct platform_device *pdev)
 	rd->mem_addr = reg.start;
 	rd->mem_size = resource_size(&reg);
 
+	node = of_parse_phandle(dev->of_node, "memory-region-src", 0);
+	if (node) {
+		ret = rd_init_chunks(rd, node);
+		of_node_put(node);
+		if (ret)
+			goto err_free;
+	}
+
 	ret = rd_init(rd, rd_major, 0);
+	if (ret)
+		goto err_free;
+
+	if (rd->hdr) {
+		rd->debugfs = debugfs_create_dir(rd->rd_disk->disk_name, NULL);
+		debugfs_create_file("chunks", 0444, rd->debugfs, rd,
+				    &rd_chunks_fops);
+		if (rd->nr_prefetch)
+			queue_work(system_unbound_wq, &rd->prefetch_work);
+	}
+
+	return 0;
 
+err_free:
+	vfree(rd->zlib_workspace);
 	return ret;
 }
 
@@ -23,6 +23,7 @@
 #include <linux/vmalloc.h>
 #include <linux/kthread.h>
 #include <linux/cgroup.h>
+#include <linux/cpuset.h>
 #include <linux/module.h>
 #include <linux/sort.h>
 #include <linux/sched/mm.h>
@@ -187,12 +188,14 @@ EXPORT_SYMBOL_GPL(vhost_work_init);
 
 /* Init poll structure */
 void vhost_poll_init(struct vhost_poll *poll, vhost_work_fn_t fn,
-		     __poll_t mask, struct vhost_dev *dev)
+		     __poll_t mask, struct vhost_dev *dev,
+		     struct vhost_virtqueue *vq)
 {
 	init_waitqueue_func_entry(&poll->wait, vhost_poll_wakeup);
 	init_poll_funcptr(&poll->table, vhost_poll_func);
 	poll->mask = mask;
 	poll->dev = dev;
+	poll->vq = vq;
 	poll->wqh = NULL;
 
 	vhost_work_init(&poll->work, fn);
@@ -231,17 +234,34 @@ void vhost_poll_stop(struct vhost_poll *poll)
 }
 EXPORT_SYMBOL_GPL(vhost_poll_stop);
 
-void vhost_work_flush(struct vhost_dev *dev, struct vhost_work *work)
+static void vhost_worker_queue(struct vhost_worker *worker,
+			       struct vhost_work *work)
+{
+	if (!test_and_set_bit(VHOST_WORK_QUEUED, &work->flags)) {
+		/* We can only add the work to the list after we're
+		 * sure it was not in the list.
+		 * test_and_set_bit() implies a memory barrier.
+		 */
+		llist_add(&work->node, &worker->work_list);
+		wake_up_process(worker->task);
+	}
+}
+
+static void vhost_worker_flush(struct vhost_worker *worker)
 {
 	struct vhost_flush_struct flush;
 
-	if (dev->worker) {
-		init_completion(&flush.wait_event);
-		vhost_work_init(&flush.work, vhost_flush_work);
+	init_completion(&flush.wait_event);
+	vhost_work_init(&flush.work, vhost_flush_work);
 
-		vhost_work_queue(dev, &flush.work);
-		wait_for_completion(&flush.wait_event);
-	}
+	vhost_worker_queue(worker, &flush.work);
+	wait_for_completion(&flush.wait_event);
+}
+
+void vhost_work_flush(struct vhost_dev *dev, struct vhost_work *work)
+{
+	if (dev->worker)
+		vhost_worker_flush(dev->worker);
 }
 EXPORT_SYMBOL_GPL(vhost_work_flush);
 
@@ -249,7 +269,19 @@ EXPORT_SYMBOL_GPL(vhost_work_flush);
  * locks that are also used by the callback. */
 void vhost_poll_flush(struct vhost_poll *poll)
 {
-	vhost_work_flush(poll->dev, &poll->work);
+	struct vhost_worker *worker;
+
+	if (!poll->vq) {
+		vhost_work_flush(poll->dev, &poll->work);
+		return;
+	}
+
+	/* Workers are only re-attached and freed under the device mutex,
+	 * which flushing callers hold or can't race with (release).
+	 */
+	worker = rcu_dereference_raw(poll->vq->worker);
+	if (worker)
+		vhost_worker_flush(worker);
 }
 EXPORT_SYMBOL_GPL(vhost_poll_flush);
 
@@ -258,27 +290,56 @@ void vhost_work_queue(struct vhost_dev *dev, struct vhost_work *work)
 	if (!dev->worker)
 		return;
 
-	if (!test_and_set_bit(VHOST_WORK_QUEUED, &work->flags)) {
-		/* We can only add the work to the list after we're
-		 * sure it was not in the list.
-		 * test_and_set_bit() implies a memory barrier.
-		 */
-		llist_add(&work->node, &dev->work_list);
-		wake_up_process(dev->worker);
-	}
+	vhost_worker_queue(dev->worker, work);
 }
 EXPORT_SYMBOL_GPL(vhost_work_queue);
 
+/* Queue work on the worker attached to @vq, returns false if there is none */
+bool vhost_vq_work_queue(struct vhost_virtqueue *vq, struct vhost_work *work)
+{
+	struct vhost_worker *worker;
+	bool queued = false;
+
+	rcu_read_lock();
+	worker = rcu_dereference(vq->worker);
+	if (worker) {
+		queued = true;
+		vhost_worker_queue(worker, work);
+	}
+	rcu_read_unlock();
+
+	return queued;
+}
+EXPORT_SYMBOL_GPL(vhost_vq_work_queue);
+
 /* A lockless hint for busy polling code to exit the loop */
 bool vhost_has_work(struct vhost_dev *dev)
 {
-	return !llist_empty(&dev->work_list);
+	return dev->worker && !llist_empty(&dev->worker->work_list);
 }
 EXPORT_SYMBOL_GPL(vhost_has_work);
 
+bool vhost_vq_has_work(struct vhost_virtqueue *vq)
+{
+	struct vhost_worker *worker;
+	bool has_work = false;
+
+	rcu_read_lock();
+	worker = rcu_dereference(vq->worker);
+	if (worker && !llist_empty(&worker->work_list))
+		has_work = true;
+	rcu_read_unlock();
+
+	return has_work;
+}
+EXPORT_SYMBOL_GPL(vhost_vq_has_work);
+
 void vhost_poll_queue(struct vhost_poll *poll)
 {
-	vhost_work_queue(poll->dev, &poll->work);
+	if (poll->vq)
+		vhost_vq_work_queue(poll->vq, &poll->work);
+	else
+		vhost_work_queue(poll->dev, &poll->work);
 }
 EXPORT_SYMBOL_GPL(vhost_poll_queue);
 
@@ -343,7 +404,8 @@ static void vhost_vq_reset(struct vhost_dev *dev,
 
 static int vhost_worker(void *data)
 {
-	struct vhost_dev *dev = data;
+	struct vhost_worker *worker = data;
+	struct vhost_dev *dev = worker->dev;
 	struct vhost_work *work, *work_next;
 	struct llist_node *node;
 
@@ -358,7 +420,7 @@ static int vhost_worker(void *data)
 			break;
 		}
 
-		node = llist_del_all(&dev->work_list);
+		node = llist_del_all(&worker->work_list);
 		if (!node)
 			schedule();
 
@@ -482,12 +544,12 @@ void vhost_dev_init(struct vhost_dev *dev,
 	dev->iotlb = NULL;
 	dev->mm = NULL;
 	dev->worker = NULL;
+	memset(dev->workers, 0, sizeof(dev->workers));
 	dev->iov_limit = iov_limit;
 	dev->weight = weight;
 	dev->byte_weight = byte_weight;
 	dev->use_worker = use_worker;
 	dev->msg_handler = msg_handler;
-	init_llist_head(&dev->work_list);
 	init_waitqueue_head(&dev->wait);
 	INIT_LIST_HEAD(&dev->read_list);
 	INIT_LIST_HEAD(&dev->pending_list);
@@ -501,10 +563,11 @@ void vhost_dev_init(struct vhost_dev *dev,
 		vq->heads = NULL;
 		vq->dev = dev;
 		mutex_init(&vq->mutex);
+		RCU_INIT_POINTER(vq->worker, NULL);
 		vhost_vq_reset(dev, vq);
 		if (vq->handle_kick)
 			vhost_poll_init(&vq->poll, vq->handle_kick,
-					EPOLLIN, dev);
+					EPOLLIN, dev, vq);
 	}
 }
 EXPORT_SYMBOL_GPL(vhost_dev_init);
@@ -531,17 +594,84 @@ static void vhost_attach_cgroups_work(struct vhost_work *work)
 	s->ret = cgroup_attach_task_all(s->owner, current);
 }
 
-static int vhost_attach_cgroups(struct vhost_dev *dev)
+static int vhost_attach_cgroups(struct vhost_worker *worker)
 {
 	struct vhost_attach_cgroups_struct attach;
 
 	attach.owner = current;
 	vhost_work_init(&attach.work, vhost_attach_cgroups_work);
-	vhost_work_queue(dev, &attach.work);
-	vhost_work_flush(dev, &attach.work);
+	vhost_worker_queue(worker, &attach.work);
+	vhost_worker_flush(worker);
 	return attach.ret;
 }
 
+static void vhost_worker_free(struct vhost_dev *dev,
+			      struct vhost_worker *worker)
+{
+	dev->workers[worker->id] = NULL;
+	WARN_ON(!llist_empty(&worker->work_list));
+	kthread_stop(worker->task);
+	kfree(worker);
+}
+
+static void vhost_workers_free(struct vhost_dev *dev)
+{
+	int i;
+
+	for (i = 0; i < dev->nvqs; i++)
+		RCU_INIT_POINTER(dev->vqs[i]->worker, NULL);
+	/* Free the default worker and any worker userspace did not free */
+	for (i = 0; i < VHOST_MAX_WORKERS; i++)
+		if (dev->workers[i])
+			vhost_worker_free(dev, dev->workers[i]);
+	dev->worker = NULL;
+}
+
+static struct vhost_worker *vhost_worker_create(struct vhost_dev *dev)
+{
+	struct vhost_worker *worker;
+	struct task_struct *task;
+	int id, err;
+
+	for (id = 0; id < VHOST_MAX_WORKERS; id++)
+		if (!dev->workers[id])
+			break;
+	if (id == VHOST_MAX_WORKERS)
+		return ERR_PTR(-ENOSPC);
+
+	worker = kzalloc(sizeof(*worker), GFP_KERNEL_ACCOUNT);
+	if (!worker)
+		return ERR_PTR(-ENOMEM);
+
+	init_llist_head(&worker->work_list);
+	worker->dev = dev;
+	worker->id = id;
+
+	/* The default worker keeps the name tools already look for */
+	if (id)
+		task = kthread_create(vhost_worker, worker, "vhost-%d-%d",
+				      current->pid, id);
+	else
+		task = kthread_create(vhost_worker, worker, "vhost-%d",
+				      current->pid);
+	if (IS_ERR(task)) {
+		kfree(worker);
+		return ERR_CAST(task);
+	}
+
+	worker->task = task;
+	wake_up_process(task); /* avoid contributing to loadavg */
+	dev->workers[id] = worker;
+
+	err = vhost_attach_cgroups(worker);
+	if (err) {
+		vhost_worker_free(dev, worker);
+		return ERR_PTR(err);
+	}
+
+	return worker;
+}
+
 /* Caller should have device mutex */
 bool vhost_dev_has_owner(struct vhost_dev *dev)
 {
@@ -582,8 +712,8 @@ static void vhost_detach_mm(struct vhost_dev *dev)
 /* Caller should have device mutex */
 long vhost_dev_set_owner(struct vhost_dev *dev)
 {
-	struct task_struct *worker;
-	int err;
+	struct vhost_worker *worker;
+	int err, i;
 
 	/* Is there an owner already? */
 	if (vhost_dev_has_owner(dev)) {
@@ -595,31 +725,25 @@ long vhost_dev_set_owner(struct vhost_dev *dev)
 
 	dev->kcov_handle = kcov_common_handle();
 	if (dev->use_worker) {
-		worker = kthread_create(vhost_worker, dev,
-					"vhost-%d", current->pid);
+		worker = vhost_worker_create(dev);
 		if (IS_ERR(worker)) {
 			err = PTR_ERR(worker);
 			goto err_worker;
 		}
 
 		dev->worker = worker;
-		wake_up_process(worker); /* avoid contributing to loadavg */
-
-		err = vhost_attach_cgroups(dev);
-		if (err)
-			goto err_cgroup;
+		for (i = 0; i < dev->nvqs; i++)
+			rcu_assign_pointer(dev->vqs[i]->worker, worker);
+		worker->attachment_cnt = dev->nvqs;
 	}
 
 	err = vhost_dev_alloc_iovecs(dev);
 	if (err)
-		goto err_cgroup;
+		goto err_iovecs;
 
 	return 0;
-err_cgroup:
-	if (dev->worker) {
-		kthread_stop(dev->worker);
-		dev->worker = NULL;
-	}
+err_iovecs:
+	vhost_workers_free(dev);
 err_worker:
 	vhost_detach_mm(dev);
 	dev->kcov_handle = 0;
@@ -712,10 +836,8 @@ void vhost_dev_cleanup(struct vhost_dev *dev)
 	dev->iotlb = NULL;
 	vhost_clear_msg(dev);
 	wake_up_interruptible_poll(&dev->wait, EPOLLIN | EPOLLRDNORM);
-	WARN_ON(!llist_empty(&dev->work_list));
 	if (dev->worker) {
-		kthread_stop(dev->worker);
-		dev->worker = NULL;
+		vhost_workers_free(dev);
 		dev->kcov_handle = 0;
 	}
 	vhost_detach_mm(dev);
@@ -1744,6 +1866,166 @@ int vhost_init_device_iotlb(struct vhost_dev *d, bool enabled)
 }
 EXPORT_SYMBOL_GPL(vhost_init_device_iotlb);
 
+static struct vhost_worker *vhost_worker_find(struct vhost_dev *dev, u32 id)
+{
+	if (id >= VHOST_MAX_WORKERS)
+		return NULL;
+	return dev->workers[array_index_nospec(id, VHOST_MAX_WORKERS)];
+}
+
+static int vhost_vq_attach_worker(struct vhost_dev *dev,
+				  struct vhost_vring_worker *info)
+{
+	struct vhost_worker *worker, *old_worker;
+	struct vhost_virtqueue *vq;
+	u32 idx = info->index;
+
+	if (idx >= dev->nvqs)
+		return -ENOBUFS;
+	idx = array_index_nospec(idx, dev->nvqs);
+	vq = dev->vqs[idx];
+
+	worker = vhost_worker_find(dev, info->worker_id);
+	if (!worker)
+		return -ENODEV;
+
+	mutex_lock(&vq->mutex);
+	old_worker = rcu_dereference_protected(vq->worker,
+					       lockdep_is_held(&vq->mutex));
+	if (old_worker == worker) {
+		mutex_unlock(&vq->mutex);
+		return 0;
+	}
+	rcu_assign_pointer(vq->worker, worker);
+	worker->attachment_cnt++;
+	mutex_unlock(&vq->mutex);
+
+	if (!old_worker)
+		return 0;
+
+	old_worker->attachment_cnt--;
+	/* Wait for queuers that still see the old worker, then run anything
+	 * they queued there before the vq handler moves to the new worker.
+	 */
+	synchronize_rcu();
+	vhost_worker_flush(old_worker);
+	return 0;
+}
+
+static int vhost_worker_set_affinity(struct vhost_dev *dev,
+				     struct vhost_worker_affinity *info)
+{
+	struct vhost_worker *worker;
+	cpumask_var_t mask, allowed;
+	int r;
+
+	worker = vhost_worker_find(dev, info->worker_id);
+	if (!worker)
+		return -ENODEV;
+
+	if (!alloc_cpumask_var(&mask, GFP_KERNEL))
+		return -ENOMEM;
+	if (!alloc_cpumask_var(&allowed, GFP_KERNEL)) {
+		free_cpumask_var(mask);
+		return -ENOMEM;
+	}
+
+	cpumask_clear(mask);
+	if (copy_from_user(mask, u64_to_user_ptr(info->user_mask_ptr),
+			   min_t(unsigned int, info->mask_size,
+				 cpumask_size()))) {
+		r = -EFAULT;
+		goto out;
+	}
+
+	/* Stay inside the owner's cpuset, the worker is in its cgroups */
+	cpuset_cpus_allowed(current, allowed);
+	cpumask_and(mask, mask, allowed);
+	cpumask_and(mask, mask, cpu_online_mask);
+	if (cpumask_empty(mask)) {
+		r = -EINVAL;
+		goto out;
+	}
+
+	r = set_cpus_allowed_ptr(worker->task, mask);
+out:
+	free_cpumask_var(allowed);
+	free_cpumask_var(mask);
+	return r;
+}
+
+/* Caller must have device mutex */
+static long vhost_worker_ioctl(struct vhost_dev *dev, unsigned int ioctl,
+			       void __user *argp)
+{
+	struct vhost_worker_affinity affinity;
+	struct vhost_vring_worker ring_worker;
+	struct vhost_worker_state state;
+	struct vhost_worker *worker;
+	struct vhost_virtqueue *vq;
+	long r;
+
+	if (!dev->use_worker)
+		return -EINVAL;
+
+	switch (ioctl) {
+	case VHOST_NEW_WORKER:
+		worker = vhost_worker_create(dev);
+		if (IS_ERR(worker))
+			return PTR_ERR(worker);
+
+		state.worker_id = worker->id;
+		if (copy_to_user(argp, &state, sizeof(state))) {
+			vhost_worker_free(dev, worker);
+			return -EFAULT;
+		}
+		return 0;
+	case VHOST_FREE_WORKER:
+		if (copy_from_user(&state, argp, sizeof(state)))
+			return -EFAULT;
+
+		worker = vhost_worker_find(dev, state.worker_id);
+		if (!worker)
+			return -ENODEV;
+		/* The default worker lives until the owner is reset */
+		if (worker == dev->worker || worker->attachment_cnt)
+			return -EBUSY;
+
+		vhost_worker_free(dev, worker);
+		return 0;
+	case VHOST_ATTACH_VRING_WORKER:
+		if (copy_from_user(&ring_worker, argp, sizeof(ring_worker)))
+			return -EFAULT;
+		return vhost_vq_attach_worker(dev, &ring_worker);
+	case VHOST_GET_VRING_WORKER:
+		if (copy_from_user(&ring_worker, argp, sizeof(ring_worker)))
+			return -EFAULT;
+		if (ring_worker.index >= dev->nvqs)
+			return -ENOBUFS;
+		vq = dev->vqs[array_index_nospec(ring_worker.index, dev->nvqs)];
+
+		mutex_lock(&vq->mutex);
+		worker = rcu_dereference_protected(vq->worker,
+						   lockdep_is_held(&vq->mutex));
+		r = worker ? 0 : -ENODEV;
+		if (worker)
+			ring_worker.worker_id = worker->id;
+		mutex_unlock(&vq->mutex);
+		if (r)
+			return r;
+
+		if (copy_to_user(argp, &ring_worker, sizeof(ring_worker)))
+			return -EFAULT;
+		return 0;
+	case VHOST_SET_WORKER_AFFINITY:
+		if (copy_from_user(&affinity, argp, sizeof(affinity)))
+			return -EFAULT;
+		return vhost_worker_set_affinity(dev, &affinity);
+	default:
+		return -ENOIOCTLCMD;
+	}
+}
+
 /* Caller must have device mutex */
 long vhost_dev_ioctl(struct vhost_dev *d, unsigned int ioctl, void __user *argp)
 {
@@ -1807,6 +2089,13 @@ long vhost_dev_ioctl(struct vhost_dev *d, unsigned int ioctl, void __user *argp)
 		if (ctx)
 			eventfd_ctx_put(ctx);
 		break;
+	case VHOST_NEW_WORKER:
+	case VHOST_FREE_WORKER:
+	case VHOST_ATTACH_VRING_WORKER:
+	case VHOST_GET_VRING_WORKER:
+	case VHOST_SET_WORKER_AFFINITY:
+		r = vhost_worker_ioctl(d, ioctl, argp);
+		break;
 	default:
 		r = -ENOIOCTLCMD;
 		break;
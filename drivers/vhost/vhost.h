@@ -25,6 +25,17 @@ struct vhost_work {
 	unsigned long		  flags;
 };
 
+#define VHOST_MAX_WORKERS 16
+
+struct vhost_worker {
+	struct task_struct	  *task;
+	struct llist_head	  work_list;
+	struct vhost_dev	  *dev;
+	u32			  id;
+	/* Virtqueues using this worker, protected by the device mutex */
+	int			  attachment_cnt;
+};
+
 /* Poll a file (eventfd or socket) */
 /* Note: there's nothing vhost specific about this structure. */
 struct vhost_poll {
@@ -34,14 +45,18 @@ struct vhost_poll {
 	struct vhost_work	  work;
 	__poll_t		  mask;
 	struct vhost_dev	 *dev;
+	struct vhost_virtqueue	 *vq;
 };
 
 void vhost_work_init(struct vhost_work *work, vhost_work_fn_t fn);
 void vhost_work_queue(struct vhost_dev *dev, struct vhost_work *work);
 bool vhost_has_work(struct vhost_dev *dev);
+bool vhost_vq_work_queue(struct vhost_virtqueue *vq, struct vhost_work *work);
+bool vhost_vq_has_work(struct vhost_virtqueue *vq);
 
 void vhost_poll_init(struct vhost_poll *poll, vhost_work_fn_t fn,
-		     __poll_t mask, struct vhost_dev *dev);
+		     __poll_t mask, struct vhost_dev *dev,
+		     struct vhost_virtqueue *vq);
 int vhost_poll_start(struct vhost_poll *poll, struct file *file);
 void vhost_poll_stop(struct vhost_poll *poll);
 void vhost_poll_flush(struct vhost_poll *poll);
@@ -83,6 +98,8 @@ struct vhost_virtqueue {
 	struct eventfd_ctx *log_ctx;
 
 	struct vhost_poll poll;
+	/* Worker running the poll work, see VHOST_ATTACH_VRING_WORKER */
+	struct vhost_worker __rcu *worker;
 
 	/* The routine to call when the Guest pings us, or timeout. */
 	vhost_work_fn_t handle_kick;
@@ -149,8 +166,9 @@ struct vhost_dev {
 	struct vhost_virtqueue **vqs;
 	int nvqs;
 	struct eventfd_ctx *log_ctx;
-	struct llist_head work_list;
-	struct task_struct *worker;
+	/* Default worker, also used for work not tied to a virtqueue */
+	struct vhost_worker *worker;
+	struct vhost_worker *workers[VHOST_MAX_WORKERS];
 	struct vhost_iotlb *umem;
 	struct vhost_iotlb *iotlb;
 	spinlock_t iotlb_lock;
@@ -28,6 +28,10 @@
  * small pkts.
  */
 #define VHOST_VSOCK_PKT_WEIGHT 256
+/* Max number of used buffers collected before writing them to the used
+ * ring in one go.
+ */
+#define VHOST_VSOCK_USED_BATCH 64
 
 enum {
 	VHOST_VSOCK_FEATURES = VHOST_FEATURES,
@@ -80,12 +84,32 @@ static struct vhost_vsock *vhost_vsock_get(u32 guest_cid)
 	return NULL;
 }
 
+/* Collect a used buffer in vq->heads, caller must hold vq->mutex */
+static void vhost_vsock_add_used(struct vhost_virtqueue *vq, int *nheads,
+				 unsigned int head, int len)
+{
+	vq->heads[*nheads].id = cpu_to_vhost32(vq, head);
+	vq->heads[*nheads].len = cpu_to_vhost32(vq, len);
+	if (++*nheads == VHOST_VSOCK_USED_BATCH) {
+		vhost_add_used_n(vq, vq->heads, *nheads);
+		*nheads = 0;
+	}
+}
+
+static void vhost_vsock_flush_used(struct vhost_virtqueue *vq, int *nheads)
+{
+	if (*nheads) {
+		vhost_add_used_n(vq, vq->heads, *nheads);
+		*nheads = 0;
+	}
+}
+
 static void
 vhost_transport_do_send_pkt(struct vhost_vsock *vsock,
 			    struct vhost_virtqueue *vq)
 {
 	struct vhost_virtqueue *tx_vq = &vsock->vqs[VSOCK_VQ_TX];
-	int pkts = 0, total_len = 0;
+	int pkts = 0, total_len = 0, nheads = 0;
 	bool added = false;
 	bool restart_tx = false;
 
@@ -186,7 +210,8 @@ vhost_transport_do_send_pkt(struct vhost_vsock *vsock,
 		 */
 		virtio_transport_deliver_tap_pkt(pkt);
 
-		vhost_add_used(vq, head, sizeof(pkt->hdr) + payload_len);
+		vhost_vsock_add_used(vq, &nheads, head,
+				     sizeof(pkt->hdr) + payload_len);
 		added = true;
 
 		pkt->off += payload_len;
@@ -221,6 +246,7 @@ vhost_transport_do_send_pkt(struct vhost_vsock *vsock,
 			virtio_transport_free_pkt(pkt);
 		}
 	} while(likely(!vhost_exceeds_weight(vq, ++pkts, total_len)));
+	vhost_vsock_flush_used(vq, &nheads);
 	if (added)
 		vhost_signal(&vsock->dev, vq);
 
@@ -440,7 +466,7 @@ static void vhost_vsock_handle_tx_kick(struct vhost_work *work)
 	struct vhost_vsock *vsock = container_of(vq->dev, struct vhost_vsock,
 						 dev);
 	struct virtio_vsock_pkt *pkt;
-	int head, pkts = 0, total_len = 0;
+	int head, pkts = 0, total_len = 0, nheads = 0;
 	unsigned int out, in;
 	bool added = false;
 
@@ -494,12 +520,13 @@ static void vhost_vsock_handle_tx_kick(struct vhost_work *work)
 			virtio_transport_free_pkt(pkt);
 
 		len += sizeof(pkt->hdr);
-		vhost_add_used(vq, head, len);
+		vhost_vsock_add_used(vq, &nheads, head, len);
 		total_len += len;
 		added = true;
 	} while(likely(!vhost_exceeds_weight(vq, ++pkts, total_len)));
 
 no_more_replies:
+	vhost_vsock_flush_used(vq, &nheads);
 	if (added)
 		vhost_signal(&vsock->dev, vq);
 
@@ -20,6 +20,7 @@
 #include <linux/of_platform.h>
 #include <linux/of_irq.h>
 #include <linux/proc_fs.h>
+#include <linux/psi.h>
 #include <linux/pm_runtime.h>
 #include <linux/poll.h>
 #include <linux/regmap.h>
@@ -818,6 +819,7 @@ static int mpp_wait_result_default(struct mpp_session *session,
 				   struct mpp_task_msgs *msgs)
 {
 	int ret;
+	unsigned long pflags;
 	struct mpp_task *task;
 	struct mpp_dev *mpp;
 
@@ -828,9 +830,11 @@ static int mpp_wait_result_default(struct mpp_session *session,
 	}
 	mpp = mpp_get_task_used_device(task, session);
 
+	psi_accelstall_enter(&mpp->psi, &pflags);
 	ret = wait_event_timeout(task->wait,
 				 test_bit(TASK_STATE_DONE, &task->state),
 				 msecs_to_jiffies(MPP_WAIT_TIMEOUT_DELAY));
+	psi_accelstall_leave(&mpp->psi, &pflags);
 	if (ret > 0) {
 		if (mpp->dev_ops->result)
 			ret = mpp->dev_ops->result(mpp, task, msgs);
@@ -2006,10 +2010,14 @@ int mpp_dev_probe(struct mpp_dev *mpp,
 	mpp->hw_ops = mpp->var->hw_ops;
 	mpp->dev_ops = mpp->var->dev_ops;
 
+	/* Sessions may wait for the device as soon as it joins the service */
+	psi_accel_register(&mpp->psi, dev_name(dev));
+
 	/* Get and attach to service */
 	ret = mpp_attach_service(mpp, dev);
 	if (ret) {
 		dev_err(dev, "failed to attach service\n");
+		psi_accel_unregister(&mpp->psi);
 		return -ENODEV;
 	}
 
@@ -2099,6 +2107,7 @@ int mpp_dev_probe(struct mpp_dev *mpp,
 	mpp_detach_workqueue(mpp);
 	device_init_wakeup(dev, false);
 	pm_runtime_disable(dev);
+	psi_accel_unregister(&mpp->psi);
 
 	return ret;
 }
@@ -2112,6 +2121,7 @@ int mpp_dev_remove(struct mpp_dev *mpp)
 	mpp_detach_workqueue(mpp);
 	device_init_wakeup(mpp->dev, false);
 	pm_runtime_disable(mpp->dev);
+	psi_accel_unregister(&mpp->psi);
 
 	return 0;
 }
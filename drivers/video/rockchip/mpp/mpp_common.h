@@ -23,6 +23,7 @@
 #include <linux/irqreturn.h>
 #include <linux/poll.h>
 #include <linux/platform_device.h>
+#include <linux/psi_types.h>
 #include <soc/rockchip/pm_domains.h>
 
 #define MHZ			(1000 * 1000)
@@ -355,6 +356,9 @@ struct mpp_dev {
 	/* multi-core data */
 	struct list_head queue_link;
 	s32 core_id;
+
+	/* stall time of the tasks waiting for this device */
+	struct psi_accel psi;
 };
 
 struct mpp_session {
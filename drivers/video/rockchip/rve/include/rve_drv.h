@@ -30,6 +30,7 @@
 #include <linux/of_device.h>
 #include <linux/platform_device.h>
 #include <linux/poll.h>
+#include <linux/psi.h>
 #include <linux/regulator/consumer.h>
 #include <linux/scatterlist.h>
 #include <linux/sched.h>
@@ -176,6 +177,8 @@ struct rve_scheduler_t {
 
 	struct rve_timer timer;
 	uint64_t total_int_cnt;
+
+	struct psi_accel psi;
 };
 
 struct rve_cmd_reg_array_t {
@@ -608,6 +608,8 @@ static int rve_drv_probe(struct platform_device *pdev)
 	pr_info("Driver loaded successfully rve[%d] ver:%s\n", i,
 		scheduler->version.str);
 
+	psi_accel_register(&scheduler->psi, dev_name(dev));
+
 	data->scheduler[data->num_of_scheduler] = scheduler;
 
 	data->num_of_scheduler++;
@@ -635,6 +637,10 @@ static int rve_drv_probe(struct platform_device *pdev)
 
 static int rve_drv_remove(struct platform_device *pdev)
 {
+	struct rve_scheduler_t *scheduler = platform_get_drvdata(pdev);
+
+	psi_accel_unregister(&scheduler->psi);
+
 	device_init_wakeup(&pdev->dev, false);
 #ifndef RVE_PD_AWAYS_ON
 	pm_runtime_disable(&pdev->dev);
@@ -467,14 +467,17 @@ static inline int rve_job_wait(struct rve_job *job)
 {
 	struct rve_scheduler_t *scheduler;
 
+	unsigned long pflags;
 	int left_time;
 	ktime_t now;
 	int ret;
 
 	scheduler = rve_job_get_scheduler(job);
 
+	psi_accelstall_enter(&scheduler->psi, &pflags);
 	left_time = wait_event_interruptible_timeout(scheduler->job_done_wq,
 		job->flags & RVE_JOB_DONE, RVE_SYNC_TIMEOUT_DELAY);
+	psi_accelstall_leave(&scheduler->psi, &pflags);
 
 	switch (left_time) {
 	case 0:
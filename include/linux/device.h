@@ -943,6 +943,8 @@ struct device_link *device_link_add(struct device *consumer,
 				    struct device *supplier, u32 flags);
 void device_link_del(struct device_link *link);
 void device_link_remove(void *consumer, struct device *supplier);
+int device_for_each_supplier(struct device *dev, void *data,
+			     int (*fn)(struct device *supplier, void *data));
 void device_links_supplier_sync_state_pause(void);
 void device_links_supplier_sync_state_resume(void);
 
@@ -26,6 +26,9 @@
 /********** include/linux/timer.h **********/
 #define TIMER_ENTRY_STATIC	((void *) 0x300 + POISON_POINTER_DELTA)
 
+/********** net/core/page_pool.c **********/
+#define PP_SIGNATURE		(0x40 + POISON_POINTER_DELTA)
+
 /********** mm/page_poison.c **********/
 #define PAGE_POISON 0xaa
 
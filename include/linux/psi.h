@@ -24,6 +24,11 @@ void psi_memstall_tick(struct task_struct *task, int cpu);
 void psi_memstall_enter(unsigned long *flags);
 void psi_memstall_leave(unsigned long *flags);
 
+void psi_accel_register(struct psi_accel *accel, const char *name);
+void psi_accel_unregister(struct psi_accel *accel);
+void psi_accelstall_enter(struct psi_accel *accel, unsigned long *flags);
+void psi_accelstall_leave(struct psi_accel *accel, unsigned long *flags);
+
 int psi_show(struct seq_file *s, struct psi_group *group, enum psi_res res);
 
 #ifdef CONFIG_CGROUPS
@@ -46,6 +51,14 @@ static inline void psi_init(void) {}
 static inline void psi_memstall_enter(unsigned long *flags) {}
 static inline void psi_memstall_leave(unsigned long *flags) {}
 
+static inline void psi_accel_register(struct psi_accel *accel,
+				      const char *name) {}
+static inline void psi_accel_unregister(struct psi_accel *accel) {}
+static inline void psi_accelstall_enter(struct psi_accel *accel,
+					unsigned long *flags) {}
+static inline void psi_accelstall_leave(struct psi_accel *accel,
+					unsigned long *flags) {}
+
 #ifdef CONFIG_CGROUPS
 static inline int psi_cgroup_alloc(struct cgroup *cgrp)
 {
@@ -3,6 +3,7 @@
 
 #include <linux/kthread.h>
 #include <linux/seqlock.h>
+#include <linux/spinlock_types.h>
 #include <linux/types.h>
 #include <linux/kref.h>
 #include <linux/wait.h>
@@ -13,6 +14,7 @@
 enum psi_task_count {
 	NR_IOWAIT,
 	NR_MEMSTALL,
+	NR_ACCELSTALL,
 	NR_RUNNING,
 	/*
 	 * This can't have values other than 0 or 1 and could be
@@ -21,12 +23,13 @@ enum psi_task_count {
 	 * don't have to special case any state tracking for it.
 	 */
 	NR_ONCPU,
-	NR_PSI_TASK_COUNTS = 4,
+	NR_PSI_TASK_COUNTS = 5,
 };
 
 /* Task state bitmasks */
 #define TSK_IOWAIT	(1 << NR_IOWAIT)
 #define TSK_MEMSTALL	(1 << NR_MEMSTALL)
+#define TSK_ACCELSTALL	(1 << NR_ACCELSTALL)
 #define TSK_RUNNING	(1 << NR_RUNNING)
 #define TSK_ONCPU	(1 << NR_ONCPU)
 
@@ -34,8 +37,9 @@ enum psi_task_count {
 enum psi_res {
 	PSI_IO,
 	PSI_MEM,
+	PSI_ACCEL,
 	PSI_CPU,
-	NR_PSI_RESOURCES = 3,
+	NR_PSI_RESOURCES = 4,
 };
 
 /*
@@ -49,10 +53,12 @@ enum psi_states {
 	PSI_IO_FULL,
 	PSI_MEM_SOME,
 	PSI_MEM_FULL,
+	PSI_ACCEL_SOME,
+	PSI_ACCEL_FULL,
 	PSI_CPU_SOME,
 	/* Only per-CPU, to weigh the CPU in the global average: */
 	PSI_NONIDLE,
-	NR_PSI_STATES = 6,
+	NR_PSI_STATES = 8,
 };
 
 enum psi_aggregators {
@@ -174,9 +180,31 @@ struct psi_group {
 	u64 polling_until;
 };
 
+/* Stall time tracking of a single hardware accelerator */
+struct psi_accel {
+	/* Name shown in /proc/pressure/accel_devices */
+	const char *name;
+
+	/* Node in the list of registered accelerators */
+	struct list_head node;
+
+	/* Protects the stall state below */
+	spinlock_t lock;
+
+	/* Tasks currently waiting for the device */
+	unsigned int nr_waiting;
+
+	/* Start of the current stall, i.e. since nr_waiting became 1 (ns) */
+	u64 stall_start;
+
+	/* Total time with at least one task waiting for the device (ns) */
+	u64 stall_total;
+};
+
 #else /* CONFIG_PSI */
 
 struct psi_group { };
+struct psi_accel { };
 
 #endif /* CONFIG_PSI */
 
@@ -634,6 +634,34 @@ struct uclamp_se {
 	unsigned int active		: 1;
 	unsigned int user_defined	: 1;
 };
+
+/*
+ * Frame utilization hint.
+ *
+ * A non-deadline task can declare, through SCHED_FLAG_UTIL_DEADLINE, that
+ * each activation (from wakeup until it blocks again) carries about
+ * @runtime nanoseconds of work, measured at the maximum capacity of the
+ * system, which must complete within @deadline nanoseconds of the wakeup.
+ *
+ * While such a task is runnable its CPU advertises to schedutil the
+ * utilization required to complete the remaining work in the remaining
+ * time, which is re-evaluated at each tick against the work actually done:
+ *
+ *   util = (runtime - work) * SCHED_CAPACITY_SCALE / (deadline - elapsed)
+ *
+ * @bw is the activation start value (runtime / deadline) and @util the
+ * value currently accounted in rq->frame_util. @wake_time, @exec_start and
+ * @work track the current activation; @wake_time is 0 between activations.
+ */
+struct sched_frame_hint {
+	u64				runtime;
+	u64				deadline;
+	u64				wake_time;
+	u64				exec_start;
+	u64				work;
+	unsigned int			bw;
+	unsigned int			util;
+};
 #endif /* CONFIG_UCLAMP_TASK */
 
 union rcu_special {
@@ -727,6 +755,11 @@ struct task_struct {
 	 * Must be updated with task_rq_lock() held.
 	 */
 	struct uclamp_se		uclamp[UCLAMP_CNT];
+	/*
+	 * Frame utilization hint.
+	 * Must be updated with task_rq_lock() held.
+	 */
+	struct sched_frame_hint		frame;
 #endif
 
 #ifdef CONFIG_HOTPLUG_CPU
@@ -850,6 +883,8 @@ struct task_struct {
 #ifdef CONFIG_PSI
 	/* Stalled due to lack of memory */
 	unsigned			in_memstall:1;
+	/* Stalled waiting for a hardware accelerator */
+	unsigned			in_accelstall:1;
 #endif
 
 	unsigned long			atomic_flags; /* Flags requiring atomic access. */
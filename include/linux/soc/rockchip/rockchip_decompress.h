@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Copyright (C) 2020 Rockchip Electronics Co., Ltd
+ */
+#ifndef _ROCKCHIP_DECOMPRESS_H
+#define _ROCKCHIP_DECOMPRESS_H
+
+#include <linux/types.h>
+
+enum decom_mod {
+	LZ4_MOD,
+	GZIP_MOD,
+	ZLIB_MOD,
+};
+
+#ifdef CONFIG_ROCKCHIP_HW_DECOMPRESS
+int rk_decom_start(u32 mode, phys_addr_t src, phys_addr_t dst, u32 dst_max_size);
+int rk_decom_run(u32 mode, phys_addr_t src, u32 src_size, phys_addr_t dst,
+		 u32 dst_max_size, u64 *decom_len);
+#else
+static inline int rk_decom_start(u32 mode, phys_addr_t src, phys_addr_t dst,
+				 u32 dst_max_size)
+{
+	return -EINVAL;
+}
+
+static inline int rk_decom_run(u32 mode, phys_addr_t src, u32 src_size,
+			       phys_addr_t dst, u32 dst_max_size,
+			       u64 *decom_len)
+{
+	return -ENODEV;
+}
+#endif
+
+#endif /* _ROCKCHIP_DECOMPRESS_H */
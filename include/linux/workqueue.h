@@ -135,6 +135,29 @@ struct rcu_work {
 	struct workqueue_struct *wq;
 };
 
+/**
+ * enum wq_affn_scope - affinity scope of an unbound workqueue
+ * @WQ_AFFN_DFL: use the system default, see ``workqueue.default_affinity_scope``
+ * @WQ_AFFN_CPU: one pool_workqueue per CPU
+ * @WQ_AFFN_CLUSTER: one pool_workqueue per CPU cluster, e.g. the big or
+ *	the LITTLE cores of a big.LITTLE system
+ * @WQ_AFFN_NUMA: one pool_workqueue per NUMA node
+ * @WQ_AFFN_SYSTEM: one pool_workqueue spanning the whole system
+ *
+ * Work items queued on an unbound workqueue are executed by workers allowed
+ * to run on the CPUs of the affinity scope instance the work item was
+ * issued from, intersected with the workqueue's cpumask.
+ */
+enum wq_affn_scope {
+	WQ_AFFN_DFL,
+	WQ_AFFN_CPU,
+	WQ_AFFN_CLUSTER,
+	WQ_AFFN_NUMA,
+	WQ_AFFN_SYSTEM,
+
+	WQ_AFFN_NR_TYPES,
+};
+
 /**
  * struct workqueue_attrs - A struct for workqueue attributes.
  *
@@ -159,6 +182,16 @@ struct workqueue_attrs {
 	 * doesn't participate in pool hash calculations or equality comparisons.
 	 */
 	bool no_numa;
+
+	/**
+	 * @affn_scope: unbound CPU affinity scope
+	 *
+	 * Like ``no_numa``, ``affn_scope`` isn't a property of a worker_pool
+	 * and doesn't participate in pool hash calculations or equality
+	 * comparisons.  Setting ``no_numa`` overrides it with
+	 * %WQ_AFFN_SYSTEM.
+	 */
+	enum wq_affn_scope affn_scope;
 };
 
 static inline struct delayed_work *to_delayed_work(struct work_struct *work)
@@ -673,5 +706,6 @@ int workqueue_offline_cpu(unsigned int cpu);
 
 void __init workqueue_init_early(void);
 void __init workqueue_init(void);
+void __init workqueue_init_topology(void);
 
 #endif
@@ -155,6 +155,7 @@ struct page_pool *page_pool_create(const struct page_pool_params *params);
 void page_pool_destroy(struct page_pool *pool);
 void page_pool_use_xdp_mem(struct page_pool *pool, void (*disconnect)(void *));
 void page_pool_release_page(struct page_pool *pool, struct page *page);
+bool page_pool_return_skb_page(struct page *page);
 #else
 static inline void page_pool_destroy(struct page_pool *pool)
 {
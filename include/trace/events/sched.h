@@ -627,6 +627,81 @@ TRACE_EVENT(sched_wake_idle_without_ipi,
 	TP_printk("cpu=%d", __entry->cpu)
 );
 
+/*
+ * Tracepoint for the frame utilization re-evaluated at tick for a task
+ * with a frame hint: @util is the utilization requested to complete the
+ * @remaining work (ns at max capacity) within @time_left ns.
+ */
+TRACE_EVENT(sched_frame_boost,
+
+	TP_PROTO(struct task_struct *tsk, int cpu, unsigned long util,
+		 u64 remaining, s64 time_left),
+
+	TP_ARGS(tsk, cpu, util, remaining, time_left),
+
+	TP_STRUCT__entry(
+		__array(	char,	comm,	TASK_COMM_LEN	)
+		__field(	pid_t,	pid			)
+		__field(	int,	cpu			)
+		__field(	unsigned long,	util		)
+		__field(	u64,	remaining		)
+		__field(	s64,	time_left		)
+	),
+
+	TP_fast_assign(
+		memcpy(__entry->comm, tsk->comm, TASK_COMM_LEN);
+		__entry->pid		= tsk->pid;
+		__entry->cpu		= cpu;
+		__entry->util		= util;
+		__entry->remaining	= remaining;
+		__entry->time_left	= time_left;
+	),
+
+	TP_printk("comm=%s pid=%d cpu=%d util=%lu remaining=%Lu [ns] time_left=%Ld [ns]",
+		  __entry->comm, __entry->pid, __entry->cpu, __entry->util,
+		  (unsigned long long)__entry->remaining,
+		  (long long)__entry->time_left)
+);
+
+/*
+ * Tracepoint for the end of an activation of a task with a frame hint:
+ * declared @runtime and @deadline against the @work actually done (ns at
+ * max capacity) and the @elapsed time since wakeup.
+ */
+TRACE_EVENT(sched_frame_complete,
+
+	TP_PROTO(struct task_struct *tsk, u64 runtime, u64 deadline,
+		 u64 work, u64 elapsed),
+
+	TP_ARGS(tsk, runtime, deadline, work, elapsed),
+
+	TP_STRUCT__entry(
+		__array(	char,	comm,	TASK_COMM_LEN	)
+		__field(	pid_t,	pid			)
+		__field(	u64,	runtime			)
+		__field(	u64,	deadline		)
+		__field(	u64,	work			)
+		__field(	u64,	elapsed			)
+	),
+
+	TP_fast_assign(
+		memcpy(__entry->comm, tsk->comm, TASK_COMM_LEN);
+		__entry->pid		= tsk->pid;
+		__entry->runtime	= runtime;
+		__entry->deadline	= deadline;
+		__entry->work		= work;
+		__entry->elapsed	= elapsed;
+	),
+
+	TP_printk("comm=%s pid=%d runtime=%Lu work=%Lu deadline=%Lu elapsed=%Lu [ns]%s",
+		  __entry->comm, __entry->pid,
+		  (unsigned long long)__entry->runtime,
+		  (unsigned long long)__entry->work,
+		  (unsigned long long)__entry->deadline,
+		  (unsigned long long)__entry->elapsed,
+		  __entry->elapsed > __entry->deadline ? " missed" : "")
+);
+
 /*
  * Following tracepoints are not exported in tracefs and provide hooking
  * mechanisms only for testing and debugging purposes.
@@ -438,6 +438,13 @@ enum {
 
 /* Create a map that is suitable to be an inner map with dynamic max entries */
 	BPF_F_INNER_MAP		= (1U << 12),
+
+/* Instead of having one common LRU list in the BPF_MAP_TYPE_LRU_HASH map,
+ * shard it into percpu LRU lists.  Unlike BPF_F_NO_COMMON_LRU, a CPU whose
+ * list runs out of free nodes evicts a batch of nodes from the other lists,
+ * so the nodes follow the CPUs doing the updates.
+ */
+	BPF_F_LRU_SHARDED	= (1U << 13),
 };
 
 /* Flags for BPF_PROG_QUERY. */
@@ -502,6 +509,15 @@ union bpf_attr {
 						   * struct stored as the
 						   * map value
 						   */
+		/* Any per-map-type extra fields
+		 *
+		 * BPF_MAP_TYPE_RINGBUF - lower 32 bits are a wakeup
+		 * watermark in bytes: records committed without flags only
+		 * notify readers once this much data is pending. Upper 32
+		 * bits are a timeout in microseconds after which readers
+		 * are notified of pending data below the watermark.
+		 */
+		__u64	map_extra;
 	};
 
 	struct { /* anonymous struct used by BPF_MAP_*_ELEM commands */
@@ -27,6 +27,31 @@ struct vhost_vring_file {
 
 };
 
+struct vhost_worker_state {
+	/*
+	 * For VHOST_NEW_WORKER the kernel will return the new vhost_worker id.
+	 * For VHOST_FREE_WORKER this must be set to the id of the vhost_worker
+	 * to free.
+	 */
+	unsigned int worker_id;
+};
+
+struct vhost_vring_worker {
+	/* vring index */
+	unsigned int index;
+	/* The id of the vhost_worker returned from VHOST_NEW_WORKER */
+	unsigned int worker_id;
+};
+
+struct vhost_worker_affinity {
+	/* The id of the vhost_worker returned from VHOST_NEW_WORKER */
+	unsigned int worker_id;
+	/* Size in bytes of the cpu mask at user_mask_ptr */
+	unsigned int mask_size;
+	/* Pointer to a cpu mask in sched_setaffinity() layout */
+	__u64 user_mask_ptr;
+};
+
 struct vhost_vring_addr {
 	unsigned int index;
 	/* Option flags. */
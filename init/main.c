@@ -1718,6 +1718,7 @@ static noinline void __init kernel_init_freeable(void)
 
 	smp_init();
 	sched_init_smp();
+	workqueue_init_topology();
 
 #ifdef CONFIG_ROCKCHIP_THUNDER_BOOT
 	kthread_run(defer_free_memblock, NULL, "defer_mem");
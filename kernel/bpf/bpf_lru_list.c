@@ -13,6 +13,9 @@
 #define PERCPU_FREE_TARGET		(4)
 #define PERCPU_NR_SCANS			PERCPU_FREE_TARGET
 
+/* A sharded LRU refills a local free list with at most a quarter of a shard */
+#define SHARDED_FREE_TARGET_SHIFT	(2)
+
 /* Helpers to get the local list index */
 #define LOCAL_LIST_IDX(t)	((t) - BPF_LOCAL_LIST_T_OFFSET)
 #define LOCAL_FREE_LIST_IDX	LOCAL_LIST_IDX(BPF_LRU_LOCAL_LIST_T_FREE)
@@ -27,6 +30,24 @@ static int get_next_cpu(int cpu)
 	return cpu;
 }
 
+static struct bpf_lru_list *bpf_common_lru_list(struct bpf_lru *lru, int cpu)
+{
+	if (lru->sharded)
+		return per_cpu_ptr(lru->common_lru.shards, cpu);
+
+	return &lru->common_lru.lru_list;
+}
+
+/* Must be called with irqs disabled */
+static void bpf_lru_list_lock(struct bpf_lru *lru, struct bpf_lru_list *l)
+{
+	if (raw_spin_trylock(&l->lock))
+		return;
+
+	this_cpu_inc(lru->stats->lock_contended);
+	raw_spin_lock(&l->lock);
+}
+
 /* Local list helpers */
 static struct list_head *local_free_list(struct bpf_lru_locallist *loc_l)
 {
@@ -228,6 +249,8 @@ __bpf_lru_list_shrink_inactive(struct bpf_lru *lru,
 			break;
 	}
 
+	this_cpu_add(lru->stats->evictions, nshrinked);
+
 	return nshrinked;
 }
 
@@ -250,7 +273,9 @@ static void __bpf_lru_list_rotate(struct bpf_lru *lru, struct bpf_lru_list *l)
  * __bpf_lru_list_shrink_inactive().  It will just remove
  * one node from either inactive or active list without
  * honoring the ref-bit.  It prefers inactive list to active
- * list in this situation.
+ * list in this situation.  A sharded LRU removes up to
+ * tgt_nshrink nodes instead, so that the following pops
+ * do not have to force shrink again one node at a time.
  */
 static unsigned int __bpf_lru_list_shrink(struct bpf_lru *lru,
 					  struct bpf_lru_list *l,
@@ -268,6 +293,9 @@ static unsigned int __bpf_lru_list_shrink(struct bpf_lru *lru,
 	if (nshrinked)
 		return nshrinked;
 
+	if (!lru->sharded)
+		tgt_nshrink = 1;
+
 	/* Do a force shrink by ignoring the reference bit */
 	if (!list_empty(&l->lists[BPF_LRU_LIST_T_INACTIVE]))
 		force_shrink_list = &l->lists[BPF_LRU_LIST_T_INACTIVE];
@@ -279,11 +307,15 @@ static unsigned int __bpf_lru_list_shrink(struct bpf_lru *lru,
 		if (lru->del_from_htab(lru->del_arg, node)) {
 			__bpf_lru_node_move_to_free(l, node, free_list,
 						    tgt_free_type);
-			return 1;
+			if (++nshrinked == tgt_nshrink)
+				break;
 		}
 	}
 
-	return 0;
+	this_cpu_add(lru->stats->evictions, nshrinked);
+	this_cpu_add(lru->stats->forced_evictions, nshrinked);
+
+	return nshrinked;
 }
 
 /* Flush the nodes from the local pending list to the LRU list */
@@ -302,7 +334,8 @@ static void __local_list_flush(struct bpf_lru_list *l,
 	}
 }
 
-static void bpf_lru_list_push_free(struct bpf_lru_list *l,
+static void bpf_lru_list_push_free(struct bpf_lru *lru,
+				   struct bpf_lru_list *l,
 				   struct bpf_lru_node *node)
 {
 	unsigned long flags;
@@ -310,21 +343,26 @@ static void bpf_lru_list_push_free(struct bpf_lru_list *l,
 	if (WARN_ON_ONCE(IS_LOCAL_LIST_TYPE(node->type)))
 		return;
 
-	raw_spin_lock_irqsave(&l->lock, flags);
+	local_irq_save(flags);
+	bpf_lru_list_lock(lru, l);
 	__bpf_lru_node_move(l, node, BPF_LRU_LIST_T_FREE);
 	raw_spin_unlock_irqrestore(&l->lock, flags);
 }
 
-static void bpf_lru_list_pop_free_to_local(struct bpf_lru *lru,
-					   struct bpf_lru_locallist *loc_l)
+/* Move up to lru->free_target free nodes from @l to @loc_l, after
+ * flushing the pending nodes of @loc_l to @l when @flush is set.
+ */
+static unsigned int
+bpf_lru_list_pop_free_to_local(struct bpf_lru *lru, struct bpf_lru_list *l,
+			       struct bpf_lru_locallist *loc_l, bool flush)
 {
-	struct bpf_lru_list *l = &lru->common_lru.lru_list;
 	struct bpf_lru_node *node, *tmp_node;
 	unsigned int nfree = 0;
 
-	raw_spin_lock(&l->lock);
+	bpf_lru_list_lock(lru, l);
 
-	__local_list_flush(l, loc_l);
+	if (flush)
+		__local_list_flush(l, loc_l);
 
 	__bpf_lru_list_rotate(lru, l);
 
@@ -332,16 +370,43 @@ static void bpf_lru_list_pop_free_to_local(struct bpf_lru *lru,
 				 list) {
 		__bpf_lru_node_move_to_free(l, node, local_free_list(loc_l),
 					    BPF_LRU_LOCAL_LIST_T_FREE);
-		if (++nfree == LOCAL_FREE_TARGET)
+		if (++nfree == lru->free_target)
 			break;
 	}
 
-	if (nfree < LOCAL_FREE_TARGET)
-		__bpf_lru_list_shrink(lru, l, LOCAL_FREE_TARGET - nfree,
-				      local_free_list(loc_l),
-				      BPF_LRU_LOCAL_LIST_T_FREE);
+	if (nfree < lru->free_target)
+		nfree += __bpf_lru_list_shrink(lru, l,
+					       lru->free_target - nfree,
+					       local_free_list(loc_l),
+					       BPF_LRU_LOCAL_LIST_T_FREE);
 
 	raw_spin_unlock(&l->lock);
+
+	return nfree;
+}
+
+/* The shard of @cpu has no node left to free: take a batch of free or
+ * evicted nodes from the other shards, starting with loc_l->next_steal.
+ * They join the shard of @cpu when their pending list is flushed.
+ */
+static void bpf_lru_shards_pop_free_to_local(struct bpf_lru *lru,
+					     struct bpf_lru_locallist *loc_l,
+					     int cpu)
+{
+	int steal = loc_l->next_steal;
+
+	do {
+		if (steal != cpu &&
+		    bpf_lru_list_pop_free_to_local(lru,
+						   bpf_common_lru_list(lru, steal),
+						   loc_l, false)) {
+			this_cpu_inc(lru->stats->steals);
+			break;
+		}
+		steal = get_next_cpu(steal);
+	} while (steal != loc_l->next_steal);
+
+	loc_l->next_steal = get_next_cpu(steal);
 }
 
 static void __local_list_add_pending(struct bpf_lru *lru,
@@ -384,6 +449,7 @@ __local_list_pop_pending(struct bpf_lru *lru, struct bpf_lru_locallist *loc_l)
 		if ((!bpf_lru_node_is_ref(node) || force) &&
 		    lru->del_from_htab(lru->del_arg, node)) {
 			list_del(&node->list);
+			this_cpu_inc(lru->stats->evictions);
 			return node;
 		}
 	}
@@ -407,7 +473,8 @@ static struct bpf_lru_node *bpf_percpu_lru_pop_free(struct bpf_lru *lru,
 
 	l = per_cpu_ptr(lru->percpu_lru, cpu);
 
-	raw_spin_lock_irqsave(&l->lock, flags);
+	local_irq_save(flags);
+	bpf_lru_list_lock(lru, l);
 
 	__bpf_lru_list_rotate(lru, l);
 
@@ -444,7 +511,11 @@ static struct bpf_lru_node *bpf_common_lru_pop_free(struct bpf_lru *lru,
 
 	node = __local_list_pop_free(loc_l);
 	if (!node) {
-		bpf_lru_list_pop_free_to_local(lru, loc_l);
+		if (!bpf_lru_list_pop_free_to_local(lru,
+						    bpf_common_lru_list(lru, cpu),
+						    loc_l, true) &&
+		    lru->sharded)
+			bpf_lru_shards_pop_free_to_local(lru, loc_l, cpu);
 		node = __local_list_pop_free(loc_l);
 	}
 
@@ -483,6 +554,7 @@ static struct bpf_lru_node *bpf_common_lru_pop_free(struct bpf_lru *lru,
 	loc_l->next_steal = steal;
 
 	if (node) {
+		this_cpu_inc(lru->stats->steals);
 		raw_spin_lock_irqsave(&loc_l->lock, flags);
 		__local_list_add_pending(lru, loc_l, cpu, node, hash);
 		raw_spin_unlock_irqrestore(&loc_l->lock, flags);
@@ -530,7 +602,7 @@ static void bpf_common_lru_push_free(struct bpf_lru *lru,
 	}
 
 check_lru_list:
-	bpf_lru_list_push_free(&lru->common_lru.lru_list, node);
+	bpf_lru_list_push_free(lru, bpf_common_lru_list(lru, node->cpu), node);
 }
 
 static void bpf_percpu_lru_push_free(struct bpf_lru *lru,
@@ -541,7 +613,8 @@ static void bpf_percpu_lru_push_free(struct bpf_lru *lru,
 
 	l = per_cpu_ptr(lru->percpu_lru, node->cpu);
 
-	raw_spin_lock_irqsave(&l->lock, flags);
+	local_irq_save(flags);
+	bpf_lru_list_lock(lru, l);
 
 	__bpf_lru_node_move(l, node, BPF_LRU_LIST_T_FREE);
 
@@ -574,8 +647,8 @@ static void bpf_common_lru_populate(struct bpf_lru *lru, void *buf,
 	}
 }
 
-static void bpf_percpu_lru_populate(struct bpf_lru *lru, void *buf,
-				    u32 node_offset, u32 elem_size,
+static void bpf_percpu_lru_populate(struct bpf_lru_list __percpu *lists,
+				    void *buf, u32 node_offset, u32 elem_size,
 				    u32 nr_elems)
 {
 	u32 i, pcpu_entries;
@@ -589,7 +662,7 @@ static void bpf_percpu_lru_populate(struct bpf_lru *lru, void *buf,
 	for_each_possible_cpu(cpu) {
 		struct bpf_lru_node *node;
 
-		l = per_cpu_ptr(lru->percpu_lru, cpu);
+		l = per_cpu_ptr(lists, cpu);
 again:
 		node = (struct bpf_lru_node *)(buf + node_offset);
 		node->cpu = cpu;
@@ -608,12 +681,19 @@ static void bpf_percpu_lru_populate(struct bpf_lru *lru, void *buf,
 void bpf_lru_populate(struct bpf_lru *lru, void *buf, u32 node_offset,
 		      u32 elem_size, u32 nr_elems)
 {
-	if (lru->percpu)
-		bpf_percpu_lru_populate(lru, buf, node_offset, elem_size,
-					nr_elems);
-	else
+	if (lru->percpu) {
+		bpf_percpu_lru_populate(lru->percpu_lru, buf, node_offset,
+					elem_size, nr_elems);
+	} else if (lru->sharded) {
+		bpf_percpu_lru_populate(lru->common_lru.shards, buf,
+					node_offset, elem_size, nr_elems);
+		lru->free_target = clamp_t(u32, (nr_elems / num_possible_cpus()) >>
+					   SHARDED_FREE_TARGET_SHIFT,
+					   1, LOCAL_FREE_TARGET);
+	} else {
 		bpf_common_lru_populate(lru, buf, node_offset, elem_size,
 					nr_elems);
+	}
 }
 
 static void bpf_lru_locallist_init(struct bpf_lru_locallist *loc_l, int cpu)
@@ -643,15 +723,20 @@ static void bpf_lru_list_init(struct bpf_lru_list *l)
 	raw_spin_lock_init(&l->lock);
 }
 
-int bpf_lru_init(struct bpf_lru *lru, bool percpu, u32 hash_offset,
-		 del_from_htab_func del_from_htab, void *del_arg)
+int bpf_lru_init(struct bpf_lru *lru, bool percpu, bool sharded,
+		 u32 hash_offset, del_from_htab_func del_from_htab,
+		 void *del_arg)
 {
 	int cpu;
 
+	lru->stats = alloc_percpu(struct bpf_lru_stats);
+	if (!lru->stats)
+		return -ENOMEM;
+
 	if (percpu) {
 		lru->percpu_lru = alloc_percpu(struct bpf_lru_list);
 		if (!lru->percpu_lru)
-			return -ENOMEM;
+			goto free_stats;
 
 		for_each_possible_cpu(cpu) {
 			struct bpf_lru_list *l;
@@ -665,7 +750,7 @@ int bpf_lru_init(struct bpf_lru *lru, bool percpu, u32 hash_offset,
 
 		clru->local_list = alloc_percpu(struct bpf_lru_locallist);
 		if (!clru->local_list)
-			return -ENOMEM;
+			goto free_stats;
 
 		for_each_possible_cpu(cpu) {
 			struct bpf_lru_locallist *loc_l;
@@ -674,22 +759,58 @@ int bpf_lru_init(struct bpf_lru *lru, bool percpu, u32 hash_offset,
 			bpf_lru_locallist_init(loc_l, cpu);
 		}
 
-		bpf_lru_list_init(&clru->lru_list);
+		if (sharded) {
+			clru->shards = alloc_percpu(struct bpf_lru_list);
+			if (!clru->shards) {
+				free_percpu(clru->local_list);
+				goto free_stats;
+			}
+
+			for_each_possible_cpu(cpu)
+				bpf_lru_list_init(per_cpu_ptr(clru->shards, cpu));
+		} else {
+			bpf_lru_list_init(&clru->lru_list);
+		}
 		lru->nr_scans = LOCAL_NR_SCANS;
+		lru->free_target = LOCAL_FREE_TARGET;
 	}
 
 	lru->percpu = percpu;
+	lru->sharded = !percpu && sharded;
 	lru->del_from_htab = del_from_htab;
 	lru->del_arg = del_arg;
 	lru->hash_offset = hash_offset;
 
 	return 0;
+
+free_stats:
+	free_percpu(lru->stats);
+	return -ENOMEM;
 }
 
 void bpf_lru_destroy(struct bpf_lru *lru)
 {
-	if (lru->percpu)
+	if (lru->percpu) {
 		free_percpu(lru->percpu_lru);
-	else
+	} else {
 		free_percpu(lru->common_lru.local_list);
+		free_percpu(lru->common_lru.shards);
+	}
+	free_percpu(lru->stats);
+}
+
+void bpf_lru_read_stats(struct bpf_lru *lru, struct bpf_lru_stats *stats)
+{
+	int cpu;
+
+	memset(stats, 0, sizeof(*stats));
+
+	for_each_possible_cpu(cpu) {
+		const struct bpf_lru_stats *s = per_cpu_ptr(lru->stats, cpu);
+
+		stats->evictions += READ_ONCE(s->evictions);
+		stats->forced_evictions += READ_ONCE(s->forced_evictions);
+		stats->steals += READ_ONCE(s->steals);
+		stats->lock_contended += READ_ONCE(s->lock_contended);
+	}
 }
@@ -45,6 +45,15 @@ struct bpf_lru_locallist {
 struct bpf_common_lru {
 	struct bpf_lru_list lru_list;
 	struct bpf_lru_locallist __percpu *local_list;
+	/* Replaces lru_list when sharded */
+	struct bpf_lru_list __percpu *shards;
+};
+
+struct bpf_lru_stats {
+	u64 evictions;
+	u64 forced_evictions;
+	u64 steals;
+	u64 lock_contended;
 };
 
 typedef bool (*del_from_htab_func)(void *arg, struct bpf_lru_node *node);
@@ -56,9 +65,12 @@ struct bpf_lru {
 	};
 	del_from_htab_func del_from_htab;
 	void *del_arg;
+	struct bpf_lru_stats __percpu *stats;
 	unsigned int hash_offset;
 	unsigned int nr_scans;
+	unsigned int free_target;
 	bool percpu;
+	bool sharded;
 };
 
 static inline void bpf_lru_node_set_ref(struct bpf_lru_node *node)
@@ -70,13 +82,15 @@ static inline void bpf_lru_node_set_ref(struct bpf_lru_node *node)
 		node->ref = 1;
 }
 
-int bpf_lru_init(struct bpf_lru *lru, bool percpu, u32 hash_offset,
-		 del_from_htab_func del_from_htab, void *delete_arg);
+int bpf_lru_init(struct bpf_lru *lru, bool percpu, bool sharded,
+		 u32 hash_offset, del_from_htab_func del_from_htab,
+		 void *delete_arg);
 void bpf_lru_populate(struct bpf_lru *lru, void *buf, u32 node_offset,
 		      u32 elem_size, u32 nr_elems);
 void bpf_lru_destroy(struct bpf_lru *lru);
 struct bpf_lru_node *bpf_lru_pop_free(struct bpf_lru *lru, u32 hash);
 void bpf_lru_push_free(struct bpf_lru *lru, struct bpf_lru_node *node);
 void bpf_lru_promote(struct bpf_lru *lru, struct bpf_lru_node *node);
+void bpf_lru_read_stats(struct bpf_lru *lru, struct bpf_lru_stats *stats);
 
 #endif
@@ -16,7 +16,7 @@
 
 #define HTAB_CREATE_FLAG_MASK						\
 	(BPF_F_NO_PREALLOC | BPF_F_NO_COMMON_LRU | BPF_F_NUMA_NODE |	\
-	 BPF_F_ACCESS_MASK | BPF_F_ZERO_SEED)
+	 BPF_F_ACCESS_MASK | BPF_F_ZERO_SEED | BPF_F_LRU_SHARDED)
 
 #define BATCH_OPS(_name)			\
 	.map_lookup_batch =			\
@@ -279,6 +279,7 @@ static int prealloc_init(struct bpf_htab *htab)
 	if (htab_is_lru(htab))
 		err = bpf_lru_init(&htab->lru,
 				   htab->map.map_flags & BPF_F_NO_COMMON_LRU,
+				   htab->map.map_flags & BPF_F_LRU_SHARDED,
 				   offsetof(struct htab_elem, hash) -
 				   offsetof(struct htab_elem, lru_node),
 				   htab_lru_map_delete_node,
@@ -351,6 +352,7 @@ static int htab_map_alloc_check(union bpf_attr *attr)
 	 * nothing to do with the map's value.
 	 */
 	bool percpu_lru = (attr->map_flags & BPF_F_NO_COMMON_LRU);
+	bool sharded_lru = (attr->map_flags & BPF_F_LRU_SHARDED);
 	bool prealloc = !(attr->map_flags & BPF_F_NO_PREALLOC);
 	bool zero_seed = (attr->map_flags & BPF_F_ZERO_SEED);
 	int numa_node = bpf_map_attr_numa_node(attr);
@@ -377,6 +379,9 @@ static int htab_map_alloc_check(union bpf_attr *attr)
 	if (!lru && percpu_lru)
 		return -EINVAL;
 
+	if ((!lru || percpu_lru) && sharded_lru)
+		return -EINVAL;
+
 	if (lru && !prealloc)
 		return -ENOTSUPP;
 
@@ -420,6 +425,7 @@ static struct bpf_map *htab_map_alloc(union bpf_attr *attr)
 	 * nothing to do with the map's value.
 	 */
 	bool percpu_lru = (attr->map_flags & BPF_F_NO_COMMON_LRU);
+	bool sharded_lru = (attr->map_flags & BPF_F_LRU_SHARDED);
 	bool prealloc = !(attr->map_flags & BPF_F_NO_PREALLOC);
 	struct bpf_htab *htab;
 	u64 cost;
@@ -431,7 +437,7 @@ static struct bpf_map *htab_map_alloc(union bpf_attr *attr)
 
 	bpf_map_init_from_attr(&htab->map, attr);
 
-	if (percpu_lru) {
+	if (percpu_lru || sharded_lru) {
 		/* ensure each CPU's lru list has >=1 elements.
 		 * since we are at it, make each lru list has the same
 		 * number of elements.
@@ -1362,6 +1368,25 @@ static void htab_map_seq_show_elem(struct bpf_map *map, void *key,
 	rcu_read_unlock();
 }
 
+static void htab_lru_map_show_fdinfo(const struct bpf_map *map,
+				     struct seq_file *m)
+{
+	struct bpf_htab *htab = container_of(map, struct bpf_htab, map);
+	struct bpf_lru_stats stats;
+
+	bpf_lru_read_stats(&htab->lru, &stats);
+
+	seq_printf(m,
+		   "lru_evictions:\t%llu\n"
+		   "lru_forced_evictions:\t%llu\n"
+		   "lru_steals:\t%llu\n"
+		   "lru_lock_contended:\t%llu\n",
+		   stats.evictions,
+		   stats.forced_evictions,
+		   stats.steals,
+		   stats.lock_contended);
+}
+
 static int
 __htab_map_lookup_and_delete_batch(struct bpf_map *map,
 				   const union bpf_attr *attr,
@@ -1858,6 +1883,7 @@ const struct bpf_map_ops htab_lru_map_ops = {
 	.map_delete_elem = htab_lru_map_delete_elem,
 	.map_gen_lookup = htab_lru_map_gen_lookup,
 	.map_seq_show_elem = htab_map_seq_show_elem,
+	.map_show_fdinfo = htab_lru_map_show_fdinfo,
 	BATCH_OPS(htab_lru),
 	.map_btf_name = "bpf_htab",
 	.map_btf_id = &htab_lru_map_btf_id,
@@ -1994,6 +2020,7 @@ const struct bpf_map_ops htab_lru_percpu_map_ops = {
 	.map_update_elem = htab_lru_percpu_map_update_elem,
 	.map_delete_elem = htab_lru_map_delete_elem,
 	.map_seq_show_elem = htab_percpu_map_seq_show_elem,
+	.map_show_fdinfo = htab_lru_map_show_fdinfo,
 	BATCH_OPS(htab_lru_percpu),
 	.map_btf_name = "bpf_htab",
 	.map_btf_id = &htab_lru_percpu_map_btf_id,
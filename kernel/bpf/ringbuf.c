@@ -1,6 +1,7 @@
 #include <linux/bpf.h>
 #include <linux/btf.h>
 #include <linux/err.h>
+#include <linux/hrtimer.h>
 #include <linux/irq_work.h>
 #include <linux/slab.h>
 #include <linux/filter.h>
@@ -33,6 +34,12 @@
 struct bpf_ringbuf {
 	wait_queue_head_t waitq;
 	struct irq_work work;
+	/* Arms wakeup_timer from any context, including NMI */
+	struct irq_work timer_work;
+	struct hrtimer wakeup_timer;
+	u64 wakeup_timeout;	/* in ns, 0 if none */
+	u32 wakeup_watermark;	/* in bytes, 0 to notify when caught up */
+	int wakeup_timer_armed;
 	u64 mask;
 	struct page **pages;
 	int nr_pages;
@@ -130,6 +137,26 @@ static void bpf_ringbuf_notify(struct irq_work *work)
 	wake_up_all(&rb->waitq);
 }
 
+static void bpf_ringbuf_arm_timer(struct irq_work *work)
+{
+	struct bpf_ringbuf *rb = container_of(work, struct bpf_ringbuf,
+					      timer_work);
+
+	hrtimer_start(&rb->wakeup_timer, ns_to_ktime(rb->wakeup_timeout),
+		      HRTIMER_MODE_REL);
+}
+
+static enum hrtimer_restart bpf_ringbuf_wakeup_timeout(struct hrtimer *timer)
+{
+	struct bpf_ringbuf *rb = container_of(timer, struct bpf_ringbuf,
+					      wakeup_timer);
+
+	WRITE_ONCE(rb->wakeup_timer_armed, 0);
+	wake_up_all(&rb->waitq);
+
+	return HRTIMER_NORESTART;
+}
+
 static struct bpf_ringbuf *bpf_ringbuf_alloc(size_t data_sz, int numa_node)
 {
 	struct bpf_ringbuf *rb;
@@ -141,6 +168,9 @@ static struct bpf_ringbuf *bpf_ringbuf_alloc(size_t data_sz, int numa_node)
 	spin_lock_init(&rb->spinlock);
 	init_waitqueue_head(&rb->waitq);
 	init_irq_work(&rb->work, bpf_ringbuf_notify);
+	init_irq_work(&rb->timer_work, bpf_ringbuf_arm_timer);
+	hrtimer_init(&rb->wakeup_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	rb->wakeup_timer.function = bpf_ringbuf_wakeup_timeout;
 
 	rb->mask = data_sz - 1;
 	rb->consumer_pos = 0;
@@ -151,6 +181,8 @@ static struct bpf_ringbuf *bpf_ringbuf_alloc(size_t data_sz, int numa_node)
 
 static struct bpf_map *ringbuf_map_alloc(union bpf_attr *attr)
 {
+	u32 wakeup_watermark = lower_32_bits(attr->map_extra);
+	u32 wakeup_timeout_us = upper_32_bits(attr->map_extra);
 	struct bpf_ringbuf_map *rb_map;
 	u64 cost;
 	int err;
@@ -163,6 +195,11 @@ static struct bpf_map *ringbuf_map_alloc(union bpf_attr *attr)
 	    !PAGE_ALIGNED(attr->max_entries))
 		return ERR_PTR(-EINVAL);
 
+	/* A timeout only makes sense below a watermark that can be reached */
+	if (wakeup_watermark >= attr->max_entries ||
+	    (wakeup_timeout_us && !wakeup_watermark))
+		return ERR_PTR(-EINVAL);
+
 #ifdef CONFIG_64BIT
 	/* on 32-bit arch, it's impossible to overflow record's hdr->pgoff */
 	if (attr->max_entries > RINGBUF_MAX_DATA_SZ)
@@ -188,6 +225,9 @@ static struct bpf_map *ringbuf_map_alloc(union bpf_attr *attr)
 		goto err_uncharge;
 	}
 
+	rb_map->rb->wakeup_watermark = wakeup_watermark;
+	rb_map->rb->wakeup_timeout = (u64)wakeup_timeout_us * NSEC_PER_USEC;
+
 	return &rb_map->map;
 
 err_uncharge:
@@ -216,6 +256,9 @@ static void ringbuf_map_free(struct bpf_map *map)
 	struct bpf_ringbuf_map *rb_map;
 
 	rb_map = container_of(map, struct bpf_ringbuf_map, map);
+	irq_work_sync(&rb_map->rb->timer_work);
+	hrtimer_cancel(&rb_map->rb->wakeup_timer);
+	irq_work_sync(&rb_map->rb->work);
 	bpf_ringbuf_free(rb_map->rb);
 	kfree(rb_map);
 }
@@ -386,6 +429,19 @@ const struct bpf_func_proto bpf_ringbuf_reserve_proto = {
 	.arg3_type	= ARG_ANYTHING,
 };
 
+/* Notify readers once the pending data reaches the wakeup watermark, and
+ * make sure data below it is notified within the wakeup timeout, instead of
+ * notifying the reader of each record it has caught up with.
+ */
+static void bpf_ringbuf_commit_watermark(struct bpf_ringbuf *rb)
+{
+	if (ringbuf_avail_data_sz(rb) >= rb->wakeup_watermark)
+		irq_work_queue(&rb->work);
+	else if (rb->wakeup_timeout && !READ_ONCE(rb->wakeup_timer_armed) &&
+		 !xchg(&rb->wakeup_timer_armed, 1))
+		irq_work_queue(&rb->timer_work);
+}
+
 static void bpf_ringbuf_commit(void *sample, u64 flags, bool discard)
 {
 	unsigned long rec_pos, cons_pos;
@@ -402,15 +458,26 @@ static void bpf_ringbuf_commit(void *sample, u64 flags, bool discard)
 	/* update record header with correct final size prefix */
 	xchg(&hdr->len, new_len);
 
+	if (flags & BPF_RB_FORCE_WAKEUP) {
+		irq_work_queue(&rb->work);
+		return;
+	}
+
+	if (flags & BPF_RB_NO_WAKEUP)
+		return;
+
+	if (rb->wakeup_watermark) {
+		bpf_ringbuf_commit_watermark(rb);
+		return;
+	}
+
 	/* if consumer caught up and is waiting for our record, notify about
 	 * new data availability
 	 */
 	rec_pos = (void *)hdr - (void *)rb->data;
 	cons_pos = smp_load_acquire(&rb->consumer_pos) & rb->mask;
 
-	if (flags & BPF_RB_FORCE_WAKEUP)
-		irq_work_queue(&rb->work);
-	else if (cons_pos == rec_pos && !(flags & BPF_RB_NO_WAKEUP))
+	if (cons_pos == rec_pos)
 		irq_work_queue(&rb->work);
 }
 
@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * KUnit test and benchmark of padata multithreaded jobs.
+ */
+
+#include <kunit/test.h>
+#include <linux/atomic.h>
+#include <linux/bitmap.h>
+#include <linux/cpumask.h>
+#include <linux/delay.h>
+#include <linux/ktime.h>
+#include <linux/module.h>
+#include <linux/padata.h>
+#include <linux/sizes.h>
+#include <linux/string.h>
+#include <linux/vmalloc.h>
+
+#define PADATA_TEST_SIZE	4096
+#define PADATA_TEST_ALIGN	8
+#define PADATA_TEST_MIN_CHUNK	16
+#define PADATA_TEST_CLEAR_SIZE	SZ_32M
+
+struct padata_test_state {
+	struct padata_mt_job	*job;
+	unsigned long		*visited;
+	atomic_t		calls;
+	atomic_t		duplicates;
+	atomic_t		misaligned;
+};
+
+static void padata_test_thread_fn(unsigned long start, unsigned long end,
+				  void *arg)
+{
+	struct padata_test_state *st = arg;
+	struct padata_mt_job *job = st->job;
+	unsigned long i;
+
+	atomic_inc(&st->calls);
+
+	if ((start != job->start && start % job->align) ||
+	    (end != job->start + job->size && end % job->align))
+		atomic_inc(&st->misaligned);
+
+	for (i = start; i < end; i++) {
+		if (test_and_set_bit(i - job->start, st->visited))
+			atomic_inc(&st->duplicates);
+		/*
+		 * Make the first quarter of the job slow so that the helpers
+		 * owning the rest run out of work and steal from its owner.
+		 */
+		if (i - job->start < job->size / 4)
+			udelay(20);
+	}
+}
+
+static void padata_test_init_state(struct kunit *test,
+				   struct padata_test_state *st,
+				   struct padata_mt_job *job)
+{
+	st->job = job;
+	st->visited = kunit_kzalloc(test, BITS_TO_LONGS(job->size) *
+				    sizeof(unsigned long), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, st->visited);
+	atomic_set(&st->calls, 0);
+	atomic_set(&st->duplicates, 0);
+	atomic_set(&st->misaligned, 0);
+}
+
+/*
+ * Test that every unit of an unbalanced job is processed exactly once, in
+ * chunks that honor the job alignment, whatever the stealing order.
+ */
+static void padata_test_exactly_once(struct kunit *test)
+{
+	struct padata_test_state st;
+	struct padata_mt_job job = {
+		.thread_fn	= padata_test_thread_fn,
+		.fn_arg		= &st,
+		.start		= 3,
+		.size		= PADATA_TEST_SIZE,
+		.align		= PADATA_TEST_ALIGN,
+		.min_chunk	= PADATA_TEST_MIN_CHUNK,
+		.max_threads	= num_online_cpus(),
+	};
+
+	padata_test_init_state(test, &st, &job);
+
+	padata_do_multithreaded(&job);
+
+	KUNIT_EXPECT_EQ(test, bitmap_weight(st.visited, job.size),
+			(int)job.size);
+	KUNIT_EXPECT_EQ(test, atomic_read(&st.duplicates), 0);
+	KUNIT_EXPECT_EQ(test, atomic_read(&st.misaligned), 0);
+}
+
+/* Test that a job smaller than the minimum chunk is done in one call. */
+static void padata_test_small_job(struct kunit *test)
+{
+	struct padata_test_state st;
+	struct padata_mt_job job = {
+		.thread_fn	= padata_test_thread_fn,
+		.fn_arg		= &st,
+		.start		= 0,
+		.size		= PADATA_TEST_MIN_CHUNK - 1,
+		.align		= 1,
+		.min_chunk	= PADATA_TEST_MIN_CHUNK,
+		.max_threads	= num_online_cpus(),
+	};
+
+	padata_test_init_state(test, &st, &job);
+
+	padata_do_multithreaded(&job);
+
+	KUNIT_EXPECT_EQ(test, atomic_read(&st.calls), 1);
+	KUNIT_EXPECT_EQ(test, bitmap_weight(st.visited, job.size),
+			(int)job.size);
+}
+
+static void padata_test_clear_chunk(unsigned long start, unsigned long end,
+				    void *arg)
+{
+	memset(arg + start, 0, end - start);
+}
+
+/*
+ * Report the time taken to clear a large buffer with one thread and with
+ * all online CPUs, and check that the buffer is fully cleared.
+ */
+static void padata_test_clear_bench(struct kunit *test)
+{
+	struct padata_mt_job job = {
+		.thread_fn	= padata_test_clear_chunk,
+		.start		= 0,
+		.size		= PADATA_TEST_CLEAR_SIZE,
+		.align		= PAGE_SIZE,
+		.min_chunk	= SZ_1M,
+		.max_threads	= num_online_cpus(),
+	};
+	ktime_t t0, t1, t2;
+	void *buf;
+
+	buf = vmalloc(PADATA_TEST_CLEAR_SIZE);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, buf);
+	job.fn_arg = buf;
+
+	/* Dirty the buffer so that both runs really clear it. */
+	memset(buf, 0xa5, PADATA_TEST_CLEAR_SIZE);
+
+	t0 = ktime_get();
+	memset(buf, 0, PADATA_TEST_CLEAR_SIZE);
+	t1 = ktime_get();
+
+	memset(buf, 0xa5, PADATA_TEST_CLEAR_SIZE);
+	t2 = ktime_get();
+	padata_do_multithreaded(&job);
+	t2 = ktime_sub(ktime_get(), t2);
+
+	KUNIT_EXPECT_PTR_EQ(test, memchr_inv(buf, 0, PADATA_TEST_CLEAR_SIZE),
+			    NULL);
+
+	kunit_info(test, "clear %u MiB: 1 thread %lld us, %d threads %lld us\n",
+		   PADATA_TEST_CLEAR_SIZE / SZ_1M,
+		   ktime_to_us(ktime_sub(t1, t0)), job.max_threads,
+		   ktime_to_us(t2));
+
+	vfree(buf);
+}
+
+static struct kunit_case padata_test_cases[] = {
+	KUNIT_CASE(padata_test_exactly_once),
+	KUNIT_CASE(padata_test_small_job),
+	KUNIT_CASE(padata_test_clear_bench),
+	{}
+};
+
+static struct kunit_suite padata_test_suite = {
+	.name = "padata_mt",
+	.test_cases = padata_test_cases,
+};
+
+kunit_test_suites(&padata_test_suite);
+
+MODULE_LICENSE("GPL v2");
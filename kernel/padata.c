@@ -35,6 +35,7 @@
 #include <linux/slab.h>
 #include <linux/sysfs.h>
 #include <linux/rcupdate.h>
+#include <linux/topology.h>
 
 #define	PADATA_WORK_ONSTACK	1	/* Work's memory is on stack */
 
@@ -47,18 +48,30 @@ struct padata_work {
 static DEFINE_SPINLOCK(padata_works_lock);
 static struct padata_work *padata_works;
 static LIST_HEAD(padata_free_works);
+static struct workqueue_struct *padata_mt_wq;
 
-struct padata_mt_job_state {
+/*
+ * Part of a multithreaded job owned by one helper.  The owner consumes it
+ * from @start while idle helpers steal its second half by lowering @end.
+ */
+struct padata_mt_range {
 	spinlock_t		lock;
+	unsigned long		start;
+	unsigned long		end;
+} ____cacheline_aligned_in_smp;
+
+struct padata_mt_job_state {
 	struct completion	completion;
 	struct padata_mt_job	*job;
+	struct padata_mt_range	*ranges;
 	int			nworks;
-	int			nworks_fini;
+	atomic_t		next_id;
+	atomic_t		nworks_left;
 	unsigned long		chunk_size;
 };
 
 static void padata_free_pd(struct parallel_data *pd);
-static void __init padata_mt_helper(struct work_struct *work);
+static void padata_mt_helper(struct work_struct *work);
 
 static int padata_index_to_cpu(struct parallel_data *pd, int cpu_index)
 {
@@ -106,12 +119,12 @@ static void padata_work_init(struct padata_work *pw, work_func_t work_fn,
 	pw->pw_data = data;
 }
 
-static int __init padata_work_alloc_mt(int nworks, void *data,
-				       struct list_head *head)
+static int padata_work_alloc_mt(int nworks, void *data,
+				struct list_head *head)
 {
 	int i;
 
-	spin_lock(&padata_works_lock);
+	spin_lock_bh(&padata_works_lock);
 	/* Start at 1 because the current task participates in the job. */
 	for (i = 1; i < nworks; ++i) {
 		struct padata_work *pw = padata_work_alloc();
@@ -121,7 +134,7 @@ static int __init padata_work_alloc_mt(int nworks, void *data,
 		padata_work_init(pw, padata_mt_helper, data, 0);
 		list_add(&pw->pw_list, head);
 	}
-	spin_unlock(&padata_works_lock);
+	spin_unlock_bh(&padata_works_lock);
 
 	return i;
 }
@@ -132,19 +145,19 @@ static void padata_work_free(struct padata_work *pw)
 	list_add(&pw->pw_list, &padata_free_works);
 }
 
-static void __init padata_works_free(struct list_head *works)
+static void padata_works_free(struct list_head *works)
 {
 	struct padata_work *cur, *next;
 
 	if (list_empty(works))
 		return;
 
-	spin_lock(&padata_works_lock);
+	spin_lock_bh(&padata_works_lock);
 	list_for_each_entry_safe(cur, next, works, pw_list) {
 		list_del(&cur->pw_list);
 		padata_work_free(cur);
 	}
-	spin_unlock(&padata_works_lock);
+	spin_unlock_bh(&padata_works_lock);
 }
 
 static void padata_parallel_worker(struct work_struct *parallel_work)
@@ -438,54 +451,192 @@ static int padata_setup_cpumasks(struct padata_instance *pinst)
 	return err;
 }
 
-static void __init padata_mt_helper(struct work_struct *w)
+/*
+ * Called by a helper whose range is empty: move the second half of the
+ * largest remaining range to it.  Returns false once no work is left.
+ */
+static bool padata_mt_steal(struct padata_mt_job_state *ps, int id)
+{
+	struct padata_mt_range *own = &ps->ranges[id];
+	struct padata_mt_range *victim = NULL;
+	unsigned long start, end, mid, best = 0;
+	int i;
+
+	/* Lockless scan, the victim's range is rechecked under its lock. */
+	for (i = 0; i < ps->nworks; i++) {
+		struct padata_mt_range *r = &ps->ranges[i];
+
+		end = READ_ONCE(r->end);
+		start = READ_ONCE(r->start);
+		if (i != id && start < end && end - start > best) {
+			best = end - start;
+			victim = r;
+		}
+	}
+
+	if (!victim)
+		return false;
+
+	spin_lock(&victim->lock);
+	start = victim->start;
+	end = victim->end;
+	if (start == end) {
+		/* Raced with its owner or another thief, scan again. */
+		spin_unlock(&victim->lock);
+		return true;
+	}
+
+	/*
+	 * The victim keeps the first half, close to what it is working on.
+	 * Take everything when less than a chunk would be left to steal.
+	 */
+	mid = roundup(start + (end - start) / 2, ps->chunk_size);
+	if (mid >= end)
+		mid = start;
+	victim->end = mid;
+	spin_unlock(&victim->lock);
+
+	spin_lock(&own->lock);
+	own->start = mid;
+	own->end = end;
+	spin_unlock(&own->lock);
+
+	return true;
+}
+
+static void padata_mt_helper(struct work_struct *w)
 {
 	struct padata_work *pw = container_of(w, struct padata_work, pw_work);
 	struct padata_mt_job_state *ps = pw->pw_data;
 	struct padata_mt_job *job = ps->job;
-	bool done;
+	struct padata_mt_range *r;
+	int id;
 
-	spin_lock(&ps->lock);
+	id = atomic_inc_return(&ps->next_id) - 1;
+	r = &ps->ranges[id];
 
-	while (job->size > 0) {
-		unsigned long start, size, end;
+	for (;;) {
+		unsigned long start, end;
 
-		start = job->start;
-		/* So end is chunk size aligned if enough work remains. */
-		size = roundup(start + 1, ps->chunk_size) - start;
-		size = min(size, job->size);
-		end = start + size;
+		spin_lock(&r->lock);
+		if (r->start == r->end) {
+			spin_unlock(&r->lock);
+			if (!padata_mt_steal(ps, id))
+				break;
+			continue;
+		}
 
-		job->start = end;
-		job->size -= size;
+		start = r->start;
+		/* So end is chunk size aligned if enough work remains. */
+		end = min(roundup(start + 1, ps->chunk_size), r->end);
+		r->start = end;
+		spin_unlock(&r->lock);
 
-		spin_unlock(&ps->lock);
 		job->thread_fn(start, end, job->fn_arg);
-		spin_lock(&ps->lock);
+		cond_resched();
 	}
 
-	++ps->nworks_fini;
-	done = (ps->nworks_fini == ps->nworks);
-	spin_unlock(&ps->lock);
-
-	if (done)
+	if (atomic_dec_and_test(&ps->nworks_left))
 		complete(&ps->completion);
 }
 
+static unsigned int padata_mt_weight(const struct cpumask *used,
+				     const struct cpumask *mask)
+{
+	unsigned int weight = 0;
+	int cpu;
+
+	for_each_cpu_and(cpu, used, mask)
+		weight++;
+
+	return weight;
+}
+
+/*
+ * Pick an unused online CPU for the next helper, spreading the helpers over
+ * the CPU clusters, and over the NUMA nodes first for NUMA aware jobs, so
+ * that they do not compete for the same caches and memory bandwidth.
+ */
+static int padata_mt_pick_cpu(struct padata_mt_job *job, struct cpumask *used)
+{
+	unsigned int load, best_load = UINT_MAX;
+	int cpu, best = -1;
+
+	for_each_online_cpu(cpu) {
+		if (cpumask_test_cpu(cpu, used))
+			continue;
+
+		load = padata_mt_weight(used, topology_cluster_cpumask(cpu));
+		if (job->numa_aware)
+			load += nr_cpu_ids *
+				padata_mt_weight(used, cpumask_of_node(cpu_to_node(cpu)));
+
+		if (load < best_load) {
+			best_load = load;
+			best = cpu;
+		}
+	}
+
+	if (best >= 0)
+		cpumask_set_cpu(best, used);
+
+	return best;
+}
+
+static void padata_mt_queue_works(struct padata_mt_job *job,
+				  struct list_head *works)
+{
+	struct padata_work *pw;
+	cpumask_var_t used;
+	int cpu;
+
+	if (!padata_mt_wq || !zalloc_cpumask_var(&used, GFP_KERNEL)) {
+		list_for_each_entry(pw, works, pw_list)
+			queue_work(system_unbound_wq, &pw->pw_work);
+		return;
+	}
+
+	/* The current thread participates in the job. */
+	cpumask_set_cpu(raw_smp_processor_id(), used);
+
+	cpus_read_lock();
+	list_for_each_entry(pw, works, pw_list) {
+		cpu = padata_mt_pick_cpu(job, used);
+		if (cpu >= 0)
+			queue_work_on(cpu, padata_mt_wq, &pw->pw_work);
+		else
+			queue_work(system_unbound_wq, &pw->pw_work);
+	}
+	cpus_read_unlock();
+
+	free_cpumask_var(used);
+}
+
 /**
  * padata_do_multithreaded - run a multithreaded job
  * @job: Description of the job.
  *
+ * The job is split between the current thread and up to @job->max_threads - 1
+ * helpers, each owning an equal part of it that it processes in chunks.
+ * Helpers that run out of work steal from the helper with the most work
+ * left, so that the job completes in about the same time on CPUs of
+ * different speed or load.
+ *
  * See the definition of struct padata_mt_job for more details.
+ *
+ * Context: Process context, may sleep.
  */
-void __init padata_do_multithreaded(struct padata_mt_job *job)
+void padata_do_multithreaded(struct padata_mt_job *job)
 {
 	/* In case threads finish at different times. */
 	static const unsigned long load_balance_factor = 4;
-	struct padata_work my_work, *pw;
+	struct padata_work my_work;
 	struct padata_mt_job_state ps;
+	unsigned long end, per_work;
 	LIST_HEAD(works);
-	int nworks;
+	int nworks, i;
+
+	might_sleep();
 
 	if (job->size == 0)
 		return;
@@ -494,17 +645,21 @@ void __init padata_do_multithreaded(struct padata_mt_job *job)
 	nworks = max(job->size / job->min_chunk, 1ul);
 	nworks = min(nworks, job->max_threads);
 
-	if (nworks == 1) {
+	ps.ranges = NULL;
+	if (nworks > 1)
+		ps.ranges = kcalloc(nworks, sizeof(*ps.ranges), GFP_KERNEL);
+
+	if (!ps.ranges) {
 		/* Single thread, no coordination needed, cut to the chase. */
 		job->thread_fn(job->start, job->start + job->size, job->fn_arg);
 		return;
 	}
 
-	spin_lock_init(&ps.lock);
 	init_completion(&ps.completion);
 	ps.job	       = job;
 	ps.nworks      = padata_work_alloc_mt(nworks, &ps, &works);
-	ps.nworks_fini = 0;
+	atomic_set(&ps.next_id, 0);
+	atomic_set(&ps.nworks_left, ps.nworks);
 
 	/*
 	 * Chunk size is the amount of work a helper does per call to the
@@ -516,8 +671,20 @@ void __init padata_do_multithreaded(struct padata_mt_job *job)
 	ps.chunk_size = max(ps.chunk_size, job->min_chunk);
 	ps.chunk_size = roundup(ps.chunk_size, job->align);
 
-	list_for_each_entry(pw, &works, pw_list)
-		queue_work(system_unbound_wq, &pw->pw_work);
+	/* Give each helper an equal, chunk aligned part of the job. */
+	end = job->start + job->size;
+	per_work = job->size / ps.nworks;
+	for (i = 0; i < ps.nworks; i++) {
+		struct padata_mt_range *r = &ps.ranges[i];
+
+		spin_lock_init(&r->lock);
+		r->start = i ? ps.ranges[i - 1].end : job->start;
+		r->end = i == ps.nworks - 1 ? end :
+			 min(roundup(job->start + (i + 1) * per_work,
+				     ps.chunk_size), end);
+	}
+
+	padata_mt_queue_works(job, &works);
 
 	/* Use the current thread, which saves starting a workqueue worker. */
 	padata_work_init(&my_work, padata_mt_helper, &ps, PADATA_WORK_ONSTACK);
@@ -528,7 +695,9 @@ void __init padata_do_multithreaded(struct padata_mt_job *job)
 
 	destroy_work_on_stack(&my_work.pw_work);
 	padata_works_free(&works);
+	kfree(ps.ranges);
 }
+EXPORT_SYMBOL_GPL(padata_do_multithreaded);
 
 static void __padata_list_init(struct padata_list *pd_list)
 {
@@ -1141,6 +1310,12 @@ void __init padata_init(void)
 	for (i = 0; i < possible_cpus; ++i)
 		list_add(&padata_works[i].pw_list, &padata_free_works);
 
+	/*
+	 * Multithreaded job helpers are placed on specific CPUs.  Without
+	 * this workqueue they fall back to system_unbound_wq.
+	 */
+	padata_mt_wq = alloc_workqueue("padata_mt", WQ_CPU_INTENSIVE, 0);
+
 	return;
 
 remove_dead_state:
@@ -28,6 +28,7 @@
 #include <linux/gfp.h>
 #include <linux/syscore_ops.h>
 #include <linux/ctype.h>
+#include <linux/moduleparam.h>
 #include <linux/genhd.h>
 #include <linux/ktime.h>
 #include <linux/security.h>
@@ -37,6 +38,7 @@
 
 
 static int nocompress;
+static char hib_comp_algo[8] = CONFIG_HIBERNATION_DEF_COMP;
 static int noresume;
 static int nohibernate;
 static int resume_wait;
@@ -751,7 +753,7 @@ int hibernate(void)
 		if (nocompress)
 			flags |= SF_NOCOMPRESS_MODE;
 		else
-		        flags |= SF_CRC32_MODE;
+		        flags |= SF_CRC32_MODE | hib_comp_flag(hib_comp_algo);
 
 		pm_pr_dbg("Writing hibernation image.\n");
 		error = swsusp_write(flags);
@@ -1334,6 +1336,38 @@ static int __init nohibernate_setup(char *str)
 	return 1;
 }
 
+static int hibernate_compressor_param_set(const char *compressor,
+					  const struct kernel_param *kp)
+{
+	int ret;
+
+	lock_system_sleep();
+	ret = hib_comp_flag(compressor);
+	if (ret >= 0)
+		ret = param_set_copystring(compressor, kp);
+	unlock_system_sleep();
+
+	if (ret < 0)
+		pr_debug("Cannot set specified compressor %s\n", compressor);
+
+	return ret < 0 ? ret : 0;
+}
+
+static const struct kernel_param_ops hibernate_compressor_param_ops = {
+	.set    = hibernate_compressor_param_set,
+	.get    = param_get_string,
+};
+
+static struct kparam_string hibernate_compressor_param_string = {
+	.maxlen = sizeof(hib_comp_algo),
+	.string = hib_comp_algo,
+};
+
+module_param_cb(compressor, &hibernate_compressor_param_ops,
+		&hibernate_compressor_param_string, 0644);
+MODULE_PARM_DESC(compressor,
+		 "Compression algorithm to be used with hibernation");
+
 __setup("noresume", noresume_setup);
 __setup("resume_offset=", resume_offset_setup);
 __setup("resume=", resume_setup);
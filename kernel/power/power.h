@@ -168,6 +168,9 @@ extern int swsusp_swap_in_use(void);
 #define SF_PLATFORM_MODE	1
 #define SF_NOCOMPRESS_MODE	2
 #define SF_CRC32_MODE	        4
+#define SF_COMPRESSION_ALG_LZ4	16
+#define SF_COMPRESSION_ALG_ZSTD	32
+#define SF_COMPRESSION_ALG_MASK	(SF_COMPRESSION_ALG_LZ4 | SF_COMPRESSION_ALG_ZSTD)
 
 /* kernel/power/hibernate.c */
 extern int swsusp_check(void);
@@ -175,6 +178,7 @@ extern void swsusp_free(void);
 extern int swsusp_read(unsigned int *flags_p);
 extern int swsusp_write(unsigned int flags);
 extern void swsusp_close(fmode_t);
+extern int hib_comp_flag(const char *name);
 #ifdef CONFIG_SUSPEND
 extern int swsusp_unmark(void);
 #endif
@@ -199,6 +203,13 @@ static inline int suspend_devices_and_enter(suspend_state_t state)
 }
 #endif /* !CONFIG_SUSPEND */
 
+#ifdef CONFIG_PM_RESUME_TIMING
+/* kernel/power/resume_timing.c */
+extern void pm_resume_timing_report(void);
+#else
+static inline void pm_resume_timing_report(void) {}
+#endif
+
 #ifdef CONFIG_PM_TEST_SUSPEND
 /* kernel/power/suspend_test.c */
 extern void suspend_test_start(void);
@@ -0,0 +1,464 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * kernel/power/resume_timing.c - Per-device system resume timing.
+ *
+ * Records how long every device resume callback takes during a system
+ * resume, and which of the device's superiors (its parent or one of its
+ * device link suppliers) it was the last one to wait for, so that the
+ * critical path through the resume of all devices can be reported.
+ *
+ * The data is collected from the device_pm_callback_start/end and
+ * suspend_resume tracepoints and exposed under
+ * /sys/kernel/debug/pm_resume_timing/.
+ */
+
+#define pr_fmt(fmt) "PM: resume timing: " fmt
+
+#include <linux/debugfs.h>
+#include <linux/device.h>
+#include <linux/hashtable.h>
+#include <linux/init.h>
+#include <linux/ktime.h>
+#include <linux/list.h>
+#include <linux/pm.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <trace/events/power.h>
+
+#include "power.h"
+
+#define PM_RT_MAX_RECORDS	1024
+#define PM_RT_HASH_BITS		8
+#define PM_RT_REPORT_TOP	5
+
+enum pm_rt_phase {
+	PM_RT_NOIRQ,
+	PM_RT_EARLY,
+	PM_RT_RESUME,
+	PM_RT_COMPLETE,
+	PM_RT_NR_PHASES,
+};
+
+static const char * const pm_rt_phase_actions[PM_RT_NR_PHASES] = {
+	[PM_RT_NOIRQ]		= "dpm_resume_noirq",
+	[PM_RT_EARLY]		= "dpm_resume_early",
+	[PM_RT_RESUME]		= "dpm_resume",
+	[PM_RT_COMPLETE]	= "dpm_complete",
+};
+
+/*
+ * struct pm_rt_record - resume timing of one device
+ * @node        - for membership in pm_rt_hash
+ * @dev         - the device, a reference is held until the next resume
+ * @cb_start    - start of the callback currently running, or 0
+ * @first_start - start of the first resume callback of the device
+ * @last_end    - end of the last resume callback of the device
+ * @phase_time  - time spent in the device's callbacks, per phase
+ * @crit        - superior that finished last before @dev's callback started
+ */
+struct pm_rt_record {
+	struct hlist_node node;
+	struct device *dev;
+	ktime_t cb_start;
+	ktime_t first_start;
+	ktime_t last_end;
+	ktime_t phase_time[PM_RT_NR_PHASES];
+	struct pm_rt_record *crit;
+};
+
+static DEFINE_SPINLOCK(pm_rt_lock);
+static DEFINE_HASHTABLE(pm_rt_hash, PM_RT_HASH_BITS);
+
+static struct pm_rt_record *pm_rt_records;
+static unsigned int pm_rt_nr_records;
+static unsigned int pm_rt_dropped;
+
+static int pm_rt_phase = -1;	/* phase being recorded, -1 if none */
+static ktime_t pm_rt_resume_start;
+static ktime_t pm_rt_resume_end;
+
+/*
+ * When set, every device taking part in a system suspend is switched to
+ * asynchronous suspend/resume, leaving the ordering entirely to the parent
+ * and device link dependencies that the PM core already waits for. The
+ * devices switched are remembered on pm_rt_async_devs, protected by
+ * pm_rt_lock, and switched back when the knob is cleared.
+ */
+static bool pm_rt_async_all;
+
+struct pm_rt_async_dev {
+	struct list_head node;
+	struct device *dev;
+};
+
+static LIST_HEAD(pm_rt_async_devs);
+
+static struct pm_rt_record *pm_rt_find(struct device *dev)
+{
+	struct pm_rt_record *rec;
+
+	hash_for_each_possible(pm_rt_hash, rec, node, (unsigned long)dev)
+		if (rec->dev == dev)
+			return rec;
+
+	return NULL;
+}
+
+static void pm_rt_reset(ktime_t now)
+{
+	unsigned int i, nr;
+
+	spin_lock_irq(&pm_rt_lock);
+	nr = pm_rt_nr_records;
+	hash_init(pm_rt_hash);
+	pm_rt_nr_records = 0;
+	pm_rt_dropped = 0;
+	pm_rt_resume_start = now;
+	pm_rt_resume_end = 0;
+	spin_unlock_irq(&pm_rt_lock);
+
+	/*
+	 * No resume callbacks run between dpm_complete() and the next
+	 * dpm_resume_noirq(), so the old records can't be reused under us.
+	 */
+	for (i = 0; i < nr; i++)
+		put_device(pm_rt_records[i].dev);
+}
+
+static void pm_rt_suspend_resume(void *data, const char *action, int val,
+				 bool start)
+{
+	int phase;
+
+	for (phase = 0; phase < PM_RT_NR_PHASES; phase++)
+		if (!strcmp(action, pm_rt_phase_actions[phase]))
+			break;
+
+	if (phase == PM_RT_NR_PHASES)
+		return;
+
+	if (start) {
+		if (phase == PM_RT_NOIRQ)
+			pm_rt_reset(ktime_get());
+		WRITE_ONCE(pm_rt_phase, phase);
+	} else if (phase == PM_RT_COMPLETE) {
+		WRITE_ONCE(pm_rt_phase, -1);
+		pm_rt_resume_end = ktime_get();
+	}
+}
+
+static void pm_rt_force_async(struct device *dev)
+{
+	struct pm_rt_async_dev *ad;
+	unsigned long flags;
+
+	if (dev->power.syscore || dev->power.async_suspend)
+		return;
+
+	ad = kmalloc(sizeof(*ad), GFP_ATOMIC);
+	if (!ad)
+		return;
+	ad->dev = get_device(dev);
+
+	spin_lock_irqsave(&dev->power.lock, flags);
+	dev->power.async_suspend = true;
+	spin_unlock_irqrestore(&dev->power.lock, flags);
+
+	spin_lock_irqsave(&pm_rt_lock, flags);
+	list_add_tail(&ad->node, &pm_rt_async_devs);
+	spin_unlock_irqrestore(&pm_rt_lock, flags);
+}
+
+/* Switch the devices forced by async_all back to synchronous suspend */
+static void pm_rt_restore_async(void)
+{
+	struct pm_rt_async_dev *ad, *tmp;
+	LIST_HEAD(list);
+
+	spin_lock_irq(&pm_rt_lock);
+	list_splice_init(&pm_rt_async_devs, &list);
+	spin_unlock_irq(&pm_rt_lock);
+
+	list_for_each_entry_safe(ad, tmp, &list, node) {
+		device_disable_async_suspend(ad->dev);
+		put_device(ad->dev);
+		kfree(ad);
+	}
+}
+
+static void pm_rt_callback_start(void *data, struct device *dev,
+				 const char *pm_ops, int event)
+{
+	struct pm_rt_record *rec;
+	unsigned long flags;
+
+	if (event & (PM_EVENT_SLEEP | PM_EVENT_FREEZE | PM_EVENT_QUIESCE)) {
+		if (READ_ONCE(pm_rt_async_all))
+			pm_rt_force_async(dev);
+		return;
+	}
+
+	if (READ_ONCE(pm_rt_phase) < 0)
+		return;
+
+	spin_lock_irqsave(&pm_rt_lock, flags);
+	rec = pm_rt_find(dev);
+	if (!rec) {
+		if (pm_rt_nr_records >= PM_RT_MAX_RECORDS) {
+			pm_rt_dropped++;
+			goto out;
+		}
+		rec = &pm_rt_records[pm_rt_nr_records++];
+		memset(rec, 0, sizeof(*rec));
+		rec->dev = get_device(dev);
+		hash_add(pm_rt_hash, &rec->node, (unsigned long)dev);
+	}
+	rec->cb_start = ktime_get();
+out:
+	spin_unlock_irqrestore(&pm_rt_lock, flags);
+}
+
+struct pm_rt_crit_data {
+	struct pm_rt_record *rec;
+	struct pm_rt_record *crit;
+};
+
+static int pm_rt_check_superior(struct device *sup, void *data)
+{
+	struct pm_rt_crit_data *cd = data;
+	struct pm_rt_record *srec;
+
+	srec = pm_rt_find(sup);
+	if (!srec || srec == cd->rec || !srec->last_end ||
+	    ktime_after(srec->last_end, cd->rec->cb_start))
+		return 0;
+
+	if (!cd->crit || ktime_after(srec->last_end, cd->crit->last_end))
+		cd->crit = srec;
+
+	return 0;
+}
+
+static int pm_rt_check_supplier(struct device *sup, void *data)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&pm_rt_lock, flags);
+	pm_rt_check_superior(sup, data);
+	spin_unlock_irqrestore(&pm_rt_lock, flags);
+
+	return 0;
+}
+
+static void pm_rt_callback_end(void *data, struct device *dev, int error)
+{
+	struct pm_rt_crit_data cd = { };
+	ktime_t now = ktime_get();
+	unsigned long flags;
+	int phase;
+
+	phase = READ_ONCE(pm_rt_phase);
+	if (phase < 0)
+		return;
+
+	spin_lock_irqsave(&pm_rt_lock, flags);
+	cd.rec = pm_rt_find(dev);
+	if (!cd.rec || !cd.rec->cb_start) {
+		spin_unlock_irqrestore(&pm_rt_lock, flags);
+		return;
+	}
+	if (dev->parent)
+		pm_rt_check_superior(dev->parent, &cd);
+	spin_unlock_irqrestore(&pm_rt_lock, flags);
+
+	device_for_each_supplier(dev, &cd, pm_rt_check_supplier);
+
+	spin_lock_irqsave(&pm_rt_lock, flags);
+	cd.rec->phase_time[phase] = ktime_add(cd.rec->phase_time[phase],
+					      ktime_sub(now, cd.rec->cb_start));
+	if (!cd.rec->first_start)
+		cd.rec->first_start = cd.rec->cb_start;
+	cd.rec->last_end = now;
+	if (cd.crit)
+		cd.rec->crit = cd.crit;
+	cd.rec->cb_start = 0;
+	spin_unlock_irqrestore(&pm_rt_lock, flags);
+}
+
+static ktime_t pm_rt_total(struct pm_rt_record *rec)
+{
+	ktime_t total = 0;
+	int phase;
+
+	for (phase = 0; phase < PM_RT_NR_PHASES; phase++)
+		total = ktime_add(total, rec->phase_time[phase]);
+
+	return total;
+}
+
+static struct pm_rt_record *pm_rt_last_to_finish(void)
+{
+	struct pm_rt_record *last = NULL;
+	unsigned int i;
+
+	for (i = 0; i < pm_rt_nr_records; i++)
+		if (!last || ktime_after(pm_rt_records[i].last_end,
+					 last->last_end))
+			last = &pm_rt_records[i];
+
+	return last;
+}
+
+static int pm_rt_devices_show(struct seq_file *s, void *unused)
+{
+	struct pm_rt_record *rec;
+	unsigned int i;
+	int phase;
+
+	spin_lock_irq(&pm_rt_lock);
+	seq_printf(s, "%-32s %10s %10s %10s %10s %10s %10s %s\n", "device",
+		   "noirq_us", "early_us", "resume_us", "complete_us",
+		   "total_us", "start_us", "waited_for");
+	for (i = 0; i < pm_rt_nr_records; i++) {
+		rec = &pm_rt_records[i];
+		seq_printf(s, "%-32s", dev_name(rec->dev));
+		for (phase = 0; phase < PM_RT_NR_PHASES; phase++)
+			seq_printf(s, " %10lld",
+				   ktime_to_us(rec->phase_time[phase]));
+		seq_printf(s, " %10lld %10lld %s\n",
+			   ktime_to_us(pm_rt_total(rec)),
+			   ktime_us_delta(rec->first_start,
+					  pm_rt_resume_start),
+			   rec->crit ? dev_name(rec->crit->dev) : "-");
+	}
+	if (pm_rt_dropped)
+		seq_printf(s, "# %u devices not recorded\n", pm_rt_dropped);
+	spin_unlock_irq(&pm_rt_lock);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(pm_rt_devices);
+
+static int pm_rt_critical_path_show(struct seq_file *s, void *unused)
+{
+	struct pm_rt_record *rec;
+	unsigned int n = 0;
+
+	spin_lock_irq(&pm_rt_lock);
+	if (pm_rt_resume_end)
+		seq_printf(s, "resume: %lld us\n",
+			   ktime_us_delta(pm_rt_resume_end,
+					  pm_rt_resume_start));
+	for (rec = pm_rt_last_to_finish(); rec && n < pm_rt_nr_records;
+	     rec = rec->crit, n++)
+		seq_printf(s, "%-32s end %10lld us, callbacks %10lld us\n",
+			   dev_name(rec->dev),
+			   ktime_us_delta(rec->last_end, pm_rt_resume_start),
+			   ktime_to_us(pm_rt_total(rec)));
+	spin_unlock_irq(&pm_rt_lock);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(pm_rt_critical_path);
+
+/**
+ * pm_resume_timing_report - Log a summary of the last system resume.
+ *
+ * Prints the overall device resume time, the slowest devices and the
+ * length of the critical path.
+ */
+void pm_resume_timing_report(void)
+{
+	struct pm_rt_record *top[PM_RT_REPORT_TOP] = { };
+	struct pm_rt_record *rec;
+	unsigned int i, j, n = 0;
+	ktime_t sum = 0;
+
+	spin_lock_irq(&pm_rt_lock);
+	for (i = 0; i < pm_rt_nr_records; i++) {
+		rec = &pm_rt_records[i];
+		sum = ktime_add(sum, pm_rt_total(rec));
+		for (j = 0; j < PM_RT_REPORT_TOP; j++) {
+			if (!top[j] ||
+			    ktime_after(pm_rt_total(rec), pm_rt_total(top[j]))) {
+				memmove(&top[j + 1], &top[j],
+					(PM_RT_REPORT_TOP - j - 1) * sizeof(*top));
+				top[j] = rec;
+				break;
+			}
+		}
+	}
+
+	pr_info("%u devices resumed in %lld us, %lld us in callbacks\n",
+		pm_rt_nr_records,
+		ktime_us_delta(pm_rt_resume_end, pm_rt_resume_start),
+		ktime_to_us(sum));
+	for (j = 0; j < PM_RT_REPORT_TOP && top[j]; j++)
+		pr_info("  %s: %lld us\n", dev_name(top[j]->dev),
+			ktime_to_us(pm_rt_total(top[j])));
+
+	for (rec = pm_rt_last_to_finish(); rec && n < pm_rt_nr_records;
+	     rec = rec->crit)
+		n++;
+	pr_info("critical path: %u devices\n", n);
+	spin_unlock_irq(&pm_rt_lock);
+}
+
+static int pm_rt_async_all_get(void *data, u64 *val)
+{
+	*val = READ_ONCE(pm_rt_async_all);
+	return 0;
+}
+
+static int pm_rt_async_all_set(void *data, u64 val)
+{
+	WRITE_ONCE(pm_rt_async_all, !!val);
+	if (!val)
+		pm_rt_restore_async();
+	return 0;
+}
+DEFINE_DEBUGFS_ATTRIBUTE(pm_rt_async_all_fops, pm_rt_async_all_get,
+			 pm_rt_async_all_set, "%llu\n");
+
+static int __init pm_resume_timing_init(void)
+{
+	struct dentry *dir;
+	int ret;
+
+	pm_rt_records = kcalloc(PM_RT_MAX_RECORDS, sizeof(*pm_rt_records),
+				GFP_KERNEL);
+	if (!pm_rt_records)
+		return -ENOMEM;
+
+	ret = register_trace_suspend_resume(pm_rt_suspend_resume, NULL);
+	if (ret)
+		goto err_free;
+	ret = register_trace_device_pm_callback_start(pm_rt_callback_start,
+						      NULL);
+	if (ret)
+		goto err_suspend_resume;
+	ret = register_trace_device_pm_callback_end(pm_rt_callback_end, NULL);
+	if (ret)
+		goto err_callback_start;
+
+	dir = debugfs_create_dir("pm_resume_timing", NULL);
+	debugfs_create_file("devices", 0444, dir, NULL, &pm_rt_devices_fops);
+	debugfs_create_file("critical_path", 0444, dir, NULL,
+			    &pm_rt_critical_path_fops);
+	debugfs_create_file_unsafe("async_all", 0644, dir, NULL,
+				   &pm_rt_async_all_fops);
+
+	return 0;
+
+err_callback_start:
+	unregister_trace_device_pm_callback_start(pm_rt_callback_start, NULL);
+err_suspend_resume:
+	unregister_trace_suspend_resume(pm_rt_suspend_resume, NULL);
+err_free:
+	kfree(pm_rt_records);
+	pm_rt_records = NULL;
+	return ret;
+}
+fs_initcall(pm_resume_timing_init);
@@ -112,6 +112,8 @@ static void __init test_wakealarm(struct rtc_device *rtc, suspend_state_t state)
 
 	if (status < 0)
 		printk(err_suspend, status);
+	else
+		pm_resume_timing_report();
 
 	test_repeat_count_current++;
 	if (test_repeat_count_current < test_repeat_count_max)
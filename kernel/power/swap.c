@@ -25,6 +25,8 @@
 #include <linux/pm.h>
 #include <linux/slab.h>
 #include <linux/lzo.h>
+#include <linux/lz4.h>
+#include <linux/zstd.h>
 #include <linux/vmalloc.h>
 #include <linux/cpumask.h>
 #include <linux/atomic.h>
@@ -512,24 +514,216 @@ static int swap_writer_finish(struct swap_map_handle *handle,
 }
 
 /* We need to remember how much compressed data we need to read. */
-#define LZO_HEADER	sizeof(size_t)
+#define CMP_HEADER	sizeof(size_t)
 
 /* Number of pages/bytes we'll compress at one time. */
-#define LZO_UNC_PAGES	32
-#define LZO_UNC_SIZE	(LZO_UNC_PAGES * PAGE_SIZE)
+#define UNC_PAGES	32
+#define UNC_SIZE	(UNC_PAGES * PAGE_SIZE)
 
-/* Number of pages/bytes we need for compressed data (worst case). */
-#define LZO_CMP_PAGES	DIV_ROUND_UP(lzo1x_worst_compress(LZO_UNC_SIZE) + \
-			             LZO_HEADER, PAGE_SIZE)
-#define LZO_CMP_SIZE	(LZO_CMP_PAGES * PAGE_SIZE)
+/*
+ * Number of pages/bytes we need for compressed data (worst case). The LZO
+ * bound is the largest of the supported compressors, so it covers them all.
+ */
+#define CMP_PAGES	DIV_ROUND_UP(lzo1x_worst_compress(UNC_SIZE) + \
+			             CMP_HEADER, PAGE_SIZE)
+#define CMP_SIZE	(CMP_PAGES * PAGE_SIZE)
 
 /* Maximum number of threads for compression/decompression. */
-#define LZO_THREADS	3
+#define CMP_THREADS	8
 
 /* Minimum/maximum number of pages for read buffering. */
-#define LZO_MIN_RD_PAGES	1024
-#define LZO_MAX_RD_PAGES	8192
+#define CMP_MIN_RD_PAGES	1024
+#define CMP_MAX_RD_PAGES	16384
 
+/* Compression level used for zstd images. */
+#define HIB_ZSTD_LEVEL	3
+
+/**
+ * struct hib_comp_ops - Hibernation image compressor.
+ * @name: Name used by the hibernate.compressor= parameter.
+ * @flag: SF_COMPRESSION_ALG_* flag recorded in the image header.
+ * @cmp_wrk_size: Size of the per-thread compression workspace.
+ * @dec_wrk_size: Size of the per-thread decompression workspace.
+ * @compress: Compress @src_len bytes; @dst_len holds the capacity on entry.
+ * @decompress: Decompress @src_len bytes; @dst_len holds the capacity on entry.
+ */
+struct hib_comp_ops {
+	const char *name;
+	unsigned int flag;
+	size_t (*cmp_wrk_size)(void);
+	size_t (*dec_wrk_size)(void);
+	int (*compress)(const unsigned char *src, size_t src_len,
+			unsigned char *dst, size_t *dst_len, void *wrk);
+	int (*decompress)(const unsigned char *src, size_t src_len,
+			  unsigned char *dst, size_t *dst_len, void *wrk);
+};
+
+static size_t hib_lzo_cmp_wrk_size(void)
+{
+	return LZO1X_1_MEM_COMPRESS;
+}
+
+static int hib_lzo_compress(const unsigned char *src, size_t src_len,
+			    unsigned char *dst, size_t *dst_len, void *wrk)
+{
+	return lzo1x_1_compress(src, src_len, dst, dst_len, wrk);
+}
+
+static int hib_lzo_decompress(const unsigned char *src, size_t src_len,
+			      unsigned char *dst, size_t *dst_len, void *wrk)
+{
+	return lzo1x_decompress_safe(src, src_len, dst, dst_len);
+}
+
+#ifdef CONFIG_HIBERNATION_COMP_LZ4
+static size_t hib_lz4_cmp_wrk_size(void)
+{
+	return LZ4_MEM_COMPRESS;
+}
+
+static int hib_lz4_compress(const unsigned char *src, size_t src_len,
+			    unsigned char *dst, size_t *dst_len, void *wrk)
+{
+	int ret;
+
+	ret = LZ4_compress_fast(src, dst, src_len, *dst_len,
+				LZ4_ACCELERATION_DEFAULT, wrk);
+	if (!ret)
+		return -EINVAL;
+
+	*dst_len = ret;
+	return 0;
+}
+
+static int hib_lz4_decompress(const unsigned char *src, size_t src_len,
+			      unsigned char *dst, size_t *dst_len, void *wrk)
+{
+	int ret;
+
+	ret = LZ4_decompress_safe(src, dst, src_len, *dst_len);
+	if (ret < 0)
+		return -EINVAL;
+
+	*dst_len = ret;
+	return 0;
+}
+#endif
+
+#ifdef CONFIG_HIBERNATION_COMP_ZSTD
+static size_t hib_zstd_cmp_wrk_size(void)
+{
+	ZSTD_parameters params = ZSTD_getParams(HIB_ZSTD_LEVEL, UNC_SIZE, 0);
+
+	return ZSTD_CCtxWorkspaceBound(params.cParams);
+}
+
+static size_t hib_zstd_dec_wrk_size(void)
+{
+	return ZSTD_DCtxWorkspaceBound();
+}
+
+static int hib_zstd_compress(const unsigned char *src, size_t src_len,
+			     unsigned char *dst, size_t *dst_len, void *wrk)
+{
+	ZSTD_parameters params = ZSTD_getParams(HIB_ZSTD_LEVEL, UNC_SIZE, 0);
+	ZSTD_CCtx *cctx;
+	size_t ret;
+
+	cctx = ZSTD_initCCtx(wrk, hib_zstd_cmp_wrk_size());
+	if (!cctx)
+		return -EINVAL;
+
+	ret = ZSTD_compressCCtx(cctx, dst, *dst_len, src, src_len, params);
+	if (ZSTD_isError(ret))
+		return -EINVAL;
+
+	*dst_len = ret;
+	return 0;
+}
+
+static int hib_zstd_decompress(const unsigned char *src, size_t src_len,
+			       unsigned char *dst, size_t *dst_len, void *wrk)
+{
+	ZSTD_DCtx *dctx;
+	size_t ret;
+
+	dctx = ZSTD_initDCtx(wrk, hib_zstd_dec_wrk_size());
+	if (!dctx)
+		return -EINVAL;
+
+	ret = ZSTD_decompressDCtx(dctx, dst, *dst_len, src, src_len);
+	if (ZSTD_isError(ret))
+		return -EINVAL;
+
+	*dst_len = ret;
+	return 0;
+}
+#endif
+
+static const struct hib_comp_ops hib_comp_algos[] = {
+	{
+		.name		= "lzo",
+		.flag		= 0,
+		.cmp_wrk_size	= hib_lzo_cmp_wrk_size,
+		.compress	= hib_lzo_compress,
+		.decompress	= hib_lzo_decompress,
+	},
+#ifdef CONFIG_HIBERNATION_COMP_LZ4
+	{
+		.name		= "lz4",
+		.flag		= SF_COMPRESSION_ALG_LZ4,
+		.cmp_wrk_size	= hib_lz4_cmp_wrk_size,
+		.compress	= hib_lz4_compress,
+		.decompress	= hib_lz4_decompress,
+	},
+#endif
+#ifdef CONFIG_HIBERNATION_COMP_ZSTD
+	{
+		.name		= "zstd",
+		.flag		= SF_COMPRESSION_ALG_ZSTD,
+		.cmp_wrk_size	= hib_zstd_cmp_wrk_size,
+		.dec_wrk_size	= hib_zstd_dec_wrk_size,
+		.compress	= hib_zstd_compress,
+		.decompress	= hib_zstd_decompress,
+	},
+#endif
+};
+
+/**
+ * hib_comp_flag - Look up the image header flag of a compressor.
+ * @name: Compressor name.
+ *
+ * Return the SF_COMPRESSION_ALG_* flag for @name, or a negative error code
+ * if no such compressor is built in.
+ */
+int hib_comp_flag(const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(hib_comp_algos); i++)
+		if (sysfs_streq(name, hib_comp_algos[i].name))
+			return hib_comp_algos[i].flag;
+
+	return -EINVAL;
+}
+
+static const struct hib_comp_ops *hib_comp_by_flags(unsigned int flags)
+{
+	unsigned int i;
+
+	flags &= SF_COMPRESSION_ALG_MASK;
+	for (i = 0; i < ARRAY_SIZE(hib_comp_algos); i++)
+		if (hib_comp_algos[i].flag == flags)
+			return &hib_comp_algos[i];
+
+	return NULL;
+}
+
+static void *hib_comp_wrk_alloc(size_t (*wrk_size)(void))
+{
+	/* Keep a valid pointer for compressors that need no workspace. */
+	return vmalloc(wrk_size ? wrk_size() : 1);
+}
 
 /**
  *	save_image - save the suspend image data
@@ -590,8 +784,8 @@ struct crc_data {
 	wait_queue_head_t go;                     /* start crc update */
 	wait_queue_head_t done;                   /* crc update done */
 	u32 *crc32;                               /* points to handle's crc32 */
-	size_t *unc_len[LZO_THREADS];             /* uncompressed lengths */
-	unsigned char *unc[LZO_THREADS];          /* uncompressed data */
+	size_t *unc_len[CMP_THREADS];             /* uncompressed lengths */
+	unsigned char *unc[CMP_THREADS];          /* uncompressed data */
 };
 
 /**
@@ -622,7 +816,7 @@ static int crc32_threadfn(void *data)
 	return 0;
 }
 /**
- * Structure used for LZO data compression.
+ * Structure used for data compression.
  */
 struct cmp_data {
 	struct task_struct *thr;                  /* thread */
@@ -633,15 +827,16 @@ struct cmp_data {
 	wait_queue_head_t done;                   /* compression done */
 	size_t unc_len;                           /* uncompressed length */
 	size_t cmp_len;                           /* compressed length */
-	unsigned char unc[LZO_UNC_SIZE];          /* uncompressed buffer */
-	unsigned char cmp[LZO_CMP_SIZE];          /* compressed buffer */
-	unsigned char wrk[LZO1X_1_MEM_COMPRESS];  /* compression workspace */
+	const struct hib_comp_ops *ops;           /* compressor */
+	void *wrk;                                /* compression workspace */
+	unsigned char unc[UNC_SIZE];              /* uncompressed buffer */
+	unsigned char cmp[CMP_SIZE];              /* compressed buffer */
 };
 
 /**
  * Compression function that runs in its own thread.
  */
-static int lzo_compress_threadfn(void *data)
+static int compress_threadfn(void *data)
 {
 	struct cmp_data *d = data;
 
@@ -657,8 +852,9 @@ static int lzo_compress_threadfn(void *data)
 		}
 		atomic_set(&d->ready, 0);
 
-		d->ret = lzo1x_1_compress(d->unc, d->unc_len,
-		                          d->cmp + LZO_HEADER, &d->cmp_len,
+		d->cmp_len = CMP_SIZE - CMP_HEADER;
+		d->ret = d->ops->compress(d->unc, d->unc_len,
+		                          d->cmp + CMP_HEADER, &d->cmp_len,
 		                          d->wrk);
 		atomic_set(&d->stop, 1);
 		wake_up(&d->done);
@@ -667,14 +863,16 @@ static int lzo_compress_threadfn(void *data)
 }
 
 /**
- * save_image_lzo - Save the suspend image data compressed with LZO.
+ * save_compressed_image - Save the suspend image data in compressed form.
  * @handle: Swap map handle to use for saving the image.
  * @snapshot: Image to read data from.
  * @nr_to_write: Number of pages to save.
+ * @flags: Image header flags, selecting the compressor.
  */
-static int save_image_lzo(struct swap_map_handle *handle,
-                          struct snapshot_handle *snapshot,
-                          unsigned int nr_to_write)
+static int save_compressed_image(struct swap_map_handle *handle,
+                                 struct snapshot_handle *snapshot,
+                                 unsigned int nr_to_write,
+                                 unsigned int flags)
 {
 	unsigned int m;
 	int ret = 0;
@@ -688,31 +886,46 @@ static int save_image_lzo(struct swap_map_handle *handle,
 	unsigned char *page = NULL;
 	struct cmp_data *data = NULL;
 	struct crc_data *crc = NULL;
+	const struct hib_comp_ops *ops;
 
 	hib_init_batch(&hb);
 
+	ops = hib_comp_by_flags(flags);
+	if (!ops) {
+		pr_err("Unsupported image compressor\n");
+		ret = -EINVAL;
+		goto out_clean;
+	}
+
 	/*
-	 * We'll limit the number of threads for compression to limit memory
+	 * Use one thread per online CPU but one, limited to bound the memory
 	 * footprint.
 	 */
 	nr_threads = num_online_cpus() - 1;
-	nr_threads = clamp_val(nr_threads, 1, LZO_THREADS);
+	nr_threads = clamp_val(nr_threads, 1, CMP_THREADS);
 
 	page = (void *)__get_free_page(GFP_NOIO | __GFP_HIGH);
 	if (!page) {
-		pr_err("Failed to allocate LZO page\n");
+		pr_err("Failed to allocate %s page\n", ops->name);
 		ret = -ENOMEM;
 		goto out_clean;
 	}
 
-	data = vmalloc(array_size(nr_threads, sizeof(*data)));
+	data = vzalloc(array_size(nr_threads, sizeof(*data)));
 	if (!data) {
-		pr_err("Failed to allocate LZO data\n");
+		pr_err("Failed to allocate %s data\n", ops->name);
 		ret = -ENOMEM;
 		goto out_clean;
 	}
-	for (thr = 0; thr < nr_threads; thr++)
-		memset(&data[thr], 0, offsetof(struct cmp_data, go));
+	for (thr = 0; thr < nr_threads; thr++) {
+		data[thr].ops = ops;
+		data[thr].wrk = hib_comp_wrk_alloc(ops->cmp_wrk_size);
+		if (!data[thr].wrk) {
+			pr_err("Failed to allocate %s workspace\n", ops->name);
+			ret = -ENOMEM;
+			goto out_clean;
+		}
+	}
 
 	crc = kmalloc(sizeof(*crc), GFP_KERNEL);
 	if (!crc) {
@@ -729,7 +942,7 @@ static int save_image_lzo(struct swap_map_handle *handle,
 		init_waitqueue_head(&data[thr].go);
 		init_waitqueue_head(&data[thr].done);
 
-		data[thr].thr = kthread_run(lzo_compress_threadfn,
+		data[thr].thr = kthread_run(compress_threadfn,
 		                            &data[thr],
 		                            "image_compress/%u", thr);
 		if (IS_ERR(data[thr].thr)) {
@@ -767,7 +980,8 @@ static int save_image_lzo(struct swap_map_handle *handle,
 	 */
 	handle->reqd_free_pages = reqd_free_pages();
 
-	pr_info("Using %u thread(s) for compression\n", nr_threads);
+	pr_info("Using %u thread(s) for %s compression\n",
+		nr_threads, ops->name);
 	pr_info("Compressing and saving image data (%u pages)...\n",
 		nr_to_write);
 	m = nr_to_write / 10;
@@ -777,7 +991,7 @@ static int save_image_lzo(struct swap_map_handle *handle,
 	start = ktime_get();
 	for (;;) {
 		for (thr = 0; thr < nr_threads; thr++) {
-			for (off = 0; off < LZO_UNC_SIZE; off += PAGE_SIZE) {
+			for (off = 0; off < UNC_SIZE; off += PAGE_SIZE) {
 				ret = snapshot_read_next(snapshot);
 				if (ret < 0)
 					goto out_finish;
@@ -817,14 +1031,15 @@ static int save_image_lzo(struct swap_map_handle *handle,
 			ret = data[thr].ret;
 
 			if (ret < 0) {
-				pr_err("LZO compression failed\n");
+				pr_err("%s compression failed\n", ops->name);
 				goto out_finish;
 			}
 
 			if (unlikely(!data[thr].cmp_len ||
 			             data[thr].cmp_len >
 			             lzo1x_worst_compress(data[thr].unc_len))) {
-				pr_err("Invalid LZO compressed length\n");
+				pr_err("Invalid %s compressed length\n",
+				       ops->name);
 				ret = -1;
 				goto out_finish;
 			}
@@ -840,7 +1055,7 @@ static int save_image_lzo(struct swap_map_handle *handle,
 			 * read it.
 			 */
 			for (off = 0;
-			     off < LZO_HEADER + data[thr].cmp_len;
+			     off < CMP_HEADER + data[thr].cmp_len;
 			     off += PAGE_SIZE) {
 				memcpy(page, data[thr].cmp + off, PAGE_SIZE);
 
@@ -870,9 +1085,11 @@ static int save_image_lzo(struct swap_map_handle *handle,
 		kfree(crc);
 	}
 	if (data) {
-		for (thr = 0; thr < nr_threads; thr++)
+		for (thr = 0; thr < nr_threads; thr++) {
 			if (data[thr].thr)
 				kthread_stop(data[thr].thr);
+			vfree(data[thr].wrk);
+		}
 		vfree(data);
 	}
 	if (page) free_page((unsigned long)page);
@@ -942,7 +1159,8 @@ int swsusp_write(unsigned int flags)
 	if (!error) {
 		error = (flags & SF_NOCOMPRESS_MODE) ?
 			save_image(&handle, &snapshot, pages - 1) :
-			save_image_lzo(&handle, &snapshot, pages - 1);
+			save_compressed_image(&handle, &snapshot, pages - 1,
+					      flags);
 	}
 out_finish:
 	error = swap_writer_finish(&handle, flags, error);
@@ -1109,7 +1327,7 @@ static int load_image(struct swap_map_handle *handle,
 }
 
 /**
- * Structure used for LZO data decompression.
+ * Structure used for data decompression.
  */
 struct dec_data {
 	struct task_struct *thr;                  /* thread */
@@ -1120,14 +1338,16 @@ struct dec_data {
 	wait_queue_head_t done;                   /* decompression done */
 	size_t unc_len;                           /* uncompressed length */
 	size_t cmp_len;                           /* compressed length */
-	unsigned char unc[LZO_UNC_SIZE];          /* uncompressed buffer */
-	unsigned char cmp[LZO_CMP_SIZE];          /* compressed buffer */
+	const struct hib_comp_ops *ops;           /* decompressor */
+	void *wrk;                                /* decompression workspace */
+	unsigned char unc[UNC_SIZE];              /* uncompressed buffer */
+	unsigned char cmp[CMP_SIZE];              /* compressed buffer */
 };
 
 /**
  * Deompression function that runs in its own thread.
  */
-static int lzo_decompress_threadfn(void *data)
+static int decompress_threadfn(void *data)
 {
 	struct dec_data *d = data;
 
@@ -1143,9 +1363,9 @@ static int lzo_decompress_threadfn(void *data)
 		}
 		atomic_set(&d->ready, 0);
 
-		d->unc_len = LZO_UNC_SIZE;
-		d->ret = lzo1x_decompress_safe(d->cmp + LZO_HEADER, d->cmp_len,
-		                               d->unc, &d->unc_len);
+		d->unc_len = UNC_SIZE;
+		d->ret = d->ops->decompress(d->cmp + CMP_HEADER, d->cmp_len,
+		                            d->unc, &d->unc_len, d->wrk);
 		if (clean_pages_on_decompress)
 			flush_icache_range((unsigned long)d->unc,
 					   (unsigned long)d->unc + d->unc_len);
@@ -1157,14 +1377,60 @@ static int lzo_decompress_threadfn(void *data)
 }
 
 /**
- * load_image_lzo - Load compressed image data and decompress them with LZO.
+ * read_ahead - Queue reads of compressed image pages into the read ring.
+ * @handle: Swap map handle to read from.
+ * @page: Read ring.
+ * @ring: Next ring slot to fill, updated.
+ * @ring_size: Number of slots in @page.
+ * @want: Number of free slots, updated.
+ * @asked: Number of reads in flight, updated.
+ * @eof: Set to 1 once the end of the image data has been reached.
+ * @hb: Bio batch the reads are submitted on.
+ *
+ * Called both before and after handing data to the decompression threads, so
+ * the device keeps reading while the threads are busy.
+ */
+static int read_ahead(struct swap_map_handle *handle, unsigned char **page,
+		      unsigned *ring, unsigned ring_size, unsigned *want,
+		      unsigned *asked, int *eof, struct hib_bio_batch *hb)
+{
+	unsigned i;
+	int ret;
+
+	for (i = 0; !*eof && i < *want; i++) {
+		ret = swap_read_page(handle, page[*ring], hb);
+		if (ret) {
+			/*
+			 * On real read error, finish. On end of data,
+			 * set EOF flag and just exit the read loop.
+			 */
+			if (handle->cur &&
+			    handle->cur->entries[handle->k])
+				return ret;
+
+			*eof = 1;
+			break;
+		}
+		if (++*ring >= ring_size)
+			*ring = 0;
+	}
+	*asked += i;
+	*want -= i;
+
+	return 0;
+}
+
+/**
+ * load_compressed_image - Load compressed image data and decompress it.
  * @handle: Swap map handle to use for loading data.
  * @snapshot: Image to copy uncompressed data into.
  * @nr_to_read: Number of pages to load.
+ * @flags: Image header flags, selecting the decompressor.
  */
-static int load_image_lzo(struct swap_map_handle *handle,
-                          struct snapshot_handle *snapshot,
-                          unsigned int nr_to_read)
+static int load_compressed_image(struct swap_map_handle *handle,
+                                 struct snapshot_handle *snapshot,
+                                 unsigned int nr_to_read,
+                                 unsigned int flags)
 {
 	unsigned int m;
 	int ret = 0;
@@ -1172,7 +1438,8 @@ static int load_image_lzo(struct swap_map_handle *handle,
 	struct hib_bio_batch hb;
 	ktime_t start;
 	ktime_t stop;
-	unsigned nr_pages;
+	ktime_t io_time = 0, dec_time = 0, t;
+	unsigned nr_pages, nr_cmp_pages = 0;
 	size_t off;
 	unsigned i, thr, run_threads, nr_threads;
 	unsigned ring = 0, pg = 0, ring_size = 0,
@@ -1181,31 +1448,46 @@ static int load_image_lzo(struct swap_map_handle *handle,
 	unsigned char **page = NULL;
 	struct dec_data *data = NULL;
 	struct crc_data *crc = NULL;
+	const struct hib_comp_ops *ops;
 
 	hib_init_batch(&hb);
 
+	ops = hib_comp_by_flags(flags);
+	if (!ops) {
+		pr_err("Image compressor not supported by this kernel\n");
+		ret = -EINVAL;
+		goto out_clean;
+	}
+
 	/*
-	 * We'll limit the number of threads for decompression to limit memory
+	 * Use one thread per online CPU but one, limited to bound the memory
 	 * footprint.
 	 */
 	nr_threads = num_online_cpus() - 1;
-	nr_threads = clamp_val(nr_threads, 1, LZO_THREADS);
+	nr_threads = clamp_val(nr_threads, 1, CMP_THREADS);
 
-	page = vmalloc(array_size(LZO_MAX_RD_PAGES, sizeof(*page)));
+	page = vmalloc(array_size(CMP_MAX_RD_PAGES, sizeof(*page)));
 	if (!page) {
-		pr_err("Failed to allocate LZO page\n");
+		pr_err("Failed to allocate %s page\n", ops->name);
 		ret = -ENOMEM;
 		goto out_clean;
 	}
 
-	data = vmalloc(array_size(nr_threads, sizeof(*data)));
+	data = vzalloc(array_size(nr_threads, sizeof(*data)));
 	if (!data) {
-		pr_err("Failed to allocate LZO data\n");
+		pr_err("Failed to allocate %s data\n", ops->name);
 		ret = -ENOMEM;
 		goto out_clean;
 	}
-	for (thr = 0; thr < nr_threads; thr++)
-		memset(&data[thr], 0, offsetof(struct dec_data, go));
+	for (thr = 0; thr < nr_threads; thr++) {
+		data[thr].ops = ops;
+		data[thr].wrk = hib_comp_wrk_alloc(ops->dec_wrk_size);
+		if (!data[thr].wrk) {
+			pr_err("Failed to allocate %s workspace\n", ops->name);
+			ret = -ENOMEM;
+			goto out_clean;
+		}
+	}
 
 	crc = kmalloc(sizeof(*crc), GFP_KERNEL);
 	if (!crc) {
@@ -1224,7 +1506,7 @@ static int load_image_lzo(struct swap_map_handle *handle,
 		init_waitqueue_head(&data[thr].go);
 		init_waitqueue_head(&data[thr].done);
 
-		data[thr].thr = kthread_run(lzo_decompress_threadfn,
+		data[thr].thr = kthread_run(decompress_threadfn,
 		                            &data[thr],
 		                            "image_decompress/%u", thr);
 		if (IS_ERR(data[thr].thr)) {
@@ -1265,18 +1547,19 @@ static int load_image_lzo(struct swap_map_handle *handle,
 	 */
 	if (low_free_pages() > snapshot_get_image_size())
 		read_pages = (low_free_pages() - snapshot_get_image_size()) / 2;
-	read_pages = clamp_val(read_pages, LZO_MIN_RD_PAGES, LZO_MAX_RD_PAGES);
+	read_pages = clamp_val(read_pages, CMP_MIN_RD_PAGES, CMP_MAX_RD_PAGES);
 
 	for (i = 0; i < read_pages; i++) {
-		page[i] = (void *)__get_free_page(i < LZO_CMP_PAGES ?
+		page[i] = (void *)__get_free_page(i < CMP_PAGES ?
 						  GFP_NOIO | __GFP_HIGH :
 						  GFP_NOIO | __GFP_NOWARN |
 						  __GFP_NORETRY);
 
 		if (!page[i]) {
-			if (i < LZO_CMP_PAGES) {
+			if (i < CMP_PAGES) {
 				ring_size = i;
-				pr_err("Failed to allocate LZO pages\n");
+				pr_err("Failed to allocate %s pages\n",
+				       ops->name);
 				ret = -ENOMEM;
 				goto out_clean;
 			} else {
@@ -1286,7 +1569,8 @@ static int load_image_lzo(struct swap_map_handle *handle,
 	}
 	want = ring_size = i;
 
-	pr_info("Using %u thread(s) for decompression\n", nr_threads);
+	pr_info("Using %u thread(s) for %s decompression\n",
+		nr_threads, ops->name);
 	pr_info("Loading and decompressing image data (%u pages)...\n",
 		nr_to_read);
 	m = nr_to_read / 10;
@@ -1300,26 +1584,10 @@ static int load_image_lzo(struct swap_map_handle *handle,
 		goto out_finish;
 
 	for(;;) {
-		for (i = 0; !eof && i < want; i++) {
-			ret = swap_read_page(handle, page[ring], &hb);
-			if (ret) {
-				/*
-				 * On real read error, finish. On end of data,
-				 * set EOF flag and just exit the read loop.
-				 */
-				if (handle->cur &&
-				    handle->cur->entries[handle->k]) {
-					goto out_finish;
-				} else {
-					eof = 1;
-					break;
-				}
-			}
-			if (++ring >= ring_size)
-				ring = 0;
-		}
-		asked += i;
-		want -= i;
+		ret = read_ahead(handle, page, &ring, ring_size, &want,
+				 &asked, &eof, &hb);
+		if (ret)
+			goto out_finish;
 
 		/*
 		 * We are out of data, wait for some more.
@@ -1328,10 +1596,13 @@ static int load_image_lzo(struct swap_map_handle *handle,
 			if (!asked)
 				break;
 
+			t = ktime_get();
 			ret = hib_wait_io(&hb);
+			io_time = ktime_add(io_time, ktime_sub(ktime_get(), t));
 			if (ret)
 				goto out_finish;
 			have += asked;
+			nr_cmp_pages += asked;
 			asked = 0;
 			if (eof)
 				eof = 2;
@@ -1347,13 +1618,14 @@ static int load_image_lzo(struct swap_map_handle *handle,
 			data[thr].cmp_len = *(size_t *)page[pg];
 			if (unlikely(!data[thr].cmp_len ||
 			             data[thr].cmp_len >
-			             lzo1x_worst_compress(LZO_UNC_SIZE))) {
-				pr_err("Invalid LZO compressed length\n");
+			             lzo1x_worst_compress(UNC_SIZE))) {
+				pr_err("Invalid %s compressed length\n",
+				       ops->name);
 				ret = -1;
 				goto out_finish;
 			}
 
-			need = DIV_ROUND_UP(data[thr].cmp_len + LZO_HEADER,
+			need = DIV_ROUND_UP(data[thr].cmp_len + CMP_HEADER,
 			                    PAGE_SIZE);
 			if (need > have) {
 				if (eof > 1) {
@@ -1364,7 +1636,7 @@ static int load_image_lzo(struct swap_map_handle *handle,
 			}
 
 			for (off = 0;
-			     off < LZO_HEADER + data[thr].cmp_len;
+			     off < CMP_HEADER + data[thr].cmp_len;
 			     off += PAGE_SIZE) {
 				memcpy(data[thr].cmp + off,
 				       page[pg], PAGE_SIZE);
@@ -1378,35 +1650,50 @@ static int load_image_lzo(struct swap_map_handle *handle,
 			wake_up(&data[thr].go);
 		}
 
+		/*
+		 * Refill the ring slots just handed to the threads, so the
+		 * device keeps reading while we are decompressing.
+		 */
+		ret = read_ahead(handle, page, &ring, ring_size, &want,
+				 &asked, &eof, &hb);
+		if (ret)
+			goto out_finish;
+
 		/*
 		 * Wait for more data while we are decompressing.
 		 */
-		if (have < LZO_CMP_PAGES && asked) {
+		if (have < CMP_PAGES && asked) {
+			t = ktime_get();
 			ret = hib_wait_io(&hb);
+			io_time = ktime_add(io_time, ktime_sub(ktime_get(), t));
 			if (ret)
 				goto out_finish;
 			have += asked;
+			nr_cmp_pages += asked;
 			asked = 0;
 			if (eof)
 				eof = 2;
 		}
 
 		for (run_threads = thr, thr = 0; thr < run_threads; thr++) {
+			t = ktime_get();
 			wait_event(data[thr].done,
 			           atomic_read(&data[thr].stop));
+			dec_time = ktime_add(dec_time, ktime_sub(ktime_get(), t));
 			atomic_set(&data[thr].stop, 0);
 
 			ret = data[thr].ret;
 
 			if (ret < 0) {
-				pr_err("LZO decompression failed\n");
+				pr_err("%s decompression failed\n", ops->name);
 				goto out_finish;
 			}
 
 			if (unlikely(!data[thr].unc_len ||
-			             data[thr].unc_len > LZO_UNC_SIZE ||
+			             data[thr].unc_len > UNC_SIZE ||
 			             data[thr].unc_len & (PAGE_SIZE - 1))) {
-				pr_err("Invalid LZO uncompressed length\n");
+				pr_err("Invalid %s uncompressed length\n",
+				       ops->name);
 				ret = -1;
 				goto out_finish;
 			}
@@ -1457,6 +1744,10 @@ static int load_image_lzo(struct swap_map_handle *handle,
 		}
 	}
 	swsusp_show_speed(start, stop, nr_to_read, "Read");
+	/* Per-phase throughput, in terms of compressed data read from disk. */
+	swsusp_show_speed(start, stop, nr_cmp_pages, "Read compressed");
+	swsusp_show_speed(0, io_time, nr_cmp_pages, "I/O wait for");
+	swsusp_show_speed(0, dec_time, nr_cmp_pages, "Decompression wait for");
 out_clean:
 	hib_finish_batch(&hb);
 	for (i = 0; i < ring_size; i++)
@@ -1467,9 +1758,11 @@ static int load_image_lzo(struct swap_map_handle *handle,
 		kfree(crc);
 	}
 	if (data) {
-		for (thr = 0; thr < nr_threads; thr++)
+		for (thr = 0; thr < nr_threads; thr++) {
 			if (data[thr].thr)
 				kthread_stop(data[thr].thr);
+			vfree(data[thr].wrk);
+		}
 		vfree(data);
 	}
 	vfree(page);
@@ -1503,7 +1796,8 @@ int swsusp_read(unsigned int *flags_p)
 	if (!error) {
 		error = (*flags_p & SF_NOCOMPRESS_MODE) ?
 			load_image(&handle, &snapshot, header->pages - 1) :
-			load_image_lzo(&handle, &snapshot, header->pages - 1);
+			load_compressed_image(&handle, &snapshot,
+					      header->pages - 1, *flags_p);
 	}
 	swap_reader_finish(&handle);
 end:
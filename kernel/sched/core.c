@@ -1577,6 +1577,146 @@ static void __setscheduler_uclamp(struct task_struct *p,
 	}
 }
 
+static int frame_hint_validate(int policy, const struct sched_attr *attr)
+{
+	/* SCHED_DEADLINE tasks already get their bandwidth guaranteed */
+	if (dl_policy(policy))
+		return -EINVAL;
+
+	/* A zero runtime removes the hint */
+	if (!attr->sched_runtime)
+		return 0;
+
+	if (attr->sched_runtime < (1ULL << DL_SCALE) ||
+	    attr->sched_deadline < attr->sched_runtime ||
+	    attr->sched_deadline > NSEC_PER_SEC)
+		return -EINVAL;
+
+	return 0;
+}
+
+static void __setscheduler_frame(struct task_struct *p,
+				 const struct sched_attr *attr)
+{
+	struct sched_frame_hint *fh = &p->frame;
+
+	if (unlikely(dl_policy(p->policy))) {
+		*fh = (struct sched_frame_hint){ };
+		return;
+	}
+
+	if (likely(!(attr->sched_flags & SCHED_FLAG_UTIL_DEADLINE)))
+		return;
+
+	*fh = (struct sched_frame_hint){ };
+	if (!attr->sched_runtime)
+		return;
+
+	fh->runtime = attr->sched_runtime;
+	fh->deadline = attr->sched_deadline;
+	fh->bw = div64_u64(fh->runtime << SCHED_CAPACITY_SHIFT, fh->deadline);
+	fh->util = fh->bw;
+}
+
+/*
+ * Account the work done by @p since the last update, scaled to the maximum
+ * capacity of the system so that it is comparable with the declared runtime.
+ */
+static void frame_update_work(struct rq *rq, struct task_struct *p)
+{
+	struct sched_frame_hint *fh = &p->frame;
+	u64 exec = p->se.sum_exec_runtime;
+	int cpu = cpu_of(rq);
+	u64 delta;
+
+	delta = exec - fh->exec_start;
+	fh->exec_start = exec;
+
+	delta = cap_scale(delta, arch_scale_freq_capacity(cpu));
+	delta = cap_scale(delta, arch_scale_cpu_capacity(cpu));
+	fh->work += delta;
+}
+
+static inline void frame_rq_inc(struct rq *rq, struct task_struct *p)
+{
+	struct sched_frame_hint *fh = &p->frame;
+
+	if (likely(!fh->runtime))
+		return;
+
+	/* First enqueue of a new activation */
+	if (!fh->wake_time) {
+		fh->wake_time = rq_clock(rq);
+		fh->exec_start = p->se.sum_exec_runtime;
+		fh->work = 0;
+		fh->util = fh->bw;
+	}
+
+	WRITE_ONCE(rq->frame_util, rq->frame_util + fh->util);
+}
+
+static inline void frame_rq_dec(struct rq *rq, struct task_struct *p,
+				int flags)
+{
+	struct sched_frame_hint *fh = &p->frame;
+
+	if (likely(!fh->runtime))
+		return;
+
+	WRITE_ONCE(rq->frame_util, rq->frame_util - fh->util);
+
+	if (!(flags & DEQUEUE_SLEEP))
+		return;
+
+	frame_update_work(rq, p);
+	trace_sched_frame_complete(p, fh->runtime, fh->deadline, fh->work,
+				   rq_clock(rq) - fh->wake_time);
+	fh->wake_time = 0;
+}
+
+/*
+ * Re-evaluate the utilization needed by the current task to complete its
+ * remaining frame work in the time left before its deadline.
+ */
+static void frame_tick(struct rq *rq, struct task_struct *curr)
+{
+	struct sched_frame_hint *fh = &curr->frame;
+	unsigned long util, old_util = fh->util;
+	u64 remaining = 0;
+	s64 time_left;
+
+	if (likely(!fh->runtime) || !fh->wake_time)
+		return;
+
+	frame_update_work(rq, curr);
+
+	time_left = fh->deadline - (rq_clock(rq) - fh->wake_time);
+	if (fh->work < fh->runtime)
+		remaining = fh->runtime - fh->work;
+
+	if (time_left <= 0) {
+		/* Deadline missed: run as fast as possible */
+		util = SCHED_CAPACITY_SCALE;
+	} else if (!remaining) {
+		/* Over budget: the remaining work is unknown, keep the declared rate */
+		util = fh->bw;
+	} else {
+		util = min_t(u64, SCHED_CAPACITY_SCALE,
+			     div64_u64(remaining << SCHED_CAPACITY_SHIFT, time_left));
+	}
+
+	trace_sched_frame_boost(curr, cpu_of(rq), util, remaining, time_left);
+
+	if (util == old_util)
+		return;
+
+	WRITE_ONCE(rq->frame_util, rq->frame_util - old_util + util);
+	fh->util = util;
+
+	if (util > old_util)
+		cpufreq_update_util(rq, 0);
+}
+
 static void uclamp_fork(struct task_struct *p)
 {
 	enum uclamp_id clamp_id;
@@ -1588,6 +1728,9 @@ static void uclamp_fork(struct task_struct *p)
 	for_each_clamp_id(clamp_id)
 		p->uclamp[clamp_id].active = false;
 
+	/* Frame hints describe the work of a single thread */
+	p->frame = (struct sched_frame_hint){ };
+
 	if (likely(!p->sched_reset_on_fork))
 		return;
 
@@ -1651,6 +1794,17 @@ static inline int uclamp_validate(struct task_struct *p,
 }
 static void __setscheduler_uclamp(struct task_struct *p,
 				  const struct sched_attr *attr) { }
+static inline int frame_hint_validate(int policy,
+				      const struct sched_attr *attr)
+{
+	return -EOPNOTSUPP;
+}
+static void __setscheduler_frame(struct task_struct *p,
+				 const struct sched_attr *attr) { }
+static inline void frame_rq_inc(struct rq *rq, struct task_struct *p) { }
+static inline void frame_rq_dec(struct rq *rq, struct task_struct *p,
+				int flags) { }
+static inline void frame_tick(struct rq *rq, struct task_struct *curr) { }
 static inline void uclamp_fork(struct task_struct *p) { }
 static inline void uclamp_post_fork(struct task_struct *p) { }
 static inline void init_uclamp(void) { }
@@ -1667,6 +1821,7 @@ static inline void enqueue_task(struct rq *rq, struct task_struct *p, int flags)
 	}
 
 	uclamp_rq_inc(rq, p);
+	frame_rq_inc(rq, p);
 	trace_android_rvh_enqueue_task(rq, p, flags);
 	p->sched_class->enqueue_task(rq, p, flags);
 	trace_android_rvh_after_enqueue_task(rq, p);
@@ -1685,6 +1840,8 @@ static inline void dequeue_task(struct rq *rq, struct task_struct *p, int flags)
 	uclamp_rq_dec(rq, p);
 	trace_android_rvh_dequeue_task(rq, p, flags);
 	p->sched_class->dequeue_task(rq, p, flags);
+	/* After the class dequeue, which updated the task's runtime */
+	frame_rq_dec(rq, p, flags);
 	trace_android_rvh_after_dequeue_task(rq, p);
 }
 
@@ -2857,6 +3014,18 @@ bool cpus_share_cache(int this_cpu, int that_cpu)
 	return per_cpu(sd_llc_id, this_cpu) == per_cpu(sd_llc_id, that_cpu);
 }
 
+/*
+ * Whether CPUs share cache resources, which means LLC on non-cluster
+ * machines and LLC tag or L2 on machines with clusters.
+ */
+bool cpus_share_resources(int this_cpu, int that_cpu)
+{
+	if (this_cpu == that_cpu)
+		return true;
+
+	return per_cpu(sd_share_id, this_cpu) == per_cpu(sd_share_id, that_cpu);
+}
+
 static inline bool ttwu_queue_cond(int cpu, int wake_flags)
 {
 	/*
@@ -4252,6 +4421,7 @@ void scheduler_tick(void)
 	thermal_pressure = arch_scale_thermal_pressure(cpu_of(rq));
 	update_thermal_load_avg(rq_clock_thermal(rq), rq, thermal_pressure);
 	curr->sched_class->task_tick(rq, curr, 0);
+	frame_tick(rq, curr);
 	calc_global_load_tick(rq);
 	psi_task_tick(rq);
 
@@ -5543,8 +5713,9 @@ static int __sched_setscheduler(struct task_struct *p,
 		if (p->sched_reset_on_fork && !reset_on_fork)
 			return -EPERM;
 
-		/* Can't change util-clamps */
-		if (attr->sched_flags & SCHED_FLAG_UTIL_CLAMP)
+		/* Can't change util-clamps or frame hints */
+		if (attr->sched_flags & (SCHED_FLAG_UTIL_CLAMP |
+					 SCHED_FLAG_UTIL_DEADLINE))
 			return -EPERM;
 	}
 
@@ -5564,6 +5735,12 @@ static int __sched_setscheduler(struct task_struct *p,
 			return retval;
 	}
 
+	if (attr->sched_flags & SCHED_FLAG_UTIL_DEADLINE) {
+		retval = frame_hint_validate(policy, attr);
+		if (retval)
+			return retval;
+	}
+
 	/*
 	 * Make sure no PI-waiters arrive (or leave) while we are
 	 * changing the priority of the task:
@@ -5593,7 +5770,8 @@ static int __sched_setscheduler(struct task_struct *p,
 			goto change;
 		if (dl_policy(policy) && dl_param_changed(p, attr))
 			goto change;
-		if (attr->sched_flags & SCHED_FLAG_UTIL_CLAMP)
+		if (attr->sched_flags & (SCHED_FLAG_UTIL_CLAMP |
+					 SCHED_FLAG_UTIL_DEADLINE))
 			goto change;
 
 		p->sched_reset_on_fork = reset_on_fork;
@@ -5683,6 +5861,7 @@ static int __sched_setscheduler(struct task_struct *p,
 		trace_android_rvh_setscheduler(p);
 	}
 	__setscheduler_uclamp(p, attr);
+	__setscheduler_frame(p, attr);
 
 	if (queued) {
 		/*
@@ -6130,6 +6309,12 @@ SYSCALL_DEFINE4(sched_getattr, pid_t, pid, struct sched_attr __user *, uattr,
 	 */
 	kattr.sched_util_min = p->uclamp_req[UCLAMP_MIN].value;
 	kattr.sched_util_max = p->uclamp_req[UCLAMP_MAX].value;
+
+	if (p->frame.runtime) {
+		kattr.sched_flags |= SCHED_FLAG_UTIL_DEADLINE;
+		kattr.sched_runtime = p->frame.runtime;
+		kattr.sched_deadline = p->frame.deadline;
+	}
 #endif
 
 	rcu_read_unlock();
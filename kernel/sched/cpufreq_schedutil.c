@@ -55,6 +55,7 @@ struct sugov_cpu {
 	u64			last_update;
 
 	unsigned long		bw_dl;
+	unsigned long		frame_util;
 	unsigned long		max;
 
 	/* The field below is for single-CPU policies only: */
@@ -198,6 +199,10 @@ static unsigned int get_next_freq(struct sugov_policy *sg_policy,
  * The DL bandwidth number otoh is not a measured metric but a value computed
  * based on the task model parameters and gives the minimal utilization
  * required to meet deadlines.
+ *
+ * Similarly, cpu_frame_util() is computed from the frame hints of RUNNABLE
+ * tasks and gives the utilization required to complete their remaining
+ * work before their deadlines.
  */
 unsigned long schedutil_cpu_util(int cpu, unsigned long util_cfs,
 				 unsigned long max, enum schedutil_type type,
@@ -282,6 +287,14 @@ unsigned long schedutil_cpu_util(int cpu, unsigned long util_cfs,
 	if (type == FREQUENCY_UTIL)
 		util += cpu_bw_dl(rq);
 
+	/*
+	 * Frame hints are a prediction of the work still to be done by the
+	 * RUNNABLE tasks, which is already part of the measured utilization
+	 * once it has run: use them as a floor rather than adding them.
+	 */
+	if (type == FREQUENCY_UTIL)
+		util = max(util, cpu_frame_util(rq));
+
 	return min(max, util);
 }
 EXPORT_SYMBOL_GPL(schedutil_cpu_util);
@@ -294,6 +307,7 @@ static unsigned long sugov_get_util(struct sugov_cpu *sg_cpu)
 
 	sg_cpu->max = max;
 	sg_cpu->bw_dl = cpu_bw_dl(rq);
+	sg_cpu->frame_util = cpu_frame_util(rq);
 
 	return schedutil_cpu_util(sg_cpu->cpu, util, max, FREQUENCY_UTIL, NULL);
 }
@@ -435,12 +449,15 @@ static inline bool sugov_cpu_is_busy(struct sugov_cpu *sg_cpu) { return false; }
 #endif /* CONFIG_NO_HZ_COMMON */
 
 /*
- * Make sugov_should_update_freq() ignore the rate limit when DL
- * has increased the utilization.
+ * Make sugov_should_update_freq() ignore the rate limit when DL or a frame
+ * hint has increased the utilization.
  */
 static inline void ignore_dl_rate_limit(struct sugov_cpu *sg_cpu, struct sugov_policy *sg_policy)
 {
-	if (cpu_bw_dl(cpu_rq(sg_cpu->cpu)) > sg_cpu->bw_dl)
+	struct rq *rq = cpu_rq(sg_cpu->cpu);
+
+	if (cpu_bw_dl(rq) > sg_cpu->bw_dl ||
+	    cpu_frame_util(rq) > sg_cpu->frame_util)
 		sg_policy->limits_changed = true;
 }
 
@@ -6202,6 +6202,7 @@ static int select_idle_cpu(struct task_struct *p, struct sched_domain *sd, int t
 	struct cpumask *cpus = this_cpu_cpumask_var_ptr(select_idle_mask);
 	struct sched_domain *this_sd;
 	u64 avg_cost, avg_idle;
+	struct sched_domain *sd_cluster;
 	u64 time;
 	int this = smp_processor_id();
 	int cpu, nr = INT_MAX;
@@ -6232,6 +6233,23 @@ static int select_idle_cpu(struct task_struct *p, struct sched_domain *sd, int t
 
 	cpumask_and(cpus, sched_domain_span(sd), p->cpus_ptr);
 
+	/*
+	 * Look for an idle CPU in the target's cluster first, it shares the
+	 * L2 or LLC tags with the target, then scan the rest of the LLC.
+	 */
+	sd_cluster = rcu_dereference(per_cpu(sd_cluster, target));
+	if (sd_cluster) {
+		for_each_cpu_wrap(cpu, sched_domain_span(sd_cluster), target) {
+			if (!cpumask_test_cpu(cpu, cpus))
+				continue;
+			if (!--nr)
+				return -1;
+			if (available_idle_cpu(cpu) || sched_idle_cpu(cpu))
+				goto found;
+		}
+		cpumask_andnot(cpus, cpus, sched_domain_span(sd_cluster));
+	}
+
 	for_each_cpu_wrap(cpu, cpus, target) {
 		if (!--nr)
 			return -1;
@@ -6239,12 +6257,33 @@ static int select_idle_cpu(struct task_struct *p, struct sched_domain *sd, int t
 			break;
 	}
 
+found:
 	time = cpu_clock(this) - time;
 	update_avg(&this_sd->avg_scan_cost, time);
 
 	return cpu;
 }
 
+/* Whether an idle @cpu fits the task, otherwise track the biggest idle CPU */
+static inline bool
+idle_cpu_fits_capacity(int cpu, unsigned long task_util,
+		       unsigned long *best_cap, int *best_cpu)
+{
+	unsigned long cpu_cap = capacity_of(cpu);
+
+	if (!available_idle_cpu(cpu) && !sched_idle_cpu(cpu))
+		return false;
+	if (fits_capacity(task_util, cpu_cap))
+		return true;
+
+	if (cpu_cap > *best_cap) {
+		*best_cap = cpu_cap;
+		*best_cpu = cpu;
+	}
+
+	return false;
+}
+
 /*
  * Scan the asym_capacity domain for idle CPUs; pick the first idle one on which
  * the task fits. If no CPU is big enough, but there are idle ones, try to
@@ -6254,6 +6293,7 @@ static int
 select_idle_capacity(struct task_struct *p, struct sched_domain *sd, int target)
 {
 	unsigned long task_util, best_cap = 0;
+	struct sched_domain *sd_cluster;
 	int cpu, best_cpu = -1;
 	struct cpumask *cpus;
 
@@ -6262,18 +6302,26 @@ select_idle_capacity(struct task_struct *p, struct sched_domain *sd, int target)
 
 	task_util = uclamp_task_util(p);
 
-	for_each_cpu_wrap(cpu, cpus, target) {
-		unsigned long cpu_cap = capacity_of(cpu);
+	/*
+	 * Look for an idle CPU the task fits on in the target's cluster
+	 * first, then scan the rest of the asym_capacity domain.
+	 */
+	sd_cluster = rcu_dereference(per_cpu(sd_cluster, target));
+	if (sd_cluster) {
+		for_each_cpu_wrap(cpu, sched_domain_span(sd_cluster), target) {
+			if (!cpumask_test_cpu(cpu, cpus))
+				continue;
+			if (idle_cpu_fits_capacity(cpu, task_util, &best_cap,
+						   &best_cpu))
+				return cpu;
+		}
+		cpumask_andnot(cpus, cpus, sched_domain_span(sd_cluster));
+	}
 
-		if (!available_idle_cpu(cpu) && !sched_idle_cpu(cpu))
-			continue;
-		if (fits_capacity(task_util, cpu_cap))
+	for_each_cpu_wrap(cpu, cpus, target) {
+		if (idle_cpu_fits_capacity(cpu, task_util, &best_cap,
+					   &best_cpu))
 			return cpu;
-
-		if (cpu_cap > best_cap) {
-			best_cap = cpu_cap;
-			best_cpu = cpu;
-		}
 	}
 
 	return best_cpu;
@@ -6294,7 +6342,7 @@ static int select_idle_sibling(struct task_struct *p, int prev, int target)
 {
 	struct sched_domain *sd;
 	unsigned long task_util;
-	int i, recent_used_cpu;
+	int i, recent_used_cpu, prev_aff = -1;
 
 	/*
 	 * On asymmetric system, update task utilization because we will check
@@ -6314,8 +6362,16 @@ static int select_idle_sibling(struct task_struct *p, int prev, int target)
 	 */
 	if (prev != target && cpus_share_cache(prev, target) &&
 	    (available_idle_cpu(prev) || sched_idle_cpu(prev)) &&
-	    asym_fits_capacity(task_util, prev))
-		return prev;
+	    asym_fits_capacity(task_util, prev)) {
+		/*
+		 * On cluster machines, prefer an idle CPU in the target's
+		 * cluster and keep prev as a fallback.
+		 */
+		if (cpus_share_resources(prev, target))
+			return prev;
+
+		prev_aff = prev;
+	}
 
 	/*
 	 * Allow a per-cpu kthread to stack with the wakee if the
@@ -6339,12 +6395,16 @@ static int select_idle_sibling(struct task_struct *p, int prev, int target)
 	    (available_idle_cpu(recent_used_cpu) || sched_idle_cpu(recent_used_cpu)) &&
 	    cpumask_test_cpu(p->recent_used_cpu, p->cpus_ptr) &&
 	    asym_fits_capacity(task_util, recent_used_cpu)) {
-		/*
-		 * Replace recent_used_cpu with prev as it is a potential
-		 * candidate for the next wake:
-		 */
-		p->recent_used_cpu = prev;
-		return recent_used_cpu;
+		if (cpus_share_resources(recent_used_cpu, target)) {
+			/*
+			 * Replace recent_used_cpu with prev as it is a
+			 * potential candidate for the next wake:
+			 */
+			p->recent_used_cpu = prev;
+			return recent_used_cpu;
+		}
+	} else {
+		recent_used_cpu = -1;
 	}
 
 	/*
@@ -6383,6 +6443,15 @@ static int select_idle_sibling(struct task_struct *p, int prev, int target)
 	if ((unsigned)i < nr_cpumask_bits)
 		return i;
 
+	/*
+	 * No idle CPU was found in the target's cluster, but prev or
+	 * recent_used_cpu in a sibling cluster of the LLC may still be idle.
+	 */
+	if ((unsigned)prev_aff < nr_cpumask_bits)
+		return prev_aff;
+	if ((unsigned)recent_used_cpu < nr_cpumask_bits)
+		return recent_used_cpu;
+
 	return target;
 }
 
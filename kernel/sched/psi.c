@@ -1,5 +1,5 @@
 /*
- * Pressure stall information for CPU, memory and IO
+ * Pressure stall information for CPU, memory, IO and accelerators
  *
  * Copyright (c) 2018 Facebook, Inc.
  * Author: Johannes Weiner <hannes@cmpxchg.org>
@@ -234,11 +234,15 @@ static bool test_state(unsigned int *tasks, enum psi_states state)
 		return tasks[NR_MEMSTALL];
 	case PSI_MEM_FULL:
 		return tasks[NR_MEMSTALL] && !tasks[NR_RUNNING];
+	case PSI_ACCEL_SOME:
+		return tasks[NR_ACCELSTALL];
+	case PSI_ACCEL_FULL:
+		return tasks[NR_ACCELSTALL] && !tasks[NR_RUNNING];
 	case PSI_CPU_SOME:
 		return tasks[NR_RUNNING] > tasks[NR_ONCPU];
 	case PSI_NONIDLE:
 		return tasks[NR_IOWAIT] || tasks[NR_MEMSTALL] ||
-			tasks[NR_RUNNING];
+			tasks[NR_ACCELSTALL] || tasks[NR_RUNNING];
 	default:
 		return false;
 	}
@@ -733,6 +737,12 @@ static void record_times(struct psi_group_cpu *groupc, int cpu,
 		}
 	}
 
+	if (groupc->state_mask & (1 << PSI_ACCEL_SOME)) {
+		groupc->times[PSI_ACCEL_SOME] += delta;
+		if (groupc->state_mask & (1 << PSI_ACCEL_FULL))
+			groupc->times[PSI_ACCEL_FULL] += delta;
+	}
+
 	if (groupc->state_mask & (1 << PSI_CPU_SOME))
 		groupc->times[PSI_CPU_SOME] += delta;
 
@@ -982,6 +992,128 @@ void psi_memstall_leave(unsigned long *flags)
 	rq_unlock_irq(rq, &rf);
 }
 
+static LIST_HEAD(psi_accel_list);
+static DEFINE_MUTEX(psi_accel_mutex);
+
+/**
+ * psi_accel_register - register an accelerator for stall tracking
+ * @accel: the accelerator's stall tracking state
+ * @name: name shown in /proc/pressure/accel_devices
+ */
+void psi_accel_register(struct psi_accel *accel, const char *name)
+{
+	accel->name = name;
+	spin_lock_init(&accel->lock);
+	accel->nr_waiting = 0;
+	accel->stall_total = 0;
+
+	mutex_lock(&psi_accel_mutex);
+	list_add_tail(&accel->node, &psi_accel_list);
+	mutex_unlock(&psi_accel_mutex);
+}
+EXPORT_SYMBOL_GPL(psi_accel_register);
+
+/**
+ * psi_accel_unregister - stop tracking the stalls of an accelerator
+ * @accel: the accelerator's stall tracking state
+ */
+void psi_accel_unregister(struct psi_accel *accel)
+{
+	mutex_lock(&psi_accel_mutex);
+	list_del(&accel->node);
+	mutex_unlock(&psi_accel_mutex);
+}
+EXPORT_SYMBOL_GPL(psi_accel_unregister);
+
+static u64 psi_accel_stall_time(struct psi_accel *accel, u64 now)
+{
+	u64 total = accel->stall_total;
+
+	if (accel->nr_waiting)
+		total += now - accel->stall_start;
+	return total;
+}
+
+/**
+ * psi_accelstall_enter - mark the beginning of an accelerator stall section
+ * @accel: the accelerator waited for
+ * @flags: flags to handle nested sections
+ *
+ * Marks the calling task as being stalled waiting for a hardware
+ * accelerator, such as waiting for an NPU job or a video frame to be
+ * processed.  This feeds the accel pressure of the task's cgroups and of
+ * the system, as well as the stall time of @accel.
+ */
+void psi_accelstall_enter(struct psi_accel *accel, unsigned long *flags)
+{
+	struct rq_flags rf;
+	struct rq *rq;
+	u64 now;
+
+	if (static_branch_likely(&psi_disabled))
+		return;
+
+	now = ktime_get_ns();
+	spin_lock(&accel->lock);
+	if (!accel->nr_waiting++)
+		accel->stall_start = now;
+	spin_unlock(&accel->lock);
+
+	*flags = current->in_accelstall;
+	if (*flags)
+		return;
+	/*
+	 * in_accelstall setting & accounting needs to be atomic wrt
+	 * changes to the task's scheduling state, otherwise we can
+	 * race with CPU migration.
+	 */
+	rq = this_rq_lock_irq(&rf);
+
+	current->in_accelstall = 1;
+	psi_task_change(current, 0, TSK_ACCELSTALL);
+
+	rq_unlock_irq(rq, &rf);
+}
+EXPORT_SYMBOL_GPL(psi_accelstall_enter);
+
+/**
+ * psi_accelstall_leave - mark the end of an accelerator stall section
+ * @accel: the accelerator waited for
+ * @flags: flags to handle nested sections
+ *
+ * Marks the calling task as no longer waiting for @accel.
+ */
+void psi_accelstall_leave(struct psi_accel *accel, unsigned long *flags)
+{
+	struct rq_flags rf;
+	struct rq *rq;
+	u64 now;
+
+	if (static_branch_likely(&psi_disabled))
+		return;
+
+	now = ktime_get_ns();
+	spin_lock(&accel->lock);
+	if (!--accel->nr_waiting)
+		accel->stall_total += now - accel->stall_start;
+	spin_unlock(&accel->lock);
+
+	if (*flags)
+		return;
+	/*
+	 * in_accelstall clearing & accounting needs to be atomic wrt
+	 * changes to the task's scheduling state, otherwise we could
+	 * race with CPU migration.
+	 */
+	rq = this_rq_lock_irq(&rf);
+
+	current->in_accelstall = 0;
+	psi_task_change(current, TSK_ACCELSTALL, 0);
+
+	rq_unlock_irq(rq, &rf);
+}
+EXPORT_SYMBOL_GPL(psi_accelstall_leave);
+
 #ifdef CONFIG_CGROUPS
 int psi_cgroup_alloc(struct cgroup *cgroup)
 {
@@ -1045,6 +1177,9 @@ void cgroup_move_task(struct task_struct *task, struct css_set *to)
 	if (task->in_memstall)
 		task_flags |= TSK_MEMSTALL;
 
+	if (task->in_accelstall)
+		task_flags |= TSK_ACCELSTALL;
+
 	if (task_flags)
 		psi_task_change(task, task_flags, 0);
 
@@ -1105,11 +1240,41 @@ static int psi_memory_show(struct seq_file *m, void *v)
 	return psi_show(m, &psi_system, PSI_MEM);
 }
 
+static int psi_accel_show(struct seq_file *m, void *v)
+{
+	return psi_show(m, &psi_system, PSI_ACCEL);
+}
+
 static int psi_cpu_show(struct seq_file *m, void *v)
 {
 	return psi_show(m, &psi_system, PSI_CPU);
 }
 
+static int psi_accel_devices_show(struct seq_file *m, void *v)
+{
+	struct psi_accel *accel;
+	unsigned int nr_waiting;
+	u64 now, total;
+
+	if (static_branch_likely(&psi_disabled))
+		return -EOPNOTSUPP;
+
+	mutex_lock(&psi_accel_mutex);
+	list_for_each_entry(accel, &psi_accel_list, node) {
+		now = ktime_get_ns();
+		spin_lock(&accel->lock);
+		nr_waiting = accel->nr_waiting;
+		total = psi_accel_stall_time(accel, now);
+		spin_unlock(&accel->lock);
+
+		seq_printf(m, "%s waiting=%u total=%llu\n", accel->name,
+			   nr_waiting, div_u64(total, NSEC_PER_USEC));
+	}
+	mutex_unlock(&psi_accel_mutex);
+
+	return 0;
+}
+
 static int psi_io_open(struct inode *inode, struct file *file)
 {
 	return single_open(file, psi_io_show, NULL);
@@ -1120,6 +1285,11 @@ static int psi_memory_open(struct inode *inode, struct file *file)
 	return single_open(file, psi_memory_show, NULL);
 }
 
+static int psi_accel_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, psi_accel_show, NULL);
+}
+
 static int psi_cpu_open(struct inode *inode, struct file *file)
 {
 	return single_open(file, psi_cpu_show, NULL);
@@ -1347,6 +1517,12 @@ static ssize_t psi_memory_write(struct file *file, const char __user *user_buf,
 	return psi_write(file, user_buf, nbytes, PSI_MEM);
 }
 
+static ssize_t psi_accel_write(struct file *file, const char __user *user_buf,
+			       size_t nbytes, loff_t *ppos)
+{
+	return psi_write(file, user_buf, nbytes, PSI_ACCEL);
+}
+
 static ssize_t psi_cpu_write(struct file *file, const char __user *user_buf,
 			     size_t nbytes, loff_t *ppos)
 {
@@ -1386,6 +1562,15 @@ static const struct proc_ops psi_memory_proc_ops = {
 	.proc_release	= psi_fop_release,
 };
 
+static const struct proc_ops psi_accel_proc_ops = {
+	.proc_open	= psi_accel_open,
+	.proc_read	= seq_read,
+	.proc_lseek	= seq_lseek,
+	.proc_write	= psi_accel_write,
+	.proc_poll	= psi_fop_poll,
+	.proc_release	= psi_fop_release,
+};
+
 static const struct proc_ops psi_cpu_proc_ops = {
 	.proc_open	= psi_cpu_open,
 	.proc_read	= seq_read,
@@ -1401,7 +1586,10 @@ static int __init psi_proc_init(void)
 		proc_mkdir("pressure", NULL);
 		proc_create("pressure/io", 0, NULL, &psi_io_proc_ops);
 		proc_create("pressure/memory", 0, NULL, &psi_memory_proc_ops);
+		proc_create("pressure/accel", 0, NULL, &psi_accel_proc_ops);
 		proc_create("pressure/cpu", 0, NULL, &psi_cpu_proc_ops);
+		proc_create_single("pressure/accel_devices", 0, NULL,
+				   psi_accel_devices_show);
 	}
 	return 0;
 }
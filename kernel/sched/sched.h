@@ -950,6 +950,8 @@ struct rq {
 	struct uclamp_rq	uclamp[UCLAMP_CNT] ____cacheline_aligned;
 	unsigned int		uclamp_flags;
 #define UCLAMP_FLAG_IDLE 0x01
+	/* Sum of the frame hint utilization of RUNNABLE tasks */
+	unsigned long		frame_util;
 #endif
 
 	struct cfs_rq		cfs;
@@ -1487,6 +1489,8 @@ static inline struct sched_domain *lowest_flag_domain(int cpu, int flag)
 DECLARE_PER_CPU(struct sched_domain __rcu *, sd_llc);
 DECLARE_PER_CPU(int, sd_llc_size);
 DECLARE_PER_CPU(int, sd_llc_id);
+DECLARE_PER_CPU(struct sched_domain __rcu *, sd_cluster);
+DECLARE_PER_CPU(int, sd_share_id);
 DECLARE_PER_CPU(struct sched_domain_shared __rcu *, sd_llc_shared);
 DECLARE_PER_CPU(struct sched_domain __rcu *, sd_numa);
 DECLARE_PER_CPU(struct sched_domain __rcu *, sd_asym_packing);
@@ -2513,6 +2517,16 @@ static inline bool uclamp_is_used(void)
 {
 	return static_branch_likely(&sched_uclamp_used);
 }
+
+/*
+ * Utilization, relative to the maximum capacity of the system, needed by
+ * the RUNNABLE tasks of @rq to complete their declared frame work within
+ * their deadline. See struct sched_frame_hint.
+ */
+static inline unsigned long cpu_frame_util(struct rq *rq)
+{
+	return READ_ONCE(rq->frame_util);
+}
 #else /* CONFIG_UCLAMP_TASK */
 static inline
 unsigned long uclamp_rq_util_with(struct rq *rq, unsigned long util,
@@ -2530,6 +2544,11 @@ static inline bool uclamp_is_used(void)
 {
 	return false;
 }
+
+static inline unsigned long cpu_frame_util(struct rq *rq)
+{
+	return 0;
+}
 #endif /* CONFIG_UCLAMP_TASK */
 
 #ifdef CONFIG_UCLAMP_TASK_GROUP
@@ -72,6 +72,8 @@ static inline void psi_enqueue(struct task_struct *p, bool wakeup)
 	if (!wakeup || p->sched_psi_wake_requeue) {
 		if (p->in_memstall)
 			set |= TSK_MEMSTALL;
+		if (p->in_accelstall)
+			set |= TSK_ACCELSTALL;
 		if (p->sched_psi_wake_requeue)
 			p->sched_psi_wake_requeue = 0;
 	} else {
@@ -92,6 +94,8 @@ static inline void psi_dequeue(struct task_struct *p, bool sleep)
 	if (!sleep) {
 		if (p->in_memstall)
 			clear |= TSK_MEMSTALL;
+		if (p->in_accelstall)
+			clear |= TSK_ACCELSTALL;
 	} else {
 		/*
 		 * When a task sleeps, schedule() dequeues it before
@@ -117,7 +121,7 @@ static inline void psi_ttwu_dequeue(struct task_struct *p)
 	 * deregister its sleep-persistent psi states from the old
 	 * queue, and let psi_enqueue() know it has to requeue.
 	 */
-	if (unlikely(p->in_iowait || p->in_memstall)) {
+	if (unlikely(p->in_iowait || p->in_memstall || p->in_accelstall)) {
 		struct rq_flags rf;
 		struct rq *rq;
 		int clear = 0;
@@ -126,6 +130,8 @@ static inline void psi_ttwu_dequeue(struct task_struct *p)
 			clear |= TSK_IOWAIT;
 		if (p->in_memstall)
 			clear |= TSK_MEMSTALL;
+		if (p->in_accelstall)
+			clear |= TSK_ACCELSTALL;
 
 		rq = __task_rq_lock(p, &rf);
 		psi_task_change(p, clear, 0);
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * KUnit test and benchmark of unbound workqueue affinity scopes.
+ */
+
+#include <kunit/test.h>
+#include <linux/cpu.h>
+#include <linux/cpumask.h>
+#include <linux/ktime.h>
+#include <linux/sched/isolation.h>
+#include <linux/topology.h>
+#include <linux/workqueue.h>
+
+#define WQ_TEST_ROUNDS		64
+
+struct wq_test_work {
+	struct work_struct	work;
+	ktime_t			queued;
+	ktime_t			latency;
+	int			cpu;
+};
+
+static void wq_test_work_fn(struct work_struct *work)
+{
+	struct wq_test_work *tw = container_of(work, struct wq_test_work, work);
+
+	tw->latency = ktime_sub(ktime_get(), tw->queued);
+	tw->cpu = raw_smp_processor_id();
+}
+
+/* CPUs a work item queued from @cpu is expected to execute on */
+static const struct cpumask *wq_test_pod_cpus(enum wq_affn_scope scope,
+					      int cpu)
+{
+	switch (scope) {
+	case WQ_AFFN_CPU:
+		return cpumask_of(cpu);
+	case WQ_AFFN_CLUSTER:
+		return topology_cluster_cpumask(cpu);
+	case WQ_AFFN_NUMA:
+		return cpumask_of_node(cpu_to_node(cpu));
+	default:
+		return cpu_possible_mask;
+	}
+}
+
+static struct workqueue_struct *wq_test_alloc(struct kunit *test,
+					      enum wq_affn_scope scope)
+{
+	struct workqueue_struct *wq;
+	struct workqueue_attrs *attrs;
+	int ret;
+
+	wq = alloc_workqueue("wq_test_%d", WQ_UNBOUND, 0, scope);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, wq);
+
+	attrs = alloc_workqueue_attrs();
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, attrs);
+	attrs->affn_scope = scope;
+
+	get_online_cpus();
+	ret = apply_workqueue_attrs(wq, attrs);
+	put_online_cpus();
+	free_workqueue_attrs(attrs);
+
+	KUNIT_ASSERT_EQ(test, ret, 0);
+	return wq;
+}
+
+/*
+ * Queue work items from every online CPU on an unbound workqueue of
+ * @scope, check where they execute and report their latency.
+ */
+static void wq_test_scope(struct kunit *test, enum wq_affn_scope scope)
+{
+	const struct cpumask *hk_mask = housekeeping_cpumask(HK_FLAG_WQ);
+	struct workqueue_struct *wq = wq_test_alloc(test, scope);
+	struct wq_test_work tw;
+	s64 sum = 0, peak = 0, lat;
+	int cpu, i, nr = 0, misplaced = 0;
+
+	INIT_WORK_ONSTACK(&tw.work, wq_test_work_fn);
+
+	for_each_online_cpu(cpu) {
+		const struct cpumask *pod_cpus = wq_test_pod_cpus(scope, cpu);
+
+		for (i = 0; i < WQ_TEST_ROUNDS; i++) {
+			tw.queued = ktime_get();
+			queue_work_on(cpu, wq, &tw.work);
+			flush_work(&tw.work);
+
+			lat = ktime_to_ns(tw.latency);
+			sum += lat;
+			peak = max(peak, lat);
+			nr++;
+
+			/* isolated CPUs are excluded from unbound pods */
+			if (cpumask_intersects(pod_cpus, hk_mask) &&
+			    !cpumask_test_cpu(tw.cpu, pod_cpus))
+				misplaced++;
+		}
+	}
+
+	destroy_work_on_stack(&tw.work);
+	destroy_workqueue(wq);
+
+	if (scope != WQ_AFFN_SYSTEM)
+		KUNIT_EXPECT_EQ(test, misplaced, 0);
+
+	kunit_info(test, "%d work items: avg latency %lld ns, max %lld ns\n",
+		   nr, nr ? div_s64(sum, nr) : 0, peak);
+}
+
+static void wq_test_scope_cpu(struct kunit *test)
+{
+	wq_test_scope(test, WQ_AFFN_CPU);
+}
+
+static void wq_test_scope_cluster(struct kunit *test)
+{
+	wq_test_scope(test, WQ_AFFN_CLUSTER);
+}
+
+static void wq_test_scope_numa(struct kunit *test)
+{
+	wq_test_scope(test, WQ_AFFN_NUMA);
+}
+
+static void wq_test_scope_system(struct kunit *test)
+{
+	wq_test_scope(test, WQ_AFFN_SYSTEM);
+}
+
+static struct kunit_case wq_test_cases[] = {
+	KUNIT_CASE(wq_test_scope_cpu),
+	KUNIT_CASE(wq_test_scope_cluster),
+	KUNIT_CASE(wq_test_scope_numa),
+	KUNIT_CASE(wq_test_scope_system),
+	{}
+};
+
+static struct kunit_suite wq_test_suite = {
+	.name = "workqueue_affn_scope",
+	.test_cases = wq_test_cases,
+};
+
+kunit_test_suites(&wq_test_suite);
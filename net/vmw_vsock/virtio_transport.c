@@ -22,6 +22,13 @@
 #include <net/af_vsock.h>
 
 static struct workqueue_struct *virtio_vsock_workqueue;
+
+/* Larger rx buffers let the device deliver a whole tx packet of the peer
+ * in one descriptor instead of splitting it into 4KB pieces.
+ */
+static uint rx_buf_size = VIRTIO_VSOCK_DEFAULT_RX_BUF_SIZE;
+module_param(rx_buf_size, uint, 0444);
+MODULE_PARM_DESC(rx_buf_size, "Size of each rx buffer posted to the device");
 static struct virtio_vsock __rcu *the_virtio_vsock;
 static DEFINE_MUTEX(the_virtio_vsock_mutex); /* protects the_virtio_vsock */
 
@@ -53,6 +60,7 @@ struct virtio_vsock {
 	bool rx_run;
 	int rx_buf_nr;
 	int rx_buf_max_nr;
+	u32 rx_buf_len;
 
 	/* The following fields are protected by event_lock.
 	 * vqs[VSOCK_VQ_EVENT] must be accessed with event_lock held.
@@ -244,7 +252,7 @@ virtio_transport_cancel_pkt(struct vsock_sock *vsk)
 
 static void virtio_vsock_rx_fill(struct virtio_vsock *vsock)
 {
-	int buf_len = VIRTIO_VSOCK_DEFAULT_RX_BUF_SIZE;
+	int buf_len = vsock->rx_buf_len;
 	struct virtio_vsock_pkt *pkt;
 	struct scatterlist hdr, buf, *sgs[2];
 	struct virtqueue *vq;
@@ -520,7 +528,12 @@ static void virtio_transport_rx_work(struct work_struct *work)
 				break;
 			}
 
-			vsock->rx_buf_nr--;
+			/* Refill in batches of half the ring while a burst
+			 * is still being processed, so the device does not
+			 * run dry and stall until this loop finishes.
+			 */
+			if (--vsock->rx_buf_nr < vsock->rx_buf_max_nr / 2)
+				virtio_vsock_rx_fill(vsock);
 
 			/* Drop short/long packets */
 			if (unlikely(len < sizeof(pkt->hdr) ||
@@ -585,6 +598,9 @@ static int virtio_vsock_probe(struct virtio_device *vdev)
 
 	vsock->rx_buf_nr = 0;
 	vsock->rx_buf_max_nr = 0;
+	vsock->rx_buf_len = clamp_t(u32, rx_buf_size,
+				    VIRTIO_VSOCK_DEFAULT_RX_BUF_SIZE,
+				    VIRTIO_VSOCK_MAX_PKT_BUF_SIZE);
 	atomic_set(&vsock->queued_replies, 0);
 
 	mutex_init(&vsock->tx_lock);
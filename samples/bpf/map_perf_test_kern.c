@@ -38,6 +38,14 @@ struct {
 	__uint(map_flags, BPF_F_NO_COMMON_LRU);
 } nocommon_lru_hash_map SEC(".maps");
 
+struct {
+	__uint(type, BPF_MAP_TYPE_LRU_HASH);
+	__type(key, u32);
+	__type(value, long);
+	__uint(max_entries, 10000);
+	__uint(map_flags, BPF_F_LRU_SHARDED);
+} sharded_lru_hash_map SEC(".maps");
+
 struct inner_lru {
 	__uint(type, BPF_MAP_TYPE_LRU_HASH);
 	__type(key, u32);
@@ -218,6 +226,9 @@ int stress_lru_hmap_alloc(struct pt_regs *ctx)
 
 		ret = bpf_map_update_elem(nolocal_lru_map, &key, &val,
 					  BPF_ANY);
+	} else if (test_case == 4) {
+		ret = bpf_map_update_elem(&sharded_lru_hash_map, &key, &val,
+					  BPF_ANY);
 	} else if (test_case == 3) {
 		u32 i;
 
@@ -43,6 +43,7 @@ enum test_type {
 	ARRAY_LOOKUP,
 	INNER_LRU_HASH_PREALLOC,
 	LRU_HASH_LOOKUP,
+	SHARDED_LRU_HASH_PREALLOC,
 	NR_TESTS,
 };
 
@@ -58,6 +59,7 @@ const char *test_map_names[NR_TESTS] = {
 	[ARRAY_LOOKUP] = "array_map",
 	[INNER_LRU_HASH_PREALLOC] = "inner_lru_hash_map",
 	[LRU_HASH_LOOKUP] = "lru_hash_lookup_map",
+	[SHARDED_LRU_HASH_PREALLOC] = "sharded_lru_hash_map",
 };
 
 enum map_idx {
@@ -179,6 +181,9 @@ static void do_test_lru(enum test_type test, int cpu)
 		test_name = "lru_hash_lookup_perf";
 		in6.sin6_addr.s6_addr16[2] = 3;
 		in6.sin6_addr.s6_addr32[3] = 0;
+	} else if (test == SHARDED_LRU_HASH_PREALLOC) {
+		test_name = "sharded_lru_hash_map_perf";
+		in6.sin6_addr.s6_addr16[2] = 4;
 	} else {
 		assert(0);
 	}
@@ -218,6 +223,11 @@ static void test_lru_hash_lookup(int cpu)
 	do_test_lru(LRU_HASH_LOOKUP, cpu);
 }
 
+static void test_sharded_lru_hash_prealloc(int cpu)
+{
+	do_test_lru(SHARDED_LRU_HASH_PREALLOC, cpu);
+}
+
 static void test_percpu_hash_prealloc(int cpu)
 {
 	__u64 start_time;
@@ -308,6 +318,7 @@ const test_func test_funcs[] = {
 	[ARRAY_LOOKUP] = test_array_lookup,
 	[INNER_LRU_HASH_PREALLOC] = test_inner_lru_hash_prealloc,
 	[LRU_HASH_LOOKUP] = test_lru_hash_lookup,
+	[SHARDED_LRU_HASH_PREALLOC] = test_sharded_lru_hash_prealloc,
 };
 
 static int pre_test(int tasks)
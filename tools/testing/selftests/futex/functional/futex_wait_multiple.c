@@ -0,0 +1,432 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/******************************************************************************
+ *
+ * DESCRIPTION
+ *      Test FUTEX_WAIT_MULTIPLE: wait on a list of futexes and return the
+ *      index of the one woken, time out, or fail with EWOULDBLOCK on a
+ *      value mismatch.  Then compare the wake latency of a thread waiting
+ *      on several futexes with a thread waiting on as many eventfds with
+ *      poll().
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/shm.h>
+#include <sys/syscall.h>
+#include "futextest.h"
+#include "logging.h"
+
+#define TEST_NAME "futex-wait-multiple"
+
+#ifndef FUTEX_WAIT_MULTIPLE
+#define FUTEX_WAIT_MULTIPLE	31
+#endif
+
+#ifndef FUTEX_WAITV_MAX
+#define FUTEX_32		2
+#define FUTEX_WAITV_MAX		128
+
+struct futex_waitv {
+	uint64_t val;
+	uint64_t uaddr;
+	uint32_t flags;
+	uint32_t __reserved;
+};
+#endif
+
+#define NR_BENCH_FUTEXES	8
+#define WAKE_DELAY_US		10000
+#define BENCH_WAKE_TIMEOUT_NS	1000000000ULL
+
+static int iterations = 1000;
+static futex_t futexes[FUTEX_WAITV_MAX];
+static struct futex_waitv waitv[FUTEX_WAITV_MAX];
+
+static int futex_wait_multiple(struct futex_waitv *waiters, unsigned int nr,
+			       struct timespec *abs_timeout)
+{
+	return syscall(SYS_futex, waiters, FUTEX_WAIT_MULTIPLE, nr,
+		       abs_timeout, NULL, 0);
+}
+
+static void init_waitv(futex_t *f, unsigned int nr, unsigned int flags)
+{
+	unsigned int i;
+
+	for (i = 0; i < nr; i++) {
+		waitv[i].uaddr = (uintptr_t)&f[i];
+		waitv[i].val = f[i];
+		waitv[i].flags = FUTEX_32 | flags;
+		waitv[i].__reserved = 0;
+	}
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void abs_timeout(struct timespec *to, long ns)
+{
+	clock_gettime(CLOCK_MONOTONIC, to);
+	to->tv_nsec += ns;
+	while (to->tv_nsec >= 1000000000) {
+		to->tv_sec++;
+		to->tv_nsec -= 1000000000;
+	}
+}
+
+static void *waiter_fn(void *arg)
+{
+	long nr = (long)arg;
+
+	return (void *)(long)futex_wait_multiple(waitv, nr, NULL);
+}
+
+/* Wake the futex at @idx of an @nr long list and check the returned index */
+static int test_wake(unsigned int nr, unsigned int idx, unsigned int flags,
+		     futex_t *f)
+{
+	pthread_t waiter;
+	void *res;
+
+	init_waitv(f, nr, flags);
+	if (pthread_create(&waiter, NULL, waiter_fn, (void *)(long)nr)) {
+		error("pthread_create failed\n", errno);
+		return RET_ERROR;
+	}
+
+	usleep(WAKE_DELAY_US);
+	while (futex_wake(&f[idx], 1, flags) < 1)
+		usleep(WAKE_DELAY_US / 10);
+
+	pthread_join(waiter, &res);
+	if ((long)res != idx) {
+		fail("woken index %ld, expected %u\n", (long)res, idx);
+		return RET_FAIL;
+	}
+
+	info("waiter on %u futexes woken at index %u\n", nr, idx);
+	return RET_PASS;
+}
+
+static int test_shared_wake(void)
+{
+	void *shm;
+	int shm_id, ret;
+
+	shm_id = shmget(IPC_PRIVATE, 4096, IPC_CREAT | 0666);
+	if (shm_id < 0) {
+		error("shmget failed\n", errno);
+		return RET_ERROR;
+	}
+
+	shm = shmat(shm_id, NULL, 0);
+	if (shm == (void *)-1) {
+		error("shmat failed\n", errno);
+		shmctl(shm_id, IPC_RMID, NULL);
+		return RET_ERROR;
+	}
+	memset(shm, 0, 4096);
+
+	ret = test_wake(4, 2, 0, shm);
+
+	shmdt(shm);
+	shmctl(shm_id, IPC_RMID, NULL);
+	return ret;
+}
+
+static int test_wouldblock(void)
+{
+	int res;
+
+	init_waitv(futexes, 4, FUTEX_PRIVATE_FLAG);
+	waitv[3].val = futexes[3] + 1;
+
+	res = futex_wait_multiple(waitv, 4, NULL);
+	if (res != -1 || errno != EWOULDBLOCK) {
+		fail("futex_wait_multiple returned %d, errno %d, expected EWOULDBLOCK\n",
+		     res, errno);
+		return RET_FAIL;
+	}
+
+	return RET_PASS;
+}
+
+static int test_timeout(void)
+{
+	struct timespec to;
+	int res;
+
+	init_waitv(futexes, 4, FUTEX_PRIVATE_FLAG);
+
+	/* the timeout is absolute, measured against CLOCK_MONOTONIC */
+	abs_timeout(&to, 100000);
+
+	res = futex_wait_multiple(waitv, 4, &to);
+	if (res != -1 || errno != ETIMEDOUT) {
+		fail("futex_wait_multiple returned %d, errno %d, expected ETIMEDOUT\n",
+		     res, errno);
+		return RET_FAIL;
+	}
+
+	return RET_PASS;
+}
+
+static int test_invalid(void)
+{
+	int res;
+
+	init_waitv(futexes, 1, FUTEX_PRIVATE_FLAG);
+	waitv[0].__reserved = 1;
+
+	res = futex_wait_multiple(waitv, 1, NULL);
+	if (res != -1 || errno != EINVAL) {
+		fail("reserved field accepted: %d, errno %d\n", res, errno);
+		return RET_FAIL;
+	}
+
+	init_waitv(futexes, 1, FUTEX_PRIVATE_FLAG);
+	res = futex_wait_multiple(waitv, FUTEX_WAITV_MAX + 1, NULL);
+	if (res != -1 || errno != EINVAL) {
+		fail("oversized list accepted: %d, errno %d\n", res, errno);
+		return RET_FAIL;
+	}
+
+	return RET_PASS;
+}
+
+/*
+ * Wake latency benchmark: a waiter blocks on NR_BENCH_FUTEXES events, the
+ * main thread stamps the time and signals one of them, and the waiter
+ * stamps the time it returns.  The same is done with eventfds and poll(),
+ * which is what a media pipeline waiting on several buffers uses today.
+ */
+static volatile uint64_t wake_stamp, woke_stamp;
+static volatile int bench_done;
+static int efds[NR_BENCH_FUTEXES];
+
+/*
+ * The waiters use a timeout so that they notice bench_done even if the
+ * final signal raced with them sampling the futex values.
+ *
+ * waitv holds the values expected by the futex waiter. They are set up
+ * before the waiter starts and then carried forward from each wakeup,
+ * never read back from the futexes: a signal that lands before the wait
+ * starts must show up as EWOULDBLOCK, not become the value waited on.
+ * Only one signal is outstanding at a time, so a mismatch means that
+ * futex was signalled once.
+ */
+static void *futex_bench_waiter(void *arg)
+{
+	struct timespec to;
+	int i, res;
+
+	while (!bench_done) {
+		abs_timeout(&to, 100000000);
+		res = futex_wait_multiple(waitv, NR_BENCH_FUTEXES, &to);
+		if (res >= 0) {
+			woke_stamp = now_ns();
+			waitv[res].val++;
+		} else if (errno == EWOULDBLOCK) {
+			woke_stamp = now_ns();
+			for (i = 0; i < NR_BENCH_FUTEXES; i++) {
+				if (futexes[i] != waitv[i].val) {
+					waitv[i].val++;
+					break;
+				}
+			}
+		}
+	}
+	return NULL;
+}
+
+static void *eventfd_bench_waiter(void *arg)
+{
+	struct pollfd pfds[NR_BENCH_FUTEXES];
+	uint64_t cnt;
+	int i;
+
+	for (i = 0; i < NR_BENCH_FUTEXES; i++) {
+		pfds[i].fd = efds[i];
+		pfds[i].events = POLLIN;
+	}
+
+	while (!bench_done) {
+		if (poll(pfds, NR_BENCH_FUTEXES, 100) <= 0)
+			continue;
+		woke_stamp = now_ns();
+		for (i = 0; i < NR_BENCH_FUTEXES; i++) {
+			if ((pfds[i].revents & POLLIN) &&
+			    read(efds[i], &cnt, sizeof(cnt)) < 0)
+				break;
+		}
+	}
+	return NULL;
+}
+
+static void bench_signal(int use_eventfd, int idx)
+{
+	uint64_t one = 1;
+
+	if (use_eventfd) {
+		if (write(efds[idx], &one, sizeof(one)) < 0)
+			error("eventfd write failed\n", errno);
+	} else {
+		__atomic_add_fetch(&futexes[idx], 1, __ATOMIC_SEQ_CST);
+		futex_wake(&futexes[idx], 1, FUTEX_PRIVATE_FLAG);
+	}
+}
+
+/* Return the average wake latency in @avg_ns, fail if a wakeup is lost */
+static int bench_wake_latency(int use_eventfd, uint64_t *avg_ns)
+{
+	pthread_t waiter;
+	uint64_t total = 0;
+	int i, ret = RET_PASS;
+
+	bench_done = 0;
+	woke_stamp = 0;
+	init_waitv(futexes, NR_BENCH_FUTEXES, FUTEX_PRIVATE_FLAG);
+	if (pthread_create(&waiter, NULL, use_eventfd ? eventfd_bench_waiter :
+			   futex_bench_waiter, NULL)) {
+		error("pthread_create failed\n", errno);
+		return RET_ERROR;
+	}
+
+	for (i = 0; i < iterations; i++) {
+		woke_stamp = 0;
+		/* let the waiter block again */
+		usleep(100);
+		wake_stamp = now_ns();
+		bench_signal(use_eventfd, i % NR_BENCH_FUTEXES);
+		while (!woke_stamp) {
+			if (now_ns() - wake_stamp > BENCH_WAKE_TIMEOUT_NS)
+				break;
+		}
+		if (!woke_stamp) {
+			fail("%s waiter not woken after %llu ns\n",
+			     use_eventfd ? "eventfd" : "futex",
+			     BENCH_WAKE_TIMEOUT_NS);
+			ret = RET_FAIL;
+			break;
+		}
+		total += woke_stamp - wake_stamp;
+	}
+
+	bench_done = 1;
+	bench_signal(use_eventfd, 0);
+	pthread_join(waiter, NULL);
+
+	if (!ret)
+		*avg_ns = total / iterations;
+	return ret;
+}
+
+static int run_bench(void)
+{
+	uint64_t futex_ns, eventfd_ns;
+	int i, ret;
+
+	for (i = 0; i < NR_BENCH_FUTEXES; i++) {
+		efds[i] = eventfd(0, EFD_NONBLOCK);
+		if (efds[i] < 0) {
+			error("eventfd failed\n", errno);
+			return RET_ERROR;
+		}
+	}
+
+	ret = bench_wake_latency(0, &futex_ns);
+	if (!ret)
+		ret = bench_wake_latency(1, &eventfd_ns);
+
+	if (!ret)
+		ksft_print_msg("wake latency, %d waiters, %d iterations: FUTEX_WAIT_MULTIPLE %llu ns, eventfd+poll %llu ns\n",
+			       NR_BENCH_FUTEXES, iterations,
+			       (unsigned long long)futex_ns,
+			       (unsigned long long)eventfd_ns);
+
+	for (i = 0; i < NR_BENCH_FUTEXES; i++)
+		close(efds[i]);
+
+	return ret;
+}
+
+void usage(char *prog)
+{
+	printf("Usage: %s\n", prog);
+	printf("  -c	Use color\n");
+	printf("  -h	Display this help message\n");
+	printf("  -i N	Wake latency benchmark iterations (default: 1000)\n");
+	printf("  -v L	Verbosity level: %d=QUIET %d=CRITICAL %d=INFO\n",
+	       VQUIET, VCRITICAL, VINFO);
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = RET_PASS;
+	int c;
+
+	while ((c = getopt(argc, argv, "chi:v:")) != -1) {
+		switch (c) {
+		case 'c':
+			log_color(1);
+			break;
+		case 'h':
+			usage(basename(argv[0]));
+			exit(0);
+		case 'i':
+			iterations = atoi(optarg);
+			break;
+		case 'v':
+			log_verbosity(atoi(optarg));
+			break;
+		default:
+			usage(basename(argv[0]));
+			exit(1);
+		}
+	}
+
+	if (iterations <= 0)
+		iterations = 1;
+
+	ksft_print_header();
+	ksft_set_plan(1);
+	ksft_print_msg("%s: Wait on multiple futexes and wake any of them\n",
+		       basename(argv[0]));
+
+	init_waitv(futexes, 1, FUTEX_PRIVATE_FLAG);
+	if (futex_wait_multiple(waitv, 0, NULL) == -1 && errno == ENOSYS)
+		ksft_exit_skip("FUTEX_WAIT_MULTIPLE not supported\n");
+
+	ret = test_wake(1, 0, FUTEX_PRIVATE_FLAG, futexes);
+	if (!ret)
+		ret = test_wake(FUTEX_WAITV_MAX, FUTEX_WAITV_MAX - 1,
+				FUTEX_PRIVATE_FLAG, futexes);
+	if (!ret)
+		ret = test_shared_wake();
+	if (!ret)
+		ret = test_wouldblock();
+	if (!ret)
+		ret = test_timeout();
+	if (!ret)
+		ret = test_invalid();
+	if (!ret)
+		ret = run_bench();
+
+	print_result(TEST_NAME, ret);
+	return ret;
+}
@@ -0,0 +1,274 @@
+// SPDX-License-Identifier: GPL-2.0
+
+/*
+ * m2m_throughput_test - Memory to Memory Device Throughput Test
+ *
+ * This test should not be included in the Kselftest run. It should be
+ * run when a V4L2 mem2mem device (e.g. a 2D scaler/converter) is present.
+ *
+ * The test converts RGB24 test pattern frames into NV12 for the given
+ * number of frames, keeping every buffer queued, and reports frames per
+ * second. Small frames show the per job overhead of the driver; compare
+ * the results while changing driver batching parameters.
+ *
+ * Usage:
+ *	sudo ./m2m_throughput_test -d /dev/videoX [-n frames] [-w width]
+ *		[-h height] [-b buffers]
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <linux/videodev2.h>
+
+#define MAX_BUFFERS	32
+
+struct buffer {
+	void *start;
+	size_t length;
+};
+
+/* 75% colour bars, like the vivid/vicodec test pattern generator */
+static const uint8_t bars[8][3] = {
+	{ 191, 191, 191 }, { 191, 191, 0 }, { 0, 191, 191 }, { 0, 191, 0 },
+	{ 191, 0, 191 }, { 191, 0, 0 }, { 0, 0, 191 }, { 0, 0, 0 },
+};
+
+static void fill_pattern(uint8_t *p, unsigned int width, unsigned int height,
+			 unsigned int stride, unsigned int seq)
+{
+	unsigned int x, y;
+
+	for (y = 0; y < height; y++) {
+		uint8_t *line = p + y * stride;
+
+		for (x = 0; x < width; x++) {
+			const uint8_t *c = bars[(x * 8 / width + seq) % 8];
+
+			/* moving white box so consecutive frames differ */
+			if (((x + seq * 4) % width) < width / 8 &&
+			    y > height / 3 && y < height * 2 / 3)
+				c = bars[0];
+			memcpy(line + x * 3, c, 3);
+		}
+	}
+}
+
+static int set_format(int fd, enum v4l2_buf_type type, unsigned int width,
+		      unsigned int height, unsigned int fourcc,
+		      struct v4l2_format *fmt)
+{
+	memset(fmt, 0, sizeof(*fmt));
+	fmt->type = type;
+	fmt->fmt.pix.width = width;
+	fmt->fmt.pix.height = height;
+	fmt->fmt.pix.pixelformat = fourcc;
+	fmt->fmt.pix.field = V4L2_FIELD_NONE;
+
+	if (ioctl(fd, VIDIOC_S_FMT, fmt)) {
+		printf("VIDIOC_S_FMT type %d errno %s\n", type, strerror(errno));
+		return -1;
+	}
+	return 0;
+}
+
+static int setup_buffers(int fd, enum v4l2_buf_type type,
+			 struct buffer *bufs, unsigned int *count)
+{
+	struct v4l2_requestbuffers req;
+	struct v4l2_buffer buf;
+	unsigned int i;
+
+	memset(&req, 0, sizeof(req));
+	req.count = *count;
+	req.type = type;
+	req.memory = V4L2_MEMORY_MMAP;
+	if (ioctl(fd, VIDIOC_REQBUFS, &req)) {
+		printf("VIDIOC_REQBUFS errno %s\n", strerror(errno));
+		return -1;
+	}
+	if (req.count > MAX_BUFFERS)
+		req.count = MAX_BUFFERS;
+	*count = req.count;
+
+	for (i = 0; i < req.count; i++) {
+		memset(&buf, 0, sizeof(buf));
+		buf.type = type;
+		buf.memory = V4L2_MEMORY_MMAP;
+		buf.index = i;
+		if (ioctl(fd, VIDIOC_QUERYBUF, &buf)) {
+			printf("VIDIOC_QUERYBUF errno %s\n", strerror(errno));
+			return -1;
+		}
+		bufs[i].length = buf.length;
+		bufs[i].start = mmap(NULL, buf.length, PROT_READ | PROT_WRITE,
+				     MAP_SHARED, fd, buf.m.offset);
+		if (bufs[i].start == MAP_FAILED) {
+			printf("mmap errno %s\n", strerror(errno));
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int queue_buffer(int fd, enum v4l2_buf_type type, unsigned int index,
+			unsigned int bytesused)
+{
+	struct v4l2_buffer buf;
+
+	memset(&buf, 0, sizeof(buf));
+	buf.type = type;
+	buf.memory = V4L2_MEMORY_MMAP;
+	buf.index = index;
+	buf.bytesused = bytesused;
+	if (ioctl(fd, VIDIOC_QBUF, &buf)) {
+		printf("VIDIOC_QBUF errno %s\n", strerror(errno));
+		return -1;
+	}
+	return 0;
+}
+
+static int dequeue_buffer(int fd, enum v4l2_buf_type type)
+{
+	struct v4l2_buffer buf;
+
+	memset(&buf, 0, sizeof(buf));
+	buf.type = type;
+	buf.memory = V4L2_MEMORY_MMAP;
+	if (ioctl(fd, VIDIOC_DQBUF, &buf)) {
+		printf("VIDIOC_DQBUF errno %s\n", strerror(errno));
+		return -1;
+	}
+	return buf.index;
+}
+
+static void usage(const char *name)
+{
+	printf("Usage: %s [-d </dev/videoX>] [-n frames] [-w width] [-h height] [-b buffers]\n",
+	       name);
+	exit(-1);
+}
+
+int main(int argc, char **argv)
+{
+	enum v4l2_buf_type out_type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+	enum v4l2_buf_type cap_type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	struct buffer out_bufs[MAX_BUFFERS], cap_bufs[MAX_BUFFERS];
+	unsigned int width = 160, height = 120, frames = 1000, nbufs = 8;
+	unsigned int out_count, cap_count, queued = 0, done = 0, i;
+	struct v4l2_format out_fmt, cap_fmt;
+	struct timespec start, end;
+	char video_dev[256] = "";
+	struct pollfd pfd;
+	double secs;
+	int opt, fd, index;
+
+	while ((opt = getopt(argc, argv, "d:n:w:h:b:")) != -1) {
+		switch (opt) {
+		case 'd':
+			strncpy(video_dev, optarg, sizeof(video_dev) - 1);
+			video_dev[sizeof(video_dev)-1] = '\0';
+			break;
+		case 'n':
+			frames = atoi(optarg);
+			break;
+		case 'w':
+			width = atoi(optarg);
+			break;
+		case 'h':
+			height = atoi(optarg);
+			break;
+		case 'b':
+			nbufs = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (!video_dev[0] || !frames || !nbufs || nbufs > MAX_BUFFERS)
+		usage(argv[0]);
+
+	fd = open(video_dev, O_RDWR | O_NONBLOCK);
+	if (fd == -1) {
+		printf("Video Device open errno %s\n", strerror(errno));
+		exit(-1);
+	}
+
+	if (set_format(fd, out_type, width, height, V4L2_PIX_FMT_RGB24,
+		       &out_fmt) ||
+	    set_format(fd, cap_type, width, height, V4L2_PIX_FMT_NV12,
+		       &cap_fmt))
+		exit(-1);
+
+	out_count = nbufs;
+	cap_count = nbufs;
+	if (setup_buffers(fd, out_type, out_bufs, &out_count) ||
+	    setup_buffers(fd, cap_type, cap_bufs, &cap_count))
+		exit(-1);
+
+	for (i = 0; i < out_count; i++)
+		fill_pattern(out_bufs[i].start, out_fmt.fmt.pix.width,
+			     out_fmt.fmt.pix.height,
+			     out_fmt.fmt.pix.bytesperline, i);
+
+	for (i = 0; i < cap_count; i++)
+		if (queue_buffer(fd, cap_type, i, 0))
+			exit(-1);
+	for (i = 0; i < out_count && queued < frames; i++, queued++)
+		if (queue_buffer(fd, out_type, i, out_fmt.fmt.pix.sizeimage))
+			exit(-1);
+
+	if (ioctl(fd, VIDIOC_STREAMON, &cap_type) ||
+	    ioctl(fd, VIDIOC_STREAMON, &out_type)) {
+		printf("VIDIOC_STREAMON errno %s\n", strerror(errno));
+		exit(-1);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pfd.fd = fd;
+	pfd.events = POLLIN | POLLOUT;
+	while (done < frames) {
+		if (poll(&pfd, 1, 1000) <= 0) {
+			printf("Timeout after %u frames\n", done);
+			exit(-1);
+		}
+		if (pfd.revents & POLLIN) {
+			index = dequeue_buffer(fd, cap_type);
+			if (index < 0 || queue_buffer(fd, cap_type, index, 0))
+				exit(-1);
+			done++;
+		}
+		if (pfd.revents & POLLOUT) {
+			index = dequeue_buffer(fd, out_type);
+			if (index < 0)
+				exit(-1);
+			if (queued < frames) {
+				if (queue_buffer(fd, out_type, index,
+						 out_fmt.fmt.pix.sizeimage))
+					exit(-1);
+				queued++;
+			}
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	ioctl(fd, VIDIOC_STREAMOFF, &out_type);
+	ioctl(fd, VIDIOC_STREAMOFF, &cap_type);
+
+	secs = (end.tv_sec - start.tv_sec) +
+	       (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("%u frames %ux%u RGB24->NV12 in %.3f s: %.1f fps %.1f Mpix/s\n",
+	       done, width, height, secs, done / secs,
+	       (double)done * width * height / secs / 1e6);
+
+	close(fd);
+	return 0;
+}
@@ -0,0 +1,160 @@
+#!/bin/bash
+# SPDX-License-Identifier: GPL-2.0
+#
+# Check veth NAPI/GRO mode: GRO aggregates UDP GSO segments split at
+# the peer, GRO can be toggled at runtime and with XDP attached, and
+# fraglist GRO leaves forwarded traffic intact.
+
+readonly STATS="$(mktemp -p /tmp ns-XXXXXX)"
+readonly BASE=`basename $STATS`
+readonly SRC=2
+readonly DST=1
+readonly NS_SRC=$BASE$SRC
+readonly NS_DST=$BASE$DST
+
+# "baremetal" network used for raw UDP traffic
+readonly BM_NET_V4=192.168.1.
+readonly BM_NET_V6=2001:db8::
+ret=0
+
+cleanup() {
+	local ns
+	local -r jobs="$(jobs -p)"
+	[ -n "${jobs}" ] && kill -1 ${jobs} 2>/dev/null
+	rm -f $STATS
+
+	for ns in $NS_SRC $NS_DST; do
+		ip netns del $ns 2>/dev/null
+	done
+}
+
+trap cleanup EXIT
+
+create_ns() {
+	local ns
+
+	for ns in $NS_SRC $NS_DST; do
+		ip netns add $ns
+		ip -n $ns link set dev lo up
+	done
+
+	ip link add name veth$SRC type veth peer name veth$DST
+
+	for ns in $SRC $DST; do
+		ip link set dev veth$ns netns $BASE$ns up
+		ip -n $BASE$ns addr add dev veth$ns $BM_NET_V4$ns/24
+		ip -n $BASE$ns addr add dev veth$ns $BM_NET_V6$ns/64 nodad
+	done
+}
+
+__chk_flag() {
+	local msg="$1"
+	local target=$2
+	local expected=$3
+	local flagname=$4
+
+	local flag=`ip netns exec $BASE$target ethtool -k veth$target |\
+		    grep $flagname | awk '{print $2}'`
+
+	printf "%-60s" "$msg"
+	if [ "$flag" = "$expected" ]; then
+		echo " ok "
+	else
+		echo " fail - expected $expected found $flag"
+		ret=1
+	fi
+}
+
+chk_gro_flag() {
+	__chk_flag "$1" $2 $3 generic-receive-offload
+}
+
+chk_gro() {
+	local -r msg="$1"
+	local -r expected=$2
+
+	ip netns exec $NS_DST ./udpgso_bench_rx -C 1000 -R 10 -4 -G \
+		-n $expected -l $(( 14720 / expected )) &
+	local -r pid=$!
+
+	sleep 0.1
+	printf "%-60s" "$msg"
+	ip netns exec $NS_SRC ./udpgso_bench_tx -4 -l 4 \
+		-D $BM_NET_V4$DST -M 1 -s 14720 -S 0
+	if wait $pid; then
+		echo " ok "
+	else
+		echo " fail - expected $expected packet(s)"
+		ret=1
+	fi
+}
+
+chk_plain() {
+	local -r msg="$1"
+
+	ip netns exec $NS_DST ./udpgso_bench_rx -C 1000 -R 10 -4 \
+		-n 10 -l 1472 &
+	local -r pid=$!
+
+	sleep 0.1
+	printf "%-60s" "$msg"
+	ip netns exec $NS_SRC ./udpgso_bench_tx -4 -l 4 \
+		-D $BM_NET_V4$DST -M 1 -s 14720 -S 0
+	if wait $pid; then
+		echo " ok "
+	else
+		echo " fail - data corrupted or lost"
+		ret=1
+	fi
+}
+
+if [ ! -f ./udpgso_bench_rx ] || [ ! -f ./udpgso_bench_tx ]; then
+	echo "Missing udpgso_bench_{rx,tx} helpers, build the net selftests first"
+	exit 4
+fi
+
+create_ns
+# segment UDP GSO packets at the sender veth, before they reach the peer
+ip netns exec $NS_SRC ethtool -K veth$SRC tso off tx-udp-segmentation off
+chk_gro_flag "default - gro flag" $DST on
+chk_gro "        - aggregation" 1
+
+ip netns exec $NS_DST ethtool -K veth$DST gro off
+chk_gro_flag "gro off - gro flag" $DST off
+chk_gro "        - no aggregation" 10
+
+ip netns exec $NS_DST ethtool -K veth$DST gro on
+chk_gro_flag "gro on at runtime - gro flag" $DST on
+chk_gro "        - aggregation" 1
+
+# with TSO on the sender only UDP and forwarded traffic goes via napi,
+# fraglist GRO must hand the segments to a plain socket untouched
+ip netns exec $NS_SRC ethtool -K veth$SRC tso on
+ip netns exec $NS_DST ethtool -K veth$DST rx-gro-list on
+__chk_flag "fraglist on - gro-list flag" $DST on rx-gro-list
+chk_plain "        - plain socket receive"
+ip netns exec $NS_DST ethtool -K veth$DST rx-gro-list off
+ip netns exec $NS_SRC ethtool -K veth$SRC tso off
+
+if [ -f ../bpf/xdp_dummy.o ]; then
+	ip netns exec $NS_DST ethtool -K veth$DST gro off
+	ip -n $NS_DST link set dev veth$DST xdp object ../bpf/xdp_dummy.o \
+		section xdp_dummy 2>/dev/null
+	chk_gro_flag "with xdp - gro flag" $DST on
+	chk_gro "        - aggregation" 1
+
+	ip -n $NS_DST link set dev veth$DST xdp off
+	chk_gro_flag "xdp removed, gro off - gro flag" $DST off
+	chk_gro "        - no aggregation" 10
+
+	ip netns exec $NS_DST ethtool -K veth$DST gro on
+	ip -n $NS_DST link set dev veth$DST xdp object ../bpf/xdp_dummy.o \
+		section xdp_dummy 2>/dev/null
+	ip -n $NS_DST link set dev veth$DST xdp off
+	chk_gro_flag "xdp removed, gro on - gro flag" $DST on
+	chk_gro "        - aggregation" 1
+else
+	echo "Missing xdp_dummy helper, skipping the XDP tests"
+fi
+
+exit $ret